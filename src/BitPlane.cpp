@@ -0,0 +1,96 @@
+#include "BitPlane.h"
+
+void BitPlane::resize(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+	m_rowWords = (width + WordBits - 1) / WordBits;
+	m_columnWords = (height + WordBits - 1) / WordBits;
+	m_rows.assign(m_rowWords * height, 0);
+	m_columns.assign(m_columnWords * width, 0);
+}
+
+void BitPlane::clear()
+{
+	m_rows.assign(m_rows.size(), 0);
+	m_columns.assign(m_columns.size(), 0);
+}
+
+void BitPlane::set(int x, int y)
+{
+	m_rows[y * m_rowWords + x / WordBits] |= (Word)1 << (x % WordBits);
+	m_columns[x * m_columnWords + y / WordBits] |= (Word)1 << (y % WordBits);
+}
+
+void BitPlane::reset(int x, int y)
+{
+	m_rows[y * m_rowWords + x / WordBits] &= ~((Word)1 << (x % WordBits));
+	m_columns[x * m_columnWords + y / WordBits] &= ~((Word)1 << (y % WordBits));
+}
+
+void BitPlane::setRow(int y, int x1, int x2)
+{
+	setRange(&m_rows[y * m_rowWords], x1, x2);
+
+	// Each cell of the range is in a different column
+	for (int x = x1; x <= x2; ++x)
+		m_columns[x * m_columnWords + y / WordBits] |= (Word)1 << (y % WordBits);
+}
+
+void BitPlane::setColumn(int x, int y1, int y2)
+{
+	setRange(&m_columns[x * m_columnWords], y1, y2);
+
+	for (int y = y1; y <= y2; ++y)
+		m_rows[y * m_rowWords + x / WordBits] |= (Word)1 << (x % WordBits);
+}
+
+void BitPlane::unite(const BitPlane& other)
+{
+	for (size_t i = 0; i < m_rows.size(); ++i)
+		m_rows[i] |= other.m_rows[i];
+	for (size_t i = 0; i < m_columns.size(); ++i)
+		m_columns[i] |= other.m_columns[i];
+}
+
+int BitPlane::count() const
+{
+	int count = 0;
+	for (size_t i = 0; i < m_rows.size(); ++i)  {
+		// Clears the lowest set bit each round
+		for (Word word = m_rows[i]; word != 0; word &= word - 1)
+			++count;
+	}
+	return count;
+}
+
+int BitPlane::find(const Word *words, int from, int to)
+{
+	if (from <= to)  {
+		for (int w = from / WordBits; w <= to / WordBits; ++w)  {
+			const int low = w == from / WordBits ? from % WordBits : 0;
+			const int high = w == to / WordBits ? to % WordBits : WordBits - 1;
+			const Word bits = words[w] & rangeMask(low, high);
+			if (bits != 0)
+				return w * WordBits + lowestBit(bits);
+		}
+	} else  {
+		for (int w = from / WordBits; w >= to / WordBits; --w)  {
+			const int low = w == to / WordBits ? to % WordBits : 0;
+			const int high = w == from / WordBits ? from % WordBits : WordBits - 1;
+			const Word bits = words[w] & rangeMask(low, high);
+			if (bits != 0)
+				return w * WordBits + highestBit(bits);
+		}
+	}
+	return -1;
+}
+
+void BitPlane::setRange(Word *words, int from, int to)
+{
+	for (int w = from / WordBits; w <= to / WordBits; ++w)  {
+		const int low = w == from / WordBits ? from % WordBits : 0;
+		const int high = w == to / WordBits ? to % WordBits : WordBits - 1;
+		words[w] |= rangeMask(low, high);
+	}
+}
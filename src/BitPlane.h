@@ -0,0 +1,183 @@
+#ifndef BITPLANE_H
+#define BITPLANE_H
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * @brief
+ * One bit per level cell, for one property of the cells (solid, destructible, ...).
+ * 
+ * The bits are stored twice, packed 64 cells per word along the rows and along
+ * the columns, so that range queries in both directions test whole words
+ * instead of single cells.
+ * 
+ * @see
+ * Level::plane | TilePlane
+ */
+class BitPlane  {
+public:
+	typedef boost::uint64_t Word;
+
+	BitPlane() : m_width(0), m_height(0), m_rowWords(0), m_columnWords(0) {}
+
+	/**
+	 * @brief
+	 * Resizes the plane and clears all bits.
+	 */
+	void resize(int width, int height);
+
+	void clear();
+
+	void set(int x, int y);
+	void reset(int x, int y);
+	void assign(int x, int y, bool value) { if (value) set(x, y); else reset(x, y); }
+
+	bool test(int x, int y) const { return ((m_rows[y * m_rowWords + x / WordBits] >> (x % WordBits)) & 1) != 0; }
+
+	/**
+	 * @brief
+	 * Sets the cells x1..x2 of a row, inclusive.
+	 */
+	void setRow(int y, int x1, int x2);
+
+	/**
+	 * @brief
+	 * Sets the cells y1..y2 of a column, inclusive.
+	 */
+	void setColumn(int x, int y1, int y2);
+
+	/**
+	 * @brief
+	 * Sets every bit that is set in another plane of the same size.
+	 */
+	void unite(const BitPlane& other);
+
+	/**
+	 * @brief
+	 * True if no cell between x1 and x2 (inclusive, in any order) of a row is set.
+	 */
+	bool isRowClear(int y, int x1, int x2) const { return findInRow(y, x1, x2) < 0; }
+
+	/**
+	 * @brief
+	 * True if no cell between y1 and y2 (inclusive, in any order) of a column is set.
+	 */
+	bool isColumnClear(int x, int y1, int y2) const { return findInColumn(x, y1, y2) < 0; }
+
+	/**
+	 * @brief
+	 * Finds the set cell of a row nearest to x1, searching from x1 towards x2.
+	 * 
+	 * @returns
+	 * Column of the cell, -1 if none of the cells x1..x2 is set.
+	 */
+	int findInRow(int y, int x1, int x2) const { return find(&m_rows[y * m_rowWords], x1, x2); }
+
+	/**
+	 * @brief
+	 * Finds the set cell of a column nearest to y1, searching from y1 towards y2.
+	 * 
+	 * @returns
+	 * Row of the cell, -1 if none of the cells y1..y2 is set.
+	 */
+	int findInColumn(int x, int y1, int y2) const { return find(&m_columns[x * m_columnWords], y1, y2); }
+
+	/**
+	 * @brief
+	 * Number of set cells.
+	 */
+	int count() const;
+
+	// Properties
+
+	int width() const { return m_width; }
+	int height() const { return m_height; }
+
+	/**
+	 * @brief
+	 * Words of one row, bit i of word w is the cell in column w * WordBits + i.
+	 */
+	const Word *row(int y) const { return &m_rows[y * m_rowWords]; }
+	int rowWords() const { return m_rowWords; }
+
+	/**
+	 * @brief
+	 * Heap memory used by the plane, in bytes.
+	 */
+	size_t memoryUsage() const { return (m_rows.size() + m_columns.size()) * sizeof(Word); }
+
+	bool operator== (const BitPlane& other) const { return m_width == other.m_width && m_height == other.m_height && m_rows == other.m_rows; }
+
+	// Constants
+
+	static const int WordBits = 64;
+
+	// Bit scans
+
+	/**
+	 * @brief
+	 * Index of the lowest set bit, the word must not be 0.
+	 */
+	static int lowestBit(Word word)
+	{
+#ifdef _MSC_VER
+		// The 64-bit intrinsics are missing in 32-bit builds
+		unsigned long index;
+		if (_BitScanForward(&index, (unsigned long)word))
+			return (int)index;
+		_BitScanForward(&index, (unsigned long)(word >> 32));
+		return (int)index + 32;
+#else
+		return __builtin_ctzll(word);
+#endif
+	}
+
+	/**
+	 * @brief
+	 * Index of the highest set bit, the word must not be 0.
+	 */
+	static int highestBit(Word word)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		if (_BitScanReverse(&index, (unsigned long)(word >> 32)))
+			return (int)index + 32;
+		_BitScanReverse(&index, (unsigned long)word);
+		return (int)index;
+#else
+		return 63 - __builtin_clzll(word);
+#endif
+	}
+
+	/**
+	 * @brief
+	 * Word with the bits from..to set, inclusive, both less than WordBits.
+	 */
+	static Word rangeMask(int from, int to) { return (~(Word)0 >> (WordBits - 1 - to)) & (~(Word)0 << from); }
+
+private:
+	int m_width, m_height;
+	int m_rowWords, m_columnWords;
+
+	/**
+	 * @brief
+	 * Row by row, m_rowWords words per row.
+	 */
+	std::vector<Word> m_rows;
+
+	/**
+	 * @brief
+	 * Column by column, m_columnWords words per column.
+	 */
+	std::vector<Word> m_columns;
+
+	static int find(const Word *words, int from, int to);
+	static void setRange(Word *words, int from, int to);
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include "PrecisionClock.h"
+#include "PlayerAction.h"
+
+class World;
+
+/**
+ * @brief
+ * What a bot sees while it thinks: the world, its player and its deadline.
+ * 
+ * @remarks
+ * The world is a copy made for the tick, it does not change while the bot
+ * thinks, even when the bot is late. All bots of a tick read the same copy at
+ * the same time, so only its const functions may be used.
+ */
+class BotContext  {
+private:
+	const World& m_world;
+	int m_player;
+	double m_budget;
+	PrecisionClock m_clock;
+
+public:
+	/**
+	 * @brief
+	 * Creates the context and starts the clock of the bot.
+	 * 
+	 * @param world
+	 * The world.
+	 * 
+	 * @param player
+	 * Index of the player controlled by the bot.
+	 * 
+	 * @param budget
+	 * Thinking time of the bot, in seconds.
+	 */
+	BotContext(const World& world, int player, double budget) : m_world(world), m_player(player), m_budget(budget) {}
+
+	/**
+	 * @brief
+	 * True when the budget is used up, the action returned then is dropped.
+	 * 
+	 * Long searches should poll this and give up, a bot that misses the deadline
+	 * of the tick is not asked again until it returned.
+	 */
+	bool expired() const { return m_clock.elapsed() > m_budget; }
+
+	/**
+	 * @brief
+	 * Seconds since the bot started thinking.
+	 */
+	double elapsed() const { return m_clock.elapsed(); }
+
+	// Properties
+	const World& world() const { return m_world; }
+	int playerIndex() const { return m_player; }
+	double budget() const { return m_budget; }
+};
+
+/**
+ * @brief
+ * Decision function of a computer controlled player.
+ * 
+ * Called once per tick on a worker thread of BotController, in parallel with the
+ * other bots. A bot only returns its action, the controller sends it to the
+ * player as a PlayerActionEvent so that bot games can be replayed without the bots.
+ * 
+ * @remarks
+ * Each bot is called by one thread at a time, its members need no locking.
+ * 
+ * @see
+ * BotController | SimpleBot
+ */
+class Bot  {
+public:
+	virtual ~Bot() {}
+
+	/**
+	 * @brief
+	 * Decides the action of the player for the next tick.
+	 * 
+	 * @param context
+	 * The world, the player and the deadline.
+	 * 
+	 * @returns
+	 * The new action, ignored if the budget was exceeded.
+	 */
+	virtual PlayerAction think(const BotContext& context) = 0;
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include <boost/bind.hpp>
+#include "BotController.h"
+#include "EventLoop.h"
+#include "PrecisionClock.h"
+#include "World.h"
+#include "events/PlayerActionEvent.h"
+
+BotController::BotController(unsigned int threads, double budget) : m_pending(0), m_budget(budget), m_pool(threads)
+{
+}
+
+BotController::~BotController()
+{
+	m_pool.wait();
+	for (auto it = m_slots.begin(); it != m_slots.end(); ++it)
+		delete it->bot;
+}
+
+void BotController::addBot(Bot *bot, int player)
+{
+	Slot slot;
+	slot.bot = bot;
+	slot.player = player;
+	slot.time = 0;
+	slot.busy = false;
+	slot.late = false;
+	slot.view = 0;
+
+	// Late bots reach their slots through the vector, it may move
+	boost::lock_guard<boost::mutex> l(m_mutex);
+	m_slots.push_back(slot);
+	m_stats.push_back(BotStats());
+}
+
+void BotController::runBot(size_t slot, Bot *bot, int player, double budget, const World *world)
+{
+	BotContext context(*world, player, budget);
+	const PlayerAction action = bot->think(context);
+	const double time = context.elapsed();
+
+	{
+		boost::lock_guard<boost::mutex> l(m_mutex);
+		Slot& s = m_slots[slot];
+		s.action = action;
+		s.time = time;
+		s.busy = false;
+		--m_views[s.view].readers;
+		if (!s.late)
+			--m_pending;
+	}
+	m_botDone.notify_all();
+}
+
+size_t BotController::prepareView(const World& world)
+{
+	size_t view = 0;
+	{
+		boost::lock_guard<boost::mutex> l(m_mutex);
+		while (view < m_views.size() && m_views[view].readers > 0)
+			++view;
+		if (view == m_views.size())  {
+			View fresh = { boost::shared_ptr<World>(new World(world.level().width(), world.level().height())), 0 };
+			m_views.push_back(fresh);
+		}
+	}
+
+	// No bot reads the view, the late ones hold on to others
+	m_views[view].world->copyView(world, m_viewState);
+	return view;
+}
+
+void BotController::think(const World& world, EventLoop& loop)
+{
+	const size_t view = prepareView(world);
+	PrecisionClock clock;
+
+	unsigned int submitted = 0;
+	{
+		boost::unique_lock<boost::mutex> l(m_mutex);
+		for (size_t i = 0; i < m_slots.size(); ++i)  {
+			Slot& s = m_slots[i];
+			BotStats& stats = m_stats[i];
+
+			// A late bot that returned since has its time counted, its action was dropped
+			if (s.late && !s.busy)  {
+				s.late = false;
+				stats.totalTime += s.time;
+				if (s.time > stats.maxTime)
+					stats.maxTime = s.time;
+			}
+
+			if (s.busy)  {
+				++stats.skips;
+				continue;
+			}
+
+			s.busy = true;
+			s.view = view;
+			++m_views[view].readers;
+			++m_pending;
+			++submitted;
+			m_pool.submit(boost::bind(&BotController::runBot, this, i, s.bot, s.player, m_budget, m_views[view].world.get()));
+		}
+
+		// Each worker thinks for its share of the bots one after the other
+		const unsigned int rounds = (submitted + m_pool.size() - 1) / m_pool.size();
+		const double deadline = m_budget * rounds;
+		double remaining;
+		while (m_pending > 0 && (remaining = deadline - clock.elapsed()) > 0)
+			m_botDone.timed_wait(l, boost::posix_time::microseconds((long) (remaining * 1e6) + 1));
+
+		// The bots that did not return are late, the tick goes on without them
+		for (size_t i = 0; i < m_slots.size(); ++i)  {
+			Slot& s = m_slots[i];
+			if (s.busy && s.view == view && !s.late)  {
+				s.late = true;
+				++m_stats[i].thinks;
+				++m_stats[i].overruns;
+			}
+		}
+		m_pending = 0;
+
+		// Send the actions in bot order, the late ones are dropped
+		for (size_t i = 0; i < m_slots.size(); ++i)  {
+			Slot& s = m_slots[i];
+			BotStats& stats = m_stats[i];
+			if (s.busy || s.late || s.view != view)
+				continue;
+
+			++stats.thinks;
+			stats.totalTime += s.time;
+			if (s.time > stats.maxTime)
+				stats.maxTime = s.time;
+
+			if (s.time > m_budget)  {
+				++stats.overruns;
+				continue;
+			}
+
+			// The walking direction lasts until changed, bombs are sent every time
+			if (s.action != s.sent || s.action.bomb)  {
+				EventPtr ev(new PlayerActionEvent(s.player, s.action));
+				loop.pushEvent(ev);
+				s.sent = s.action;
+				s.sent.bomb = false;
+			}
+		}
+	}
+}
+
+void BotController::printStats(std::ostream& out) const
+{
+	for (size_t i = 0; i < m_slots.size(); ++i)  {
+		const BotStats& stats = m_stats[i];
+		out << "Bot " << i << " (player " << m_slots[i].player << "): " << stats.thinks << " thinks, average "
+			<< stats.averageTime() * 1e6 << " us, max " << stats.maxTime * 1e6 << " us, "
+			<< stats.overruns << " over the " << m_budget * 1e6 << " us budget, "
+			<< stats.skips << " skipped" << std::endl;
+	}
+}
@@ -0,0 +1,244 @@
+#ifndef BOTCONTROLLER_H
+#define BOTCONTROLLER_H
+
+#include <ostream>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "Bot.h"
+#include "ThreadPool.h"
+#include "StateBuffer.h"
+
+class EventLoop;
+
+/**
+ * @brief
+ * Think time statistics of one bot.
+ */
+struct BotStats  {
+	BotStats() : thinks(0), overruns(0), skips(0), totalTime(0), maxTime(0) {}
+
+	/**
+	 * @brief
+	 * Number of ticks the bot was asked for an action.
+	 */
+	unsigned int thinks;
+
+	/**
+	 * @brief
+	 * Number of ticks the bot exceeded its budget or missed the deadline of the tick and kept its previous action.
+	 */
+	unsigned int overruns;
+
+	/**
+	 * @brief
+	 * Number of ticks the bot was not asked because it was still thinking about an earlier one.
+	 */
+	unsigned int skips;
+
+	/**
+	 * @brief
+	 * Sum and maximum of the think times, in seconds.
+	 */
+	double totalTime, maxTime;
+
+	double averageTime() const { return thinks > 0 ? totalTime / thinks : 0; }
+};
+
+/**
+ * @brief
+ * Runs the bots of a world in parallel once per tick, each within a time budget.
+ * 
+ * After every tick all bots think at the same time on a thread pool. They read
+ * a copy of the world made for the tick (World::copyView), not the world
+ * itself. A bot that returns within its budget has its action pushed to the
+ * event loop as a PlayerActionEvent when it differs from its last one, so the
+ * action is applied at the start of the next tick and recorded in the replay.
+ * The action of a bot that exceeds the budget is dropped and its player keeps
+ * doing what it did.
+ * 
+ * think waits until every bot returned or the deadline of the tick passed, the
+ * budget times the rounds the workers need for all bots. A bot that has not
+ * returned by then is late: it keeps its copy of the world, which is not
+ * touched until it returns, and is not asked again before, so one bot stuck
+ * in a search never stalls the tick.
+ * 
+ * @remarks
+ * A thread cannot be stopped, a late bot still occupies its worker. Bots
+ * should poll BotContext::expired in long searches.
+ * 
+ * @see
+ * Bot | PlayerActionHandler
+ */
+class BotController  {
+private:
+	struct Slot  {
+		Bot *bot;
+		int player;
+
+		/**
+		 * @brief
+		 * Last action sent to the player.
+		 */
+		PlayerAction sent;
+
+		// Result of the last think, written by the worker thread
+		PlayerAction action;
+		double time;
+
+		/**
+		 * @brief
+		 * Set while the bot thinks, cleared by the worker when it returns.
+		 */
+		bool busy;
+
+		/**
+		 * @brief
+		 * Set when the bot missed the deadline of its tick, cleared by the next think after it returned.
+		 */
+		bool late;
+
+		/**
+		 * @brief
+		 * The copy of the world the bot reads, index into m_views.
+		 */
+		size_t view;
+	};
+
+	/**
+	 * @brief
+	 * A copy of the world for the bots of one tick.
+	 */
+	struct View  {
+		boost::shared_ptr<World> world;
+
+		/**
+		 * @brief
+		 * Number of bots still reading the copy, it is reused when none is left.
+		 */
+		unsigned int readers;
+	};
+
+	std::vector<Slot> m_slots;
+	std::vector<BotStats> m_stats;
+	std::vector<View> m_views;
+
+	/**
+	 * @brief
+	 * Buffer the world is copied through, see World::copyView.
+	 */
+	StateBuffer m_viewState;
+
+	/**
+	 * @brief
+	 * Guards m_slots against additions, busy, action and time of the slots, the readers of the views and m_pending.
+	 */
+	boost::mutex m_mutex;
+
+	/**
+	 * @brief
+	 * Signalled when a bot of the current tick returns.
+	 */
+	boost::condition_variable m_botDone;
+
+	/**
+	 * @brief
+	 * Number of bots of the current tick that have not returned yet.
+	 */
+	unsigned int m_pending;
+
+	/**
+	 * @brief
+	 * Think time of each bot per tick, in seconds.
+	 */
+	double m_budget;
+
+	ThreadPool m_pool;
+
+	/**
+	 * @brief
+	 * Body of the job thinking for one bot.
+	 * 
+	 * Gets everything it needs before the think by value, so addBot and
+	 * setBudget may run while late bots think. The slot is touched only under m_mutex.
+	 */
+	void runBot(size_t slot, Bot *bot, int player, double budget, const World *world);
+
+	/**
+	 * @brief
+	 * Index of a view no bot reads, copied from the world. Adds a view if all are in use.
+	 */
+	size_t prepareView(const World& world);
+
+	BotController(const BotController&);
+	BotController& operator= (const BotController&);
+
+public:
+	/**
+	 * @brief
+	 * Creates the controller and starts its worker threads.
+	 * 
+	 * @param threads
+	 * Number of worker threads, 0 for one per core.
+	 * 
+	 * @param budget
+	 * Think time of each bot per tick, in seconds.
+	 */
+	BotController(unsigned int threads, double budget);
+
+	/**
+	 * @brief
+	 * Waits for the late bots and frees the bots and the copies of the world.
+	 */
+	~BotController();
+
+	/**
+	 * @brief
+	 * Adds a bot.
+	 * 
+	 * @param bot
+	 * The bot, allocated on the heap. The controller takes ownership.
+	 * 
+	 * @param player
+	 * Index of the player controlled by the bot, see World::addPlayer.
+	 * 
+	 * Safe while late bots still think.
+	 */
+	void addBot(Bot *bot, int player);
+
+	/**
+	 * @brief
+	 * Lets all bots decide their next action and pushes the new actions to the event loop.
+	 * 
+	 * @param world
+	 * The world, call after it simulated a tick. It is copied for the bots and
+	 * may change after think returned, even while late bots still think.
+	 * 
+	 * @param loop
+	 * Receives a PlayerActionEvent for every bot that changed its action in time.
+	 */
+	void think(const World& world, EventLoop& loop);
+
+	/**
+	 * @brief
+	 * Writes the think time statistics of all bots, one line per bot.
+	 */
+	void printStats(std::ostream& out) const;
+
+	// Properties
+
+	size_t botCount() const { return m_slots.size(); }
+	const BotStats& stats(int bot) const { return m_stats[bot]; }
+	int player(int bot) const { return m_slots[bot].player; }
+
+	double budget() const { return m_budget; }
+
+	/**
+	 * @brief
+	 * Changes the budget from the next think on, late bots keep the one they started with.
+	 */
+	void setBudget(double budget) { m_budget = budget; }
+
+	unsigned int threadCount() const { return m_pool.size(); }
+};
+
+#endif
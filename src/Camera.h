@@ -0,0 +1,84 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <SFML/Graphics.hpp>
+
+/**
+ * @brief
+ * The part of the world shown on screen.
+ * 
+ * Wraps the SFML view and tells the renderers what is visible, so that
+ * only tiles and objects inside the view are drawn.
+ * 
+ * @see
+ * World::render | Level::render
+ */
+class Camera  {
+private:
+	sf::View m_view;
+
+public:
+	/**
+	 * @brief
+	 * Creates a camera showing the given world rectangle.
+	 * 
+	 * @param rect
+	 * Visible area in world space.
+	 */
+	explicit Camera(const sf::FloatRect& rect) : m_view(rect) {}
+
+	/**
+	 * @brief
+	 * Sets the visible area.
+	 * 
+	 * @param rect
+	 * Visible area in world space.
+	 */
+	void setRect(const sf::FloatRect& rect) { m_view.SetFromRect(rect); }
+
+	/**
+	 * @brief
+	 * Moves the camera, keeping its size.
+	 * 
+	 * @param x
+	 * X-axis position of the view center in world space.
+	 * 
+	 * @param y
+	 * Y-axis position of the view center in world space.
+	 */
+	void setCenter(float x, float y) { m_view.SetCenter(x, y); }
+
+	/**
+	 * @brief
+	 * Tells whether a world space rectangle is at least partially visible.
+	 * 
+	 * @param bounds
+	 * The tested rectangle.
+	 */
+	bool isVisible(const sf::FloatRect& bounds) const
+	{
+		const sf::FloatRect& view = m_view.GetRect();
+		return bounds.Right > view.Left && bounds.Left < view.Right && bounds.Bottom > view.Top && bounds.Top < view.Bottom;
+	}
+
+	/**
+	 * @brief
+	 * Makes the target draw through this camera.
+	 * 
+	 * @param target
+	 * The render target. It keeps a reference to the view, the camera must outlive its use.
+	 */
+	void apply(sf::RenderTarget& target) const { target.SetView(m_view); }
+
+	// Properties
+
+	/**
+	 * @brief
+	 * Visible area in world space.
+	 */
+	const sf::FloatRect& rect() const { return m_view.GetRect(); }
+
+	const sf::View& view() const { return m_view; }
+};
+
+#endif
@@ -3,39 +3,23 @@
 
 #include "GameObject.h"
 
+/**
+ * @brief
+ * Base of the objects taking part in collisions.
+ * 
+ * @param Derived
+ * The object class. It defines its row in the collision dispatch table as
+ * static const unsigned char CollisionType, one of CollisionTypeId, and the
+ * static bool collide(Derived&, Other&) functions registered by CollisionTable::add.
+ * 
+ * @see
+ * CollisionTable
+ */
 template <typename Derived>
 class CollidableObject : public GameObject {
-private:
-
-	bool m_checkingCollision;
-
-	bool doCollision(GameObject& other) { return false; }
-
-
 public:
-
 	CollidableObject(float x, float y, float width = 1, float height = 1) : 
-		GameObject(x, y, width, height), m_checkingCollision(false) {}
-
-	virtual bool checkCollision(GameObject& other)
-	{
-		if (!m_checkingCollision)  {
-			m_checkingCollision = true;
-			return other.acceptCollision(*(Derived *)this);
-		} else  {
-			m_checkingCollision = false;
-			if (doCollision(other))  {
-				onCollision(other);
-				return true;
-			}
-			return false;
-		}
-	}
-
-	virtual bool acceptCollision(GameObject& oth)  { return doCollision(oth); }
-
-
-	virtual void onCollision(GameObject& other) { }
+		GameObject(x, y, width, height, Derived::CollisionType) {}
 
 	virtual ~CollidableObject() {}
 };
@@ -0,0 +1,11 @@
+#include "CollisionTable.h"
+#include "GameObject.h"
+
+// No game types collide yet: players walk through each other
+CollisionHandler CollisionTable::s_handlers[COLLISION_TYPE_COUNT][COLLISION_TYPE_COUNT];
+
+bool CollisionTable::collide(GameObject& first, GameObject& second)
+{
+	const CollisionHandler handler = s_handlers[first.collisionType()][second.collisionType()];
+	return handler ? handler(first, second) : false;
+}
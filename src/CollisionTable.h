@@ -0,0 +1,89 @@
+#ifndef COLLISIONTABLE_H
+#define COLLISIONTABLE_H
+
+class GameObject;
+
+/**
+ * @brief
+ * Collision type of an object, the index into the dispatch table.
+ * 
+ * Every CollidableObject<Derived> takes its type from the Derived::CollisionType constant.
+ */
+enum CollisionTypeId  {
+	COLLISION_TYPE_NONE = 0,    // collides with nothing
+	COLLISION_TYPE_PLAYER,
+	COLLISION_TYPE_USER = 16,   // first id available to tools and benchmarks
+	COLLISION_TYPE_COUNT = 32
+};
+
+/**
+ * @brief
+ * Response to two overlapping objects.
+ * 
+ * @returns
+ * True if the objects reacted to the collision.
+ */
+typedef bool (*CollisionHandler)(GameObject& first, GameObject& second);
+
+/**
+ * @brief
+ * Collision dispatch: a handler for every pair of collision types.
+ * 
+ * A pair is resolved by one table lookup and a direct call of the static
+ * collide function of the two classes, the objects keep no dispatch state.
+ * Pairs without a handler do not collide. Handlers are registered with add
+ * before the first tick, after that the table is only read, so any number of
+ * threads may dispatch at the same time.
+ * 
+ * @see
+ * World::collideObjects | CollidableObject
+ */
+class CollisionTable  {
+public:
+	/**
+	 * @brief
+	 * Calls the handler of the collision types of two overlapping objects.
+	 * 
+	 * @returns
+	 * False if the types have no handler or the handler ignored the collision.
+	 */
+	static bool collide(GameObject& first, GameObject& second);
+
+	/**
+	 * @brief
+	 * Handler of two collision types, NULL if they do not collide.
+	 */
+	static CollisionHandler handler(int first, int second) { return s_handlers[first][second]; }
+
+	/**
+	 * @brief
+	 * Registers First::collide(First&, Second&) for both orders of the two types.
+	 * 
+	 * @remarks
+	 * Not threadsafe, call during startup.
+	 */
+	template <typename First, typename Second>
+	static void add()
+	{
+		s_handlers[First::CollisionType][Second::CollisionType] = &call<First, Second>;
+		if ((int)First::CollisionType != (int)Second::CollisionType)
+			s_handlers[Second::CollisionType][First::CollisionType] = &callSwapped<First, Second>;
+	}
+
+private:
+	static CollisionHandler s_handlers[COLLISION_TYPE_COUNT][COLLISION_TYPE_COUNT];
+
+	template <typename First, typename Second>
+	static bool call(GameObject& first, GameObject& second)
+	{
+		return First::collide(static_cast<First&>(first), static_cast<Second&>(second));
+	}
+
+	template <typename First, typename Second>
+	static bool callSwapped(GameObject& first, GameObject& second)
+	{
+		return First::collide(static_cast<First&>(second), static_cast<Second&>(first));
+	}
+};
+
+#endif
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include "DangerField.h"
+#include "Level.h"
+#include "tiles/BombTile.h"
+
+/**
+ * @brief
+ * Longest blast arm of any bomb.
+ */
+static const int Range = BombTile::MaxRadius;
+
+static const int directionX[4] = { 1, -1, 0, 0 };
+static const int directionY[4] = { 0, 0, 1, -1 };
+
+/**
+ * @brief
+ * Distance of the nearest solid cell from x, y in one of the four directions.
+ * 
+ * @returns
+ * 1 to range, 0 if there is no solid cell within range.
+ */
+static int nearestSolid(const BitPlane& solid, int x, int y, int direction, int range)
+{
+	int hit = -1;
+	switch (direction)  {
+	case 0:
+		if (x + 1 < solid.width())
+			hit = solid.findInRow(y, x + 1, x + range < solid.width() ? x + range : solid.width() - 1);
+		return hit < 0 ? 0 : hit - x;
+	case 1:
+		if (x > 0)
+			hit = solid.findInRow(y, x - 1, x - range > 0 ? x - range : 0);
+		return hit < 0 ? 0 : x - hit;
+	case 2:
+		if (y + 1 < solid.height())
+			hit = solid.findInColumn(x, y + 1, y + range < solid.height() ? y + range : solid.height() - 1);
+		return hit < 0 ? 0 : hit - y;
+	default:
+		if (y > 0)
+			hit = solid.findInColumn(x, y - 1, y - range > 0 ? y - range : 0);
+		return hit < 0 ? 0 : y - hit;
+	}
+}
+
+void DangerField::resize(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+	m_explodeAt.assign(width * height, 0);
+	m_zone.resize(width, height);
+	m_bombMarks.resize(width, height);
+	m_cellMarks.resize(width, height);
+	invalidateAll();
+}
+
+void DangerField::update(const Level& level, unsigned int tick)
+{
+	m_tick = (unsigned short) tick;
+	if (!m_rebuild && m_dirty.empty())
+		return;
+
+	if (m_rebuild)  {
+		m_zone.clear();
+		const BitPlane& bombs = level.plane(TILE_PLANE_BOMB);
+		for (int y = 0; y < m_height; ++y)  {
+			for (int x = bombs.findInRow(y, 0, m_width - 1); x >= 0; x = x + 1 < m_width ? bombs.findInRow(y, x + 1, m_width - 1) : -1)
+				addBomb(y * m_width + x);
+		}
+		m_rebuild = false;
+	} else  {
+		// The blasts through a changed cell reach at most Range cells from their bomb,
+		// so both the old and the new arms are within twice the range
+		for (size_t i = 0; i < m_dirty.size(); ++i)  {
+			const int x = m_dirty[i] % m_width, y = m_dirty[i] / m_width;
+			addBombsAround(level, x, y);
+			addCellsAround(x, y, 2 * Range);
+		}
+	}
+	m_dirty.clear();
+
+	// Whole chains, their explosion ticks depend on each other
+	for (size_t i = 0; i < m_bombs.size(); ++i)
+		addChained(level, m_bombs[i]);
+	computeExplosionTicks(level, tick);
+
+	const BitPlane& solid = level.plane(TILE_PLANE_SOLID);
+	for (size_t i = 0; i < m_bombs.size(); ++i)  {
+		const int x = m_bombs[i] % m_width, y = m_bombs[i] / m_width;
+		const int radius = BombTile::radius(level.tile(x, y));
+		addCell(m_bombs[i]);
+		for (int d = 0; d < 4; ++d)  {
+			// The arm ends in front of the nearest solid cell, or on it when it burns
+			const int hit = nearestSolid(solid, x, y, d, radius);
+			const int length = hit > 0 ? (level.isBlastable(x + directionX[d] * hit, y + directionY[d] * hit) ? hit : hit - 1) : radius;
+			for (int step = 1; step <= length; ++step)  {
+				const int cx = x + directionX[d] * step, cy = y + directionY[d] * step;
+				if (cx < 0 || cy < 0 || cx >= m_width || cy >= m_height)
+					break;
+				addCell(cy * m_width + cx);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < m_cells.size(); ++i)  {
+		recomputeCell(level, m_cells[i]);
+		m_cellMarks.reset(m_cells[i] % m_width, m_cells[i] / m_width);
+	}
+	m_bombs.clear();
+	m_cells.clear();
+}
+
+void DangerField::addBomb(int index)
+{
+	const int x = index % m_width, y = index / m_width;
+	if (!m_bombMarks.test(x, y))  {
+		m_bombMarks.set(x, y);
+		m_bombs.push_back(index);
+	}
+}
+
+void DangerField::addCell(int index)
+{
+	const int x = index % m_width, y = index / m_width;
+	if (!m_cellMarks.test(x, y))  {
+		m_cellMarks.set(x, y);
+		m_cells.push_back(index);
+	}
+}
+
+void DangerField::addBombsAround(const Level& level, int x, int y)
+{
+	const BitPlane& bombs = level.plane(TILE_PLANE_BOMB);
+	const int x1 = x - Range > 0 ? x - Range : 0, x2 = x + Range < m_width - 1 ? x + Range : m_width - 1;
+	const int y1 = y - Range > 0 ? y - Range : 0, y2 = y + Range < m_height - 1 ? y + Range : m_height - 1;
+
+	for (int b = bombs.findInRow(y, x1, x2); b >= 0; b = b < x2 ? bombs.findInRow(y, b + 1, x2) : -1)
+		addBomb(y * m_width + b);
+	for (int b = bombs.findInColumn(x, y1, y2); b >= 0; b = b < y2 ? bombs.findInColumn(x, b + 1, y2) : -1)
+		addBomb(b * m_width + x);
+}
+
+void DangerField::addCellsAround(int x, int y, int range)
+{
+	const int x1 = x - range > 0 ? x - range : 0, x2 = x + range < m_width - 1 ? x + range : m_width - 1;
+	const int y1 = y - range > 0 ? y - range : 0, y2 = y + range < m_height - 1 ? y + range : m_height - 1;
+
+	for (int cx = x1; cx <= x2; ++cx)
+		addCell(y * m_width + cx);
+	for (int cy = y1; cy <= y2; ++cy)
+		addCell(cy * m_width + x);
+}
+
+void DangerField::addChained(const Level& level, int bomb)
+{
+	const BitPlane& solid = level.plane(TILE_PLANE_SOLID);
+	const BitPlane& bombs = level.plane(TILE_PLANE_BOMB);
+	const int x = bomb % m_width, y = bomb / m_width;
+	const int radius = BombTile::radius(level.tile(x, y));
+
+	// Only the nearest solid cell in a direction can be reached, or reach the bomb
+	for (int d = 0; d < 4; ++d)  {
+		const int hit = nearestSolid(solid, x, y, d, Range);
+		if (hit == 0)
+			continue;
+
+		const int cx = x + directionX[d] * hit, cy = y + directionY[d] * hit;
+		if (bombs.test(cx, cy) && (hit <= radius || hit <= BombTile::radius(level.tile(cx, cy))))
+			addBomb(cy * m_width + cx);
+	}
+}
+
+void DangerField::computeExplosionTicks(const Level& level, unsigned int tick)
+{
+	const BitPlane& solid = level.plane(TILE_PLANE_SOLID);
+	const BitPlane& bombs = level.plane(TILE_PLANE_BOMB);
+	const unsigned short now = (unsigned short) tick;
+
+	// The own fuse of each bomb
+	for (size_t i = 0; i < m_bombs.size(); ++i)  {
+		const Tile t = level.tile(m_bombs[i] % m_width, m_bombs[i] / m_width);
+		m_explodeAt[m_bombs[i]] = (unsigned short) (tick + BombTile::FuseTicks - t.state);
+	}
+
+	// The bomb with the shortest fuse sets off every bomb it reaches, directly or
+	// through other bombs, so taking them in fuse order finalizes each bomb once
+	std::vector<unsigned short>& explodeAt = m_explodeAt;
+	std::sort(m_bombs.begin(), m_bombs.end(), [&explodeAt, now](int a, int b)  {
+		const unsigned short fuseA = explodeAt[a] - now, fuseB = explodeAt[b] - now;
+		return fuseA < fuseB || (fuseA == fuseB && a < b);
+	});
+
+	for (size_t i = 0; i < m_bombs.size(); ++i)  {
+		const int first = m_bombs[i];
+		if (!m_bombMarks.test(first % m_width, first / m_width))
+			continue;
+
+		m_bombMarks.reset(first % m_width, first / m_width);
+		m_flood.push_back(first);
+		while (!m_flood.empty())  {
+			const int bomb = m_flood.back();
+			m_flood.pop_back();
+
+			const int x = bomb % m_width, y = bomb / m_width;
+			const int radius = BombTile::radius(level.tile(x, y));
+			for (int d = 0; d < 4; ++d)  {
+				const int hit = nearestSolid(solid, x, y, d, radius);
+				const int cx = x + directionX[d] * hit, cy = y + directionY[d] * hit;
+				if (hit > 0 && bombs.test(cx, cy) && m_bombMarks.test(cx, cy))  {
+					m_bombMarks.reset(cx, cy);
+					m_explodeAt[cy * m_width + cx] = m_explodeAt[first];
+					m_flood.push_back(cy * m_width + cx);
+				}
+			}
+		}
+	}
+}
+
+void DangerField::recomputeCell(const Level& level, int index)
+{
+	const BitPlane& solid = level.plane(TILE_PLANE_SOLID);
+	const BitPlane& bombs = level.plane(TILE_PLANE_BOMB);
+	const int x = index % m_width, y = index / m_width;
+
+	if (bombs.test(x, y))  {
+		m_zone.set(x, y);
+		return;
+	}
+
+	// Walls stop every blast before they reach them
+	bool threatened = false;
+	unsigned short fuse = 0;
+	if (!solid.test(x, y) || level.isBlastable(x, y))  {
+		for (int d = 0; d < 4; ++d)  {
+			const int hit = nearestSolid(solid, x, y, d, Range);
+			const int bx = x + directionX[d] * hit, by = y + directionY[d] * hit;
+			if (hit == 0 || !bombs.test(bx, by) || hit > BombTile::radius(level.tile(bx, by)))
+				continue;
+
+			const unsigned short bombFuse = m_explodeAt[by * m_width + bx] - m_tick;
+			if (!threatened || bombFuse < fuse)
+				fuse = bombFuse;
+			threatened = true;
+		}
+	}
+
+	m_zone.assign(x, y, threatened);
+	if (threatened)
+		m_explodeAt[index] = m_tick + fuse;
+}
+
+size_t DangerField::memoryUsage() const
+{
+	return m_explodeAt.capacity() * sizeof(unsigned short) + m_zone.memoryUsage() + m_bombMarks.memoryUsage() + m_cellMarks.memoryUsage()
+		+ (m_dirty.capacity() + m_bombs.capacity() + m_cells.capacity() + m_flood.capacity()) * sizeof(int);
+}
@@ -0,0 +1,125 @@
+#ifndef DANGERFIELD_H
+#define DANGERFIELD_H
+
+#include <vector>
+#include "BitPlane.h"
+
+class Level;
+
+/**
+ * @brief
+ * Time until each cell of the level is hit by an explosion, for the bots.
+ * 
+ * Every cell in the blast zone of a bomb holds the tick the bomb explodes in,
+ * taking chain reactions into account: a bomb reached by another one explodes
+ * with it at the latest. The field is not recomputed each tick. Cells whose
+ * solid, destructible or bomb planes change are passed to invalidate, update
+ * then recomputes only the bombs chained to them and the cells their blasts
+ * can reach.
+ * 
+ * @remarks
+ * The const functions may be called from any number of threads as long as
+ * the level is not simulated.
+ * 
+ * @see
+ * Level::danger | Level::updateFields
+ */
+class DangerField  {
+public:
+	DangerField() : m_width(0), m_height(0), m_tick(0), m_rebuild(true) {}
+
+	/**
+	 * @brief
+	 * Resizes the field, it is rebuilt by the next update.
+	 */
+	void resize(int width, int height);
+
+	/**
+	 * @brief
+	 * Records a cell whose solid, destructible or bomb plane changed.
+	 */
+	void invalidate(int x, int y) { m_dirty.push_back(y * m_width + x); }
+
+	/**
+	 * @brief
+	 * Makes the next update recompute the whole field, for example after the bomb fuses changed.
+	 */
+	void invalidateAll() { m_rebuild = true; m_dirty.clear(); }
+
+	/**
+	 * @brief
+	 * Recomputes the parts of the field affected by the cells invalidated since the last update.
+	 * 
+	 * @param level
+	 * The level, its planes must be up to date.
+	 * 
+	 * @param tick
+	 * Number of ticks simulated so far, the fuses are relative to it.
+	 */
+	void update(const Level& level, unsigned int tick);
+
+	/**
+	 * @brief
+	 * Ticks until an explosion reaches a cell.
+	 * 
+	 * @returns
+	 * 1 if it burns in the next tick, -1 if no bomb threatens the cell.
+	 */
+	int ticksToExplosion(int x, int y) const { return m_zone.test(x, y) ? (unsigned short) (m_explodeAt[y * m_width + x] - m_tick) : -1; }
+
+	bool isThreatened(int x, int y) const { return m_zone.test(x, y); }
+
+	/**
+	 * @brief
+	 * The cells threatened by a bomb, for word-parallel queries such as BitPlane::isRowClear.
+	 */
+	const BitPlane& zone() const { return m_zone; }
+
+	/**
+	 * @brief
+	 * Heap memory used by the field, in bytes.
+	 */
+	size_t memoryUsage() const;
+
+private:
+	int m_width, m_height;
+
+	/**
+	 * @brief
+	 * Tick of the last update, lower 16 bits.
+	 */
+	unsigned short m_tick;
+
+	/**
+	 * @brief
+	 * Tick the cell explodes in (lower 16 bits), valid for cells in m_zone.
+	 * 
+	 * For bomb cells this is the tick the bomb explodes in.
+	 */
+	std::vector<unsigned short> m_explodeAt;
+
+	BitPlane m_zone;
+
+	bool m_rebuild;
+
+	/**
+	 * @brief
+	 * Invalidated cells (y * width + x), may contain duplicates.
+	 */
+	std::vector<int> m_dirty;
+
+	// Scratch space of update, the marks are cleared again before update returns
+
+	std::vector<int> m_bombs, m_cells, m_flood;
+	BitPlane m_bombMarks, m_cellMarks;
+
+	void addBomb(int index);
+	void addCell(int index);
+	void addBombsAround(const Level& level, int x, int y);
+	void addCellsAround(int x, int y, int range);
+	void addChained(const Level& level, int bomb);
+	void computeExplosionTicks(const Level& level, unsigned int tick);
+	void recomputeCell(const Level& level, int index);
+};
+
+#endif
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include "DistanceField.h"
+#include "Level.h"
+
+/**
+ * @brief
+ * Collects the neighbours of a cell inside the level.
+ * 
+ * @returns
+ * Number of neighbours written to the array.
+ */
+static int neighboursOf(int index, int width, int height, int neighbours[4])
+{
+	const int x = index % width, y = index / width;
+	int count = 0;
+	if (x > 0)
+		neighbours[count++] = index - 1;
+	if (x + 1 < width)
+		neighbours[count++] = index + 1;
+	if (y > 0)
+		neighbours[count++] = index - width;
+	if (y + 1 < height)
+		neighbours[count++] = index + width;
+	return count;
+}
+
+void DistanceField::resize(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+	m_distance.assign(width * height, (unsigned short) Unreachable);
+	invalidateAll();
+}
+
+void DistanceField::setSource(int x, int y)
+{
+	if (x != m_sourceX || y != m_sourceY)  {
+		m_sourceX = x;
+		m_sourceY = y;
+		invalidateAll();
+	}
+}
+
+void DistanceField::update(const Level& level)
+{
+	if (m_rebuild)  {
+		m_rebuild = false;
+		m_distance.assign(m_distance.size(), (unsigned short) Unreachable);
+		if (m_sourceX >= 0 && m_sourceY >= 0 && m_sourceX < m_width && m_sourceY < m_height)  {
+			const int source = m_sourceY * m_width + m_sourceX;
+			m_distance[source] = 0;
+			m_seeds.push_back(Entry(0, source));
+		}
+		relax(level);
+		return;
+	}
+
+	if (m_dirty.empty())
+		return;
+
+	dropDependent(level);
+
+	// The lost cells and the cells that opened up continue from their neighbours
+	for (size_t i = 0; i < m_lost.size(); ++i)  {
+		const unsigned short d = nearestNeighbour(level, m_lost[i]);
+		if (d != Unreachable)  {
+			m_distance[m_lost[i]] = d;
+			m_seeds.push_back(Entry(d, m_lost[i]));
+		}
+	}
+	for (size_t i = 0; i < m_dirty.size(); ++i)  {
+		const int cell = m_dirty[i];
+		if (m_distance[cell] != Unreachable || !isWalkable(level, cell))
+			continue;
+
+		const unsigned short d = nearestNeighbour(level, cell);
+		if (d != Unreachable)  {
+			m_distance[cell] = d;
+			m_seeds.push_back(Entry(d, cell));
+		}
+	}
+
+	m_dirty.clear();
+	m_lost.clear();
+	relax(level);
+}
+
+bool DistanceField::isWalkable(const Level& level, int index) const
+{
+	return !level.isSolid(index % m_width, index / m_width) || index == m_sourceY * m_width + m_sourceX;
+}
+
+unsigned short DistanceField::nearestNeighbour(const Level& level, int index) const
+{
+	int neighbours[4];
+	const int count = neighboursOf(index, m_width, m_height, neighbours);
+
+	// Cells with a distance are walkable
+	unsigned short nearest = Unreachable;
+	for (int n = 0; n < count; ++n)
+		nearest = m_distance[neighbours[n]] < nearest ? m_distance[neighbours[n]] : nearest;
+	return nearest < Unreachable - 1 ? nearest + 1 : Unreachable;
+}
+
+void DistanceField::dropDependent(const Level& level)
+{
+	int neighbours[4];
+
+	// Cells that became solid lose their distance, their neighbours one step further are suspects
+	for (size_t i = 0; i < m_dirty.size(); ++i)  {
+		const int cell = m_dirty[i];
+		if (m_distance[cell] == Unreachable || isWalkable(level, cell))
+			continue;
+
+		const unsigned short old = m_distance[cell];
+		m_distance[cell] = Unreachable;
+		const int count = neighboursOf(cell, m_width, m_height, neighbours);
+		for (int n = 0; n < count; ++n)  {
+			if (m_distance[neighbours[n]] == old + 1)
+				m_seeds.push_back(Entry(old + 1, neighbours[n]));
+		}
+	}
+	std::sort(m_seeds.begin(), m_seeds.end());
+
+	// Suspects are decided in order of distance, so the neighbours one step
+	// nearer to the source have been decided before. A suspect keeps its
+	// distance if one of them still has a distance, otherwise it is lost too.
+	size_t s = 0, q = 0;
+	while (s < m_seeds.size() || q < m_queue.size())  {
+		const Entry e = q < m_queue.size() && (s == m_seeds.size() || m_queue[q].first <= m_seeds[s].first) ? m_queue[q++] : m_seeds[s++];
+		if (m_distance[e.second] != e.first)
+			continue;
+
+		const int count = neighboursOf(e.second, m_width, m_height, neighbours);
+		bool supported = false;
+		for (int n = 0; n < count && !supported; ++n)
+			supported = m_distance[neighbours[n]] + 1 == e.first;
+		if (supported)
+			continue;
+
+		m_distance[e.second] = Unreachable;
+		m_lost.push_back(e.second);
+		for (int n = 0; n < count; ++n)  {
+			if (m_distance[neighbours[n]] == e.first + 1)
+				m_queue.push_back(Entry(e.first + 1, neighbours[n]));
+		}
+	}
+
+	m_seeds.clear();
+	m_queue.clear();
+}
+
+void DistanceField::relax(const Level& level)
+{
+	int neighbours[4];
+	std::sort(m_seeds.begin(), m_seeds.end());
+
+	// Breadth-first search from several seeds: the queue and the sorted seeds
+	// are both ordered by distance, merging them visits the cells in order
+	size_t s = 0, q = 0;
+	while (s < m_seeds.size() || q < m_queue.size())  {
+		const Entry e = q < m_queue.size() && (s == m_seeds.size() || m_queue[q].first <= m_seeds[s].first) ? m_queue[q++] : m_seeds[s++];
+		if (m_distance[e.second] != e.first || e.first >= Unreachable - 1)
+			continue;
+
+		const unsigned short next = e.first + 1;
+		const int count = neighboursOf(e.second, m_width, m_height, neighbours);
+		for (int n = 0; n < count; ++n)  {
+			if (next < m_distance[neighbours[n]] && isWalkable(level, neighbours[n]))  {
+				m_distance[neighbours[n]] = next;
+				m_queue.push_back(Entry(next, neighbours[n]));
+			}
+		}
+	}
+
+	m_seeds.clear();
+	m_queue.clear();
+}
+
+size_t DistanceField::memoryUsage() const
+{
+	return m_distance.capacity() * sizeof(unsigned short) + (m_dirty.capacity() + m_lost.capacity()) * sizeof(int)
+		+ (m_seeds.capacity() + m_queue.capacity()) * sizeof(Entry);
+}
@@ -0,0 +1,109 @@
+#ifndef DISTANCEFIELD_H
+#define DISTANCEFIELD_H
+
+#include <vector>
+#include <utility>
+
+class Level;
+
+/**
+ * @brief
+ * Walking distance from one cell (usually a player) to every cell of the level, for the bots.
+ * 
+ * Distances are counted in steps between neighbouring non-solid cells, as a
+ * breadth-first search from the source would. Only a move of the source makes
+ * update search the whole level again. Cells whose solidity changed are passed
+ * to invalidate, update then repairs just the distances that depend on them:
+ * cells that became solid drop the distances that led through them, cells
+ * that opened up shorten the distances behind them.
+ * 
+ * @remarks
+ * The const functions may be called from any number of threads as long as
+ * the level is not simulated.
+ * 
+ * @see
+ * Level::distances | Level::updateFields
+ */
+class DistanceField  {
+public:
+	DistanceField() : m_width(0), m_height(0), m_sourceX(-1), m_sourceY(-1), m_rebuild(true) {}
+
+	/**
+	 * @brief
+	 * Resizes the field, it is rebuilt by the next update.
+	 */
+	void resize(int width, int height);
+
+	/**
+	 * @brief
+	 * Moves the source, the next update searches the whole level if it changed.
+	 * 
+	 * The source cell counts as walkable even when it is solid, so a player
+	 * standing on a bomb can still leave it.
+	 */
+	void setSource(int x, int y);
+
+	/**
+	 * @brief
+	 * Records a cell whose solid plane changed.
+	 */
+	void invalidate(int x, int y) { if (!m_rebuild) m_dirty.push_back(y * m_width + x); }
+
+	/**
+	 * @brief
+	 * Makes the next update search the whole level.
+	 */
+	void invalidateAll() { m_rebuild = true; m_dirty.clear(); }
+
+	/**
+	 * @brief
+	 * Repairs the distances affected by the cells invalidated since the last update.
+	 * 
+	 * @param level
+	 * The level, its planes must be up to date.
+	 */
+	void update(const Level& level);
+
+	/**
+	 * @brief
+	 * Steps from the source to a cell, -1 if the cell cannot be reached.
+	 */
+	int distance(int x, int y) const { const unsigned short d = m_distance[y * m_width + x]; return d == Unreachable ? -1 : d; }
+
+	int sourceX() const { return m_sourceX; }
+	int sourceY() const { return m_sourceY; }
+
+	/**
+	 * @brief
+	 * Heap memory used by the field, in bytes.
+	 */
+	size_t memoryUsage() const;
+
+	static const unsigned short Unreachable = 0xFFFF;
+
+private:
+	int m_width, m_height;
+	int m_sourceX, m_sourceY;
+	bool m_rebuild;
+
+	std::vector<unsigned short> m_distance;
+
+	/**
+	 * @brief
+	 * Invalidated cells (y * width + x), may contain duplicates.
+	 */
+	std::vector<int> m_dirty;
+
+	// Scratch space of update, pairs are (distance, cell)
+
+	typedef std::pair<unsigned short, int> Entry;
+	std::vector<Entry> m_seeds, m_queue;
+	std::vector<int> m_lost;
+
+	bool isWalkable(const Level& level, int index) const;
+	unsigned short nearestNeighbour(const Level& level, int index) const;
+	void dropDependent(const Level& level);
+	void relax(const Level& level);
+};
+
+#endif
@@ -1,10 +1,9 @@
 #include <SFML/System.hpp>
 #include "EventLoop.h"
-#include "Game.h"
+#include "Replay.h"
 #include "events/CloseEvent.h"
 #include "events/KeyboardEvent.h"
 #include "events/MouseEvent.h"
-#include "events/handlers/CloseEventHandler.h"
 
 void EventLoop::addHandler(EventHandler *handler)
 {
@@ -21,7 +20,11 @@ void EventLoop::pushEvent(EventPtr& evt)
 void EventLoop::process()
 {
 	processSystemEvents();
+	processPending();
+}
 
+void EventLoop::processPending()
+{
 	sf::Lock l(m_eventMutex);
 
 	while (!m_events.empty())  {
@@ -33,6 +36,9 @@ void EventLoop::process()
 
 void EventLoop::handleEvent(const Event& e)
 {
+	if (m_recorder && e.typeId() != EVENT_TYPE_NONE)
+		m_recorder->write(m_tick, e);
+
 	sf::Lock l(m_handlerMutex);
 	for (auto it = m_handlers.begin(); it != m_handlers.end(); ++it)  {
 		if ((*it)->canHandleEvent(e))
@@ -42,37 +48,49 @@ void EventLoop::handleEvent(const Event& e)
 
 void EventLoop::processSystemEvents()
 {
+	// No window on a dedicated server
+	if (!m_system || !m_system->isInitialized())
+		return;
+
 	sf::Event ev;
-	EventPtr evtWrapper;
-	while (m_system.m_appWindow.GetEvent(ev))  {
-		switch (ev.Type)  {
-		case sf::Event::Closed:
-			handleEvent(CloseEvent(ev));
-		break;
-		case sf::Event::MouseButtonPressed:
-			handleEvent(MouseDownEvent(ev));
-		break;
-		case sf::Event::MouseButtonReleased:
-			handleEvent(MouseUpEvent(ev));
-		break;
-		case sf::Event::MouseWheelMoved:
-			handleEvent(MouseWheelEvent(ev));
-		break;
-		case sf::Event::KeyPressed:
-			handleEvent(KeyDownEvent(ev));
-		break;
-		case sf::Event::KeyReleased:
-			handleEvent(KeyUpEvent(ev));
-		break;
-		}
+	while (m_system->m_appWindow.GetEvent(ev))  {
+		EventPtr evtWrapper = translateSystemEvent(ev);
+		if (evtWrapper)
+			handleEvent(*evtWrapper);
 	}
 }
 
-void EventLoop::initializeSystemHandlers()
+void EventLoop::pumpSystemEvents()
 {
-	sf::Lock l(m_handlerMutex);
-	m_handlers.push_back(new CloseEventHandler(Game::get()));
-	
+	if (!m_system || !m_system->isInitialized())
+		return;
+
+	sf::Event ev;
+	while (m_system->m_appWindow.GetEvent(ev))  {
+		EventPtr evtWrapper = translateSystemEvent(ev);
+		if (evtWrapper)
+			pushEvent(evtWrapper);
+	}
+}
+
+EventPtr EventLoop::translateSystemEvent(sf::Event& ev)
+{
+	switch (ev.Type)  {
+	case sf::Event::Closed:
+		return EventPtr(new CloseEvent(ev));
+	case sf::Event::MouseButtonPressed:
+		return EventPtr(new MouseDownEvent(ev));
+	case sf::Event::MouseButtonReleased:
+		return EventPtr(new MouseUpEvent(ev));
+	case sf::Event::MouseWheelMoved:
+		return EventPtr(new MouseWheelEvent(ev));
+	case sf::Event::KeyPressed:
+		return EventPtr(new KeyDownEvent(ev));
+	case sf::Event::KeyReleased:
+		return EventPtr(new KeyUpEvent(ev));
+	default:
+		return EventPtr();
+	}
 }
 
 EventLoop::~EventLoop()
@@ -2,17 +2,61 @@
 #define EVENTLOOP_H
 
 #include <list>
+#include <ostream>
 #include <SFML/System.hpp>
 #include <boost/shared_ptr.hpp>
 #include "System.h"
 
+class ReplayWriter;
+
+/**
+ * @brief
+ * Identifiers of the event types stored in replay files.
+ * 
+ * The values are part of the replay file format, never renumber them.
+ * 
+ * @see
+ * Event::typeId | ReplayReader::registerEventType
+ */
+enum EventTypeId  {
+	EVENT_TYPE_NONE = 0,   // not recordable
+	EVENT_TYPE_CLOSE = 1,
+	EVENT_TYPE_MOUSE_DOWN = 2,
+	EVENT_TYPE_MOUSE_UP = 3,
+	EVENT_TYPE_MOUSE_WHEEL = 4,
+	EVENT_TYPE_KEY_DOWN = 5,
+	EVENT_TYPE_KEY_UP = 6,
+	EVENT_TYPE_USER = 100  // first id available for game events
+};
+
 /**
  * @brief
  * Base class for all events.
+ * 
+ * Events that should be recorded into replays override typeId() and write()
+ * and register a reader with ReplayReader::registerEventType.
  */
 class Event  {
 public:
 	virtual ~Event() {}
+
+	/**
+	 * @brief
+	 * Identifies the event type in replay files.
+	 * 
+	 * @returns
+	 * One of EventTypeId, EVENT_TYPE_NONE for events that are not recorded.
+	 */
+	virtual unsigned short typeId() const { return EVENT_TYPE_NONE; }
+
+	/**
+	 * @brief
+	 * Writes the event payload into a replay file.
+	 * 
+	 * @param out
+	 * Binary output stream.
+	 */
+	virtual void write(std::ostream& out) const {}
 };
 
 /**
@@ -148,7 +192,11 @@ class EventLoop  {
 private:
 	mutable sf::Mutex m_eventMutex, m_handlerMutex;
 
-	System& m_system;
+	/**
+	 * @brief
+	 * Source of the system events, NULL if the loop has no window (match runner, server).
+	 */
+	System *m_system;
 
 	/**
 	 * @brief
@@ -163,6 +211,18 @@ private:
 	 */
 	std::list<EventHandler *> m_handlers;
 
+	/**
+	 * @brief
+	 * Receives every dispatched event when recording, NULL otherwise.
+	 */
+	ReplayWriter *m_recorder;
+
+	/**
+	 * @brief
+	 * Simulation tick the dispatched events are stamped with.
+	 */
+	unsigned int m_tick;
+
 private:
 
 	/**
@@ -171,6 +231,15 @@ private:
 	 */
 	void processSystemEvents();
 
+	/**
+	 * @brief
+	 * Wraps a system event into the corresponding Event subclass.
+	 * 
+	 * @returns
+	 * The wrapped event, empty pointer for system events nobody handles.
+	 */
+	static EventPtr translateSystemEvent(sf::Event& ev);
+
 
 	/**
 	 * @brief
@@ -178,18 +247,24 @@ private:
 	 */
 	void handleEvent(const Event& ev);
 
+	EventLoop(const EventLoop&);
+	EventLoop& operator= (const EventLoop&);
 
+public:
 	/**
 	 * @brief
-	 * Initializes all system event handlers (CloseEventsHandler, MouseEventHandler, etc.)
+	 * Creates a loop that reads system events from the given system.
+	 * 
+	 * No handlers are registered, the owner adds the ones it needs (for example
+	 * Game registers CloseEventHandler).
 	 */
-	void initializeSystemHandlers();
+	explicit EventLoop(System& sys) : m_system(&sys), m_recorder(NULL), m_tick(0) {}
 
-public:
-	EventLoop(System& sys) : m_system(sys) 
-	{
-		initializeSystemHandlers();	
-	}
+	/**
+	 * @brief
+	 * Creates a loop without a system event source. Only events from pushEvent are processed.
+	 */
+	EventLoop() : m_system(NULL), m_recorder(NULL), m_tick(0) {}
 
 	/**
 	 * @brief
@@ -239,6 +314,54 @@ public:
 	 */
 	void process();
 
+	/**
+	 * @brief
+	 * Reads system events and queues them instead of handling them.
+	 * 
+	 * Used when events are read on a different thread than the one that
+	 * handles them. System events must be read on the thread that owns the window.
+	 * 
+	 * @remarks
+	 * Threadsafe.
+	 * 
+	 * @see
+	 * EventLoop::processPending | Game::runPipelined
+	 */
+	void pumpSystemEvents();
+
+	/**
+	 * @brief
+	 * Processes all events in the queue without reading system events.
+	 * 
+	 * @see
+	 * EventLoop::pumpSystemEvents
+	 */
+	void processPending();
+
+	/**
+	 * @brief
+	 * Starts or stops recording of the dispatched events.
+	 * 
+	 * @param recorder
+	 * The replay to write events to, NULL stops recording. Not owned by the loop.
+	 * 
+	 * Every event dispatched from now on, system or custom, is written to the
+	 * replay with the current tick, before any handler sees it.
+	 * 
+	 * @see
+	 * EventLoop::setTick
+	 */
+	void setRecorder(ReplayWriter *recorder) { m_recorder = recorder; }
+
+	/**
+	 * @brief
+	 * Sets the simulation tick the following events belong to.
+	 * 
+	 * @param tick
+	 * Number of ticks simulated so far, events dispatched now take effect in this tick.
+	 */
+	void setTick(unsigned int tick) { m_tick = tick; }
+
 	/**
 	 * @brief
 	 * Shuts the loop down and deletes all handlers.
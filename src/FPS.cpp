@@ -1,24 +1,70 @@
+#include <algorithm>
+#include <fstream>
 #include <SFML/Window.hpp>
 #include "FPS.h"
-#include "Game.h"
+#include "Options.h"
 
-Fps::Fps(sf::RenderWindow& win) : m_frames(0), m_currentFps(0), m_secondCounter(0), m_currentDt(0), m_win(win)
+const char *Fps::defaultProfileFileName = "profile.csv";
+
+Fps::Fps(const Options& options) : 
+	m_frames(0), m_currentFps(0), m_secondCounter(0), m_currentDt(0), m_options(options),
+	m_profiling(false)
 {
-		m_clock.Reset();
+		m_clock.reset();
+		std::fill(m_phaseTimes, m_phaseTimes + FRAME_PHASE_COUNT, 0.0f);
 }
 
 void Fps::onFrame()
 {
-	m_win.SetFramerateLimit(Game::get().options().video.fpsLimit);
+	beginPhase(FRAME_PHASE_PACING);
+	m_pacer.setTargetRate(m_options.video.fpsLimit);
+	m_pacer.wait();
+	endPhase(FRAME_PHASE_PACING);
 
 	++m_frames;
-	m_win.IsOpened();
-	m_currentDt = m_clock.GetElapsedTime();
-	m_clock.Reset();
+	m_currentDt = (DeltaTime)m_clock.elapsed();
+	m_clock.reset();
 	m_secondCounter += m_currentDt;
 	if (m_secondCounter >= 1.0f)  {
 		m_secondCounter = 0;
 		m_currentFps = m_frames;
 		m_frames = 0;
 	}
-}
\ No newline at end of file
+
+	// Record the phases of the frame that has just finished
+	if (m_profiling)  {
+		m_phaseTimes[FRAME_PHASE_FRAME] = m_currentDt;
+		for (int i = 0; i < FRAME_PHASE_COUNT; ++i)
+			m_history[i].add(m_phaseTimes[i]);
+	}
+
+	std::fill(m_phaseTimes, m_phaseTimes + FRAME_PHASE_COUNT, 0.0f);
+	m_profiling = true;
+}
+
+const char *Fps::phaseName(FramePhase phase)
+{
+	static const char *names[FRAME_PHASE_COUNT] = { "events", "simulate", "render", "display", "pacing", "frame" };
+	return names[phase];
+}
+
+bool Fps::dumpProfile(const std::string& fileName) const
+{
+	std::ofstream fp;
+	fp.open(fileName);
+	if (!fp.is_open())
+		return false;
+
+	fp << "phase,samples,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+	for (int i = 0; i <= FRAME_PHASE_COUNT; ++i)  {
+		const bool jitter = (i == FRAME_PHASE_COUNT);
+		const FrameTimeHistory& h = jitter ? m_pacer.jitter() : m_history[i];
+		fp << (jitter ? "jitter" : phaseName((FramePhase)i)) << "," << h.count() << "," 
+			<< h.mean() * 1000 << "," << h.percentile(50) * 1000 << "," << h.percentile(95) * 1000 << ","
+			<< h.percentile(99) * 1000 << "," << h.max() * 1000 << "\n";
+	}
+
+	const bool ok = fp.good();
+	fp.close();
+	return ok;
+}
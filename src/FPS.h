@@ -1,7 +1,13 @@
 #ifndef FPS_H
 #define FPS_H
 
+#include <string>
 #include <SFML/Graphics.hpp>
+#include "FrameTimeHistory.h"
+#include "FramePacer.h"
+#include "PrecisionClock.h"
+
+class Options;
 
 /**
  * @brief
@@ -11,15 +17,36 @@ typedef float DeltaTime;
 
 /**
  * @brief
- * Calculates and limits FPS.
+ * Phases of a frame measured by the frame profiler.
+ * 
+ * @see
+ * Fps::beginPhase
+ */
+enum FramePhase  {
+	FRAME_PHASE_EVENTS,
+	FRAME_PHASE_SIMULATE,
+	FRAME_PHASE_RENDER,
+	FRAME_PHASE_DISPLAY,   // buffer flip including the vsync wait
+	FRAME_PHASE_PACING,    // frame limiter wait in Fps::onFrame
+	FRAME_PHASE_FRAME,     // the whole frame, measured by Fps::onFrame
+	FRAME_PHASE_COUNT
+};
+
+/**
+ * @brief
+ * Calculates and limits FPS, profiles frame phases.
  * 
- * Write detailed description for Fps here.
+ * Besides the frame delta and FPS the class measures the time spent in each
+ * phase of the game loop (events, simulation, rendering, display) and keeps
+ * a rolling history of the last frames for percentile reports. Phases are
+ * measured with beginPhase/endPhase, time of a phase entered several times
+ * per frame is summed.
  * 
  * @remarks
- * Write remarks for Fps here.
+ * Not threadsafe, measure phases of one thread only.
  * 
  * @see
- * Separate items with the '|' character.
+ * FramePhase | Fps::dumpProfile
  */
 class Fps  {
 private:
@@ -27,18 +54,104 @@ private:
 	int m_currentFps;
 	float m_secondCounter;
 	DeltaTime m_currentDt;
-	sf::RenderWindow& m_win;
-	sf::Clock m_clock;
+	const Options& m_options;
+	PrecisionClock m_clock;
+
+	/**
+	 * @brief
+	 * Limits the frame rate to the video.fpsLimit option.
+	 */
+	FramePacer m_pacer;
+
+	/**
+	 * @brief
+	 * False until the first onFrame, there is no complete frame to record before it.
+	 */
+	bool m_profiling;
+
+	PrecisionClock m_phaseClocks[FRAME_PHASE_COUNT];
+
+	/**
+	 * @brief
+	 * Time spent in each phase during the current frame.
+	 */
+	float m_phaseTimes[FRAME_PHASE_COUNT];
+
+	FrameTimeHistory m_history[FRAME_PHASE_COUNT];
 
 public:
-	Fps(sf::RenderWindow& win);
+	explicit Fps(const Options& options);
+
+	/**
+	 * @brief
+	 * Starts measuring a phase of the current frame.
+	 * 
+	 * @param phase
+	 * The phase being entered.
+	 */
+	void beginPhase(FramePhase phase) { m_phaseClocks[phase].reset(); }
+
+	/**
+	 * @brief
+	 * Stops measuring a phase started by beginPhase.
+	 * 
+	 * @param phase
+	 * The phase being left.
+	 */
+	void endPhase(FramePhase phase) { m_phaseTimes[phase] += (float)m_phaseClocks[phase].elapsed(); }
+
+	/**
+	 * @brief
+	 * Writes the profile of the recent frames to a CSV file.
+	 * 
+	 * @param fileName
+	 * Path to the file, overwritten if it exists.
+	 * 
+	 * @returns
+	 * True if the file was written.
+	 * 
+	 * Writes one line per phase with the sample count, mean, p50, p95, p99
+	 * and maximum in milliseconds, followed by the same statistics of the
+	 * frame pacing jitter.
+	 */
+	bool dumpProfile(const std::string& fileName) const;
+
+	/**
+	 * @brief
+	 * Rolling history of a phase.
+	 */
+	const FrameTimeHistory& history(FramePhase phase) const { return m_history[phase]; }
+
+	/**
+	 * @brief
+	 * The frame limiter, reports the achieved pacing jitter.
+	 */
+	const FramePacer& pacer() const { return m_pacer; }
+
+	/**
+	 * @brief
+	 * Name of the phase as used in the profile dump.
+	 */
+	static const char *phaseName(FramePhase phase);
+
+	// Constants
+
+	/**
+	 * @brief
+	 * File the profile is dumped to when the profile hotkey is pressed and no file is configured.
+	 */
+	static const char *defaultProfileFileName;
 
 	/**
 	 * @brief
 	 * Updates the FPS counters.
 	 * 
 	 * Updates the FPS counters. Should be called exactly once per frame.
-	 * Also limits the FPS to the value set in options.
+	 * Also limits the FPS to the value set in options and records the
+	 * phases measured during the previous frame into the history.
+	 * 
+	 * The limit is applied by FramePacer, which is reconfigured only when
+	 * the option changes.
 	 */
 	void onFrame();
 
@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <cmath>
+#include <SFML/System.hpp>
+#include "FramePacer.h"
+
+const double FramePacer::SpinTime = 0.0005;
+
+FramePacer::FramePacer() : m_interval(0), m_nextFrame(0), m_lastFrame(0), m_sleepOvershoot(0), m_targetRate(0)
+{
+}
+
+void FramePacer::setTargetRate(unsigned int rate)
+{
+	if (rate == m_targetRate)
+		return;
+
+	m_targetRate = rate;
+	m_interval = rate > 0 ? 1.0 / rate : 0;
+	m_nextFrame = m_clock.elapsed() + m_interval;
+}
+
+void FramePacer::wait()
+{
+	if (m_interval > 0)  {
+		const double remaining = m_nextFrame - m_clock.elapsed();
+		if (remaining > 0)  {
+			// Coarse sleep, leaving room for the expected oversleep
+			const double sleepTime = remaining - m_sleepOvershoot - SpinTime;
+			if (sleepTime > 0)  {
+				const double before = m_clock.elapsed();
+				sf::Sleep((float)sleepTime);
+				const double overshoot = m_clock.elapsed() - before - sleepTime;
+
+				// Adapt quickly to worse scheduling, slowly to better
+				const double weight = overshoot > m_sleepOvershoot ? 0.5 : 0.05;
+				m_sleepOvershoot += (std::max(overshoot, 0.0) - m_sleepOvershoot) * weight;
+			}
+
+			// Spin for the rest
+			while (m_clock.elapsed() < m_nextFrame)
+				;
+
+			m_nextFrame += m_interval;
+		} else if (-remaining > m_interval)  {
+			// Too late, restart the schedule
+			m_nextFrame = m_clock.elapsed() + m_interval;
+		} else  {
+			m_nextFrame += m_interval;
+		}
+	}
+
+	const double now = m_clock.elapsed();
+	if (m_interval > 0 && m_lastFrame > 0)
+		m_jitter.add((float)std::fabs(now - m_lastFrame - m_interval));
+	m_lastFrame = now;
+}
@@ -0,0 +1,101 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include "FrameTimeHistory.h"
+#include "PrecisionClock.h"
+
+/**
+ * @brief
+ * Limits the rate of a loop with low jitter.
+ * 
+ * Waits until the next frame deadline by sleeping for the bulk of the time
+ * and spinning for the last fraction of a millisecond. The sleep is shortened
+ * by the measured oversleep of the OS scheduler, which adapts to the platform
+ * timer resolution. Deadlines advance by a fixed interval, so short delays are
+ * caught up and the average rate stays exact.
+ * 
+ * The deviation of the achieved frame intervals from the target is recorded
+ * as pacing jitter.
+ * 
+ * @see
+ * Fps | Game::runHeadless
+ */
+class FramePacer  {
+private:
+	PrecisionClock m_clock;
+
+	/**
+	 * @brief
+	 * Target frame interval in seconds, 0 when unlimited.
+	 */
+	double m_interval;
+
+	/**
+	 * @brief
+	 * Deadline of the next frame in seconds of m_clock.
+	 */
+	double m_nextFrame;
+
+	/**
+	 * @brief
+	 * Time the last wait() returned, in seconds of m_clock.
+	 */
+	double m_lastFrame;
+
+	/**
+	 * @brief
+	 * Running estimate of how much longer than requested the OS sleeps.
+	 */
+	double m_sleepOvershoot;
+
+	unsigned int m_targetRate;
+
+	/**
+	 * @brief
+	 * Absolute deviations of the achieved frame intervals from the target.
+	 */
+	FrameTimeHistory m_jitter;
+
+public:
+	FramePacer();
+
+	/**
+	 * @brief
+	 * Sets the target rate.
+	 * 
+	 * @param rate
+	 * Frames per second, 0 disables limiting.
+	 * 
+	 * Does nothing when the rate did not change, so it can be called every frame.
+	 */
+	void setTargetRate(unsigned int rate);
+
+	/**
+	 * @brief
+	 * Blocks until the next frame is due.
+	 * 
+	 * Call once per frame. If the loop runs late by more than a frame, the
+	 * schedule restarts from now instead of rushing through the missed frames.
+	 */
+	void wait();
+
+	// Properties
+
+	unsigned int targetRate() const { return m_targetRate; }
+
+	/**
+	 * @brief
+	 * History of the pacing jitter, in seconds.
+	 */
+	const FrameTimeHistory& jitter() const { return m_jitter; }
+
+	// Constants
+
+	/**
+	 * @brief
+	 * Time in seconds left for spinning after the sleep.
+	 */
+	static const double SpinTime;
+};
+
+#endif
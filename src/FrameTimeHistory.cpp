@@ -0,0 +1,43 @@
+#include <algorithm>
+#include "FrameTimeHistory.h"
+
+void FrameTimeHistory::add(float seconds)
+{
+	m_samples[m_next] = seconds;
+	m_next = (m_next + 1) % Capacity;
+	if (m_count < Capacity)
+		++m_count;
+}
+
+float FrameTimeHistory::percentile(float percent) const
+{
+	if (m_count == 0)
+		return 0;
+
+	m_scratch.assign(m_samples, m_samples + m_count);
+	size_t rank = (size_t)(percent / 100.0f * (m_count - 1) + 0.5f);
+	if (rank >= m_count)
+		rank = m_count - 1;
+
+	std::nth_element(m_scratch.begin(), m_scratch.begin() + rank, m_scratch.end());
+	return m_scratch[rank];
+}
+
+float FrameTimeHistory::mean() const
+{
+	if (m_count == 0)
+		return 0;
+
+	float sum = 0;
+	for (unsigned int i = 0; i < m_count; ++i)
+		sum += m_samples[i];
+	return sum / m_count;
+}
+
+float FrameTimeHistory::max() const
+{
+	if (m_count == 0)
+		return 0;
+
+	return *std::max_element(m_samples, m_samples + m_count);
+}
@@ -0,0 +1,60 @@
+#ifndef FRAMETIMEHISTORY_H
+#define FRAMETIMEHISTORY_H
+
+#include <vector>
+
+/**
+ * @brief
+ * Rolling window of the last measured durations of one frame phase.
+ * 
+ * Keeps the last Capacity samples and computes percentiles over them on demand.
+ * 
+ * @see
+ * Fps | FramePacer
+ */
+class FrameTimeHistory  {
+public:
+	static const unsigned int Capacity = 1024;
+
+private:
+	float m_samples[Capacity];
+	unsigned int m_next;
+	unsigned int m_count;
+
+	/**
+	 * @brief
+	 * Preallocated copy of the samples used for percentile selection.
+	 */
+	mutable std::vector<float> m_scratch;
+
+public:
+	FrameTimeHistory() : m_next(0), m_count(0) { m_scratch.reserve(Capacity); }
+
+	/**
+	 * @brief
+	 * Adds a sample, replacing the oldest one when the window is full.
+	 * 
+	 * @param seconds
+	 * Measured duration.
+	 */
+	void add(float seconds);
+
+	/**
+	 * @brief
+	 * Computes a percentile of the samples in the window.
+	 * 
+	 * @param percent
+	 * The percentile, 0 - 100. For example 99 returns a value that 99% of samples do not exceed.
+	 * 
+	 * @returns
+	 * The percentile in seconds, 0 when there are no samples.
+	 */
+	float percentile(float percent) const;
+
+	float mean() const;
+	float max() const;
+
+	unsigned int count() const { return m_count; }
+};
+
+#endif
@@ -1,7 +1,91 @@
+#include <iostream>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
 #include "Game.h"
+#include "MatchRunner.h"
+#include "BotController.h"
+#include "ThreadPool.h"
+#include "bots/SimpleBot.h"
+#include "events/CloseEvent.h"
+#include "events/KeyboardEvent.h"
+#include "events/PlayerActionEvent.h"
+#include "events/handlers/CloseEventHandler.h"
+#include "events/handlers/PlayerActionHandler.h"
+#include "events/handlers/ProfileDumpHandler.h"
 
 const char *Game::name = "UHKBomber";
 
+Game::Game() :
+	m_initialized(false),
+	m_running(false),
+	m_headless(false),
+	m_flatOut(false),
+	m_matchCount(0),
+	m_matchTicks(0),
+	m_pipelined(false),
+	m_profileDumpRequested(false),
+	m_loop(m_system),
+	m_fps(m_options),
+	m_camera(sf::FloatRect(0, 0, 640, 480)),
+	m_bots(NULL),
+	m_collisionPool(NULL)
+{
+	m_loop.addHandler(new CloseEventHandler(*this));
+	m_loop.addHandler(new ProfileDumpHandler(*this));
+	m_loop.addHandler(new PlayerActionHandler(m_world));
+}
+
+/**
+ * @brief
+ * Helper for Game::parseCommandLine that reads a string switch argument.
+ * 
+ * @param it
+ * Iterator pointing to the switch, advanced to the argument if there is one.
+ * 
+ * @param end
+ * End of the parameter list.
+ * 
+ * @param value
+ * The argument (output), untouched when it is missing.
+ */
+static void readSwitchArgument(std::list<std::string>::const_iterator& it, const std::list<std::string>::const_iterator& end, std::string& value)
+{
+	auto next = it;
+	if (++next == end)
+		return;
+
+	value = *next;
+	it = next;
+}
+
+/**
+ * @brief
+ * Helper for Game::parseCommandLine that reads a numeric switch argument.
+ * 
+ * @param it
+ * Iterator pointing to the switch, advanced to the argument if there is one.
+ * 
+ * @param end
+ * End of the parameter list.
+ * 
+ * @param value
+ * The parsed value (output), untouched when the argument is missing or invalid.
+ */
+static void readSwitchArgument(std::list<std::string>::const_iterator& it, const std::list<std::string>::const_iterator& end, unsigned int& value)
+{
+	auto next = it;
+	if (++next == end)
+		return;
+
+	try  {
+		value = boost::lexical_cast<unsigned int>(*next);
+		it = next;
+	} catch (boost::bad_lexical_cast& )  {
+		// TODO: log invalid argument
+	}
+}
+
 void Game::parseCommandLine(const std::list<std::string>& parameters)
 {
 	for (auto it = parameters.begin(); it != parameters.end(); ++it)  {
@@ -9,6 +93,26 @@ void Game::parseCommandLine(const std::list<std::string>& parameters)
 			m_options.video.fullscreen = false;
 		} else if (*it == "-fullscreen")  {
 			m_options.video.fullscreen = true;
+		} else if (*it == "-headless")  {
+			m_headless = true;
+		} else if (*it == "-flatout")  {
+			m_flatOut = true;
+		} else if (*it == "-matches")  {
+			readSwitchArgument(it, parameters.end(), m_matchCount);
+			m_headless = true;
+		} else if (*it == "-pipelined")  {
+			m_pipelined = true;
+		} else if (*it == "-matchticks")  {
+			readSwitchArgument(it, parameters.end(), m_matchTicks);
+		} else if (*it == "-record")  {
+			readSwitchArgument(it, parameters.end(), m_recordFile);
+		} else if (*it == "-replay")  {
+			readSwitchArgument(it, parameters.end(), m_replayFile);
+			m_headless = true;
+		} else if (*it == "-level")  {
+			readSwitchArgument(it, parameters.end(), m_levelFile);
+		} else if (*it == "-bots")  {
+			readSwitchArgument(it, parameters.end(), m_options.bots.count);
 		} else {
 			// TODO: log unrecognized switch
 		}
@@ -28,11 +132,42 @@ bool Game::initialize(const std::list<std::string>& parameters)
 	// Command line overrides options
 	parseCommandLine(parameters);
 
-	if (!m_system.initialize())  {
+	if (!m_headless && !m_system.initialize(m_options.video))  {
 		return false;
 	}
 
-	m_world.initialize();
+	// TODO: follow the local player
+	m_camera.setRect(sf::FloatRect(0, 0, (float)m_options.video.screenWidth, (float)m_options.video.screenHeight));
+	if (!m_headless)
+		m_camera.apply(m_system.m_appWindow);
+
+	m_world.level().setPackDistance(m_options.simulation.chunkPackDistance);
+	if (!m_levelFile.empty() && !m_world.loadLevel(m_levelFile))  {
+		std::cout << "Cannot load level " << m_levelFile << std::endl;
+		return false;
+	}
+	m_world.initialize(!m_headless);
+
+	if (m_options.simulation.collisionThreads != 1)  {
+		m_collisionPool = new ThreadPool(m_options.simulation.collisionThreads);
+		m_world.setCollisionPool(m_collisionPool);
+	}
+
+	// A replay contains the actions of the bots, their players are still needed.
+	// Matches run their own bots.
+	if (m_options.bots.count > 0 && m_replayFile.empty() && m_matchCount == 0)
+		m_bots = new BotController(m_options.bots.threads, m_options.bots.thinkBudget * 1e-6);
+	for (unsigned int i = 0; i < m_options.bots.count; ++i)  {
+		const int player = m_world.spawnPlayer();
+		if (m_bots)
+			m_bots->addBot(new SimpleBot(), player);
+	}
+
+	if (!m_recordFile.empty())  {
+		if (m_recorder.open(m_recordFile, replaySettings()))
+			m_loop.setRecorder(&m_recorder);
+		// TODO: log failure to create the replay
+	}
 
 	m_initialized = true;
 	m_running = false;
@@ -45,24 +180,258 @@ void Game::shutdown()
 		return;
 
 	m_running = false;
+
+	m_loop.setRecorder(NULL);
+	m_recorder.close(m_world.tick());
+
+	if (m_bots)  {
+		m_bots->printStats(std::cout);
+		delete m_bots;
+		m_bots = NULL;
+	}
+
+	m_world.setCollisionPool(NULL);
+	delete m_collisionPool;
+	m_collisionPool = NULL;
+
+	const std::string& profileFile = m_options.debug.profileFile;
+	if (!m_headless && !profileFile.empty())
+		m_fps.dumpProfile(profileFile);
+
 	m_system.shutdown();
 	m_options.saveToFile(Options::optionsFileName);
 
 	m_initialized = false;
 }
 
+DeltaTime Game::tickDelta() const
+{
+	const unsigned int tickRate = m_options.simulation.tickRate;
+	return 1.0f / (tickRate > 0 ? tickRate : 1);
+}
+
+ReplaySettings Game::replaySettings() const
+{
+	ReplaySettings settings;
+	settings.tickRate = m_options.simulation.tickRate;
+	settings.levelHash = m_world.level().hash();
+	settings.players = (unsigned int)m_world.playerCount();
+	settings.bots = m_options.bots.count;
+	return settings;
+}
+
 void Game::run()
 {
+	if (m_matchCount > 0)  {
+		runMatches();
+		return;
+	}
+
+	if (!m_replayFile.empty())  {
+		runReplay();
+		return;
+	}
+
+	if (m_headless)  {
+		runHeadless();
+		return;
+	}
+
+	if (m_pipelined)  {
+		runPipelined();
+		return;
+	}
+
 	m_running = true;
 
-	// Just a dummy loop for now, will be replaced later with a more sophisticated implementation
+	DeltaTime accumulator = 0;
 	while (m_running)  {
 		m_fps.onFrame();
+
+		m_fps.beginPhase(FRAME_PHASE_EVENTS);
+		m_loop.setTick(m_world.tick());
+		m_loop.process();
+		m_fps.endPhase(FRAME_PHASE_EVENTS);
+
+		// Run as many fixed ticks as fit into the elapsed time
+		m_fps.beginPhase(FRAME_PHASE_SIMULATE);
+		const DeltaTime tickDt = tickDelta();
+		accumulator += m_fps.getDelta();
+		unsigned int ticks = 0;
+		while (accumulator >= tickDt && ticks < MaxTicksPerFrame)  {
+			m_world.simulate(tickDt);
+			if (m_bots)
+				m_bots->think(m_world, m_loop);
+			accumulator -= tickDt;
+			++ticks;
+		}
+		m_fps.endPhase(FRAME_PHASE_SIMULATE);
+
+		// Too far behind, drop the backlog rather than spiral
+		if (accumulator >= tickDt)
+			accumulator = 0;
+
+		m_fps.beginPhase(FRAME_PHASE_RENDER);
+		m_world.render(m_system.m_appWindow, m_camera, m_fps.getDelta(), accumulator / tickDt);
+		m_fps.endPhase(FRAME_PHASE_RENDER);
+
+		m_fps.beginPhase(FRAME_PHASE_DISPLAY);
+		m_system.updateScreen();
+		m_fps.endPhase(FRAME_PHASE_DISPLAY);
+
+		flushProfileDump();
+	}
+
+	shutdown();
+}
+
+void Game::runHeadless()
+{
+	m_running = true;
+
+	FramePacer pacer;
+	while (m_running)  {
+		m_loop.setTick(m_world.tick());
 		m_loop.process();
-		m_world.simulate(m_fps.getDelta());
-		m_world.render(m_system.m_appWindow, m_fps.getDelta());
+		m_world.simulate(tickDelta());
+		if (m_bots)
+			m_bots->think(m_world, m_loop);
+
+		if (m_flatOut)
+			continue;
+
+		pacer.setTargetRate(m_options.simulation.tickRate);
+		pacer.wait();
+	}
+
+	shutdown();
+}
+
+void Game::runPipelined()
+{
+	m_running = true;
+	m_pipelineClock.reset();
+
+	boost::thread simulation(boost::bind(&Game::simulationLoop, this));
+
+	while (m_running)  {
+		m_fps.onFrame();
+
+		// Events are handled and the world simulated on the simulation thread,
+		// only the phases of this thread are profiled here
+		m_fps.beginPhase(FRAME_PHASE_EVENTS);
+		m_loop.pumpSystemEvents();
+		m_fps.endPhase(FRAME_PHASE_EVENTS);
+
+		// Draw the newest tick, or the last one again if the simulation did not finish a new one yet
+		m_snapshots.acquire();
+		const WorldSnapshot& snapshot = m_snapshots.front();
+
+		const DeltaTime tickDt = tickDelta();
+		float alpha = (float)(m_pipelineClock.elapsed() - snapshot.time) / tickDt;
+		if (alpha > 1.0f)
+			alpha = 1.0f;
+		else if (alpha < 0)
+			alpha = 0;
+
+		m_fps.beginPhase(FRAME_PHASE_RENDER);
+		m_world.renderSnapshot(m_system.m_appWindow, snapshot, m_camera, m_fps.getDelta(), alpha);
+		m_fps.endPhase(FRAME_PHASE_RENDER);
+
+		m_fps.beginPhase(FRAME_PHASE_DISPLAY);
 		m_system.updateScreen();
+		m_fps.endPhase(FRAME_PHASE_DISPLAY);
+
+		flushProfileDump();
+	}
+
+	simulation.join();
+	shutdown();
+}
+
+void Game::simulationLoop()
+{
+	FramePacer pacer;
+	while (m_running)  {
+		m_loop.setTick(m_world.tick());
+		m_loop.processPending();
+		m_world.simulate(tickDelta());
+		if (m_bots)
+			m_bots->think(m_world, m_loop);
+
+		WorldSnapshot& snapshot = m_snapshots.back();
+		m_world.captureSnapshot(snapshot);
+		snapshot.tick = m_world.tick();
+		snapshot.time = m_pipelineClock.elapsed();
+		m_snapshots.publish();
+
+		pacer.setTargetRate(m_options.simulation.tickRate);
+		pacer.wait();
 	}
+}
+
+void Game::runReplay()
+{
+	ReplayReader replay;
+	const ReplaySettings expected = replaySettings();
+	if (!replay.open(m_replayFile, expected))  {
+		const ReplaySettings& recorded = replay.settings();
+		if (recorded.tickRate == 0)
+			std::cout << "Cannot open replay " << m_replayFile << std::endl;
+		else
+			std::cout << "Replay " << m_replayFile << " was recorded in another game: tick rate " << recorded.tickRate
+				<< ", " << recorded.players << " players, " << recorded.bots << " bots, level hash " << recorded.levelHash
+				<< " instead of " << expected.tickRate << ", " << expected.players << ", " << expected.bots << ", " << expected.levelHash << std::endl;
+		shutdown();
+		return;
+	}
+
+	const unsigned int tickRate = replay.tickRate();
+	const DeltaTime tickDt = 1.0f / (tickRate > 0 ? tickRate : 1);
+
+	m_running = true;
+	PrecisionClock clock;
+
+	unsigned int eventTick = 0;
+	EventPtr ev;
+	bool hasEvent = replay.next(eventTick, ev);
+	while (m_running)  {
+		// Dispatch everything recorded for this tick, in the recorded order
+		const unsigned int tick = m_world.tick();
+		m_loop.setTick(tick);
+		while (hasEvent && eventTick <= tick)  {
+			if (ev)
+				m_loop.pushEvent(ev);
+			hasEvent = replay.next(eventTick, ev);
+		}
+		m_loop.processPending();
+
+		if (!hasEvent && tick >= replay.endTick())
+			break;
+
+		m_world.simulate(tickDt);
+	}
+
+	const double elapsed = clock.elapsed();
+	std::cout << "Replayed " << m_world.tick() << " ticks in " << elapsed << " s ("
+		<< (elapsed > 0 ? m_world.tick() / elapsed : 0) << " ticks/s)" << std::endl;
+
+	shutdown();
+}
+
+void Game::runMatches()
+{
+	// Three minutes of game time by default
+	const unsigned int ticks = m_matchTicks > 0 ? m_matchTicks : 180 * m_options.simulation.tickRate;
+
+	MatchRunner runner;
+	for (unsigned int i = 0; i < m_matchCount; ++i)
+		runner.addMatch(m_options, ticks);
+
+	runner.run();
+
+	std::cout << runner.matchCount() << " matches of " << ticks << " ticks on " << runner.threadCount()
+		<< " threads in " << runner.elapsed() << " s (" << runner.matchesPerHour() << " matches/hour)" << std::endl;
 
 	shutdown();
 }
@@ -72,6 +441,20 @@ void Game::close()
 	m_running = false;
 }
 
+void Game::dumpProfile()
+{
+	m_profileDumpRequested = true;
+}
+
+void Game::flushProfileDump()
+{
+	if (!m_profileDumpRequested.exchange(false))
+		return;
+
+	const std::string& profileFile = m_options.debug.profileFile;
+	m_fps.dumpProfile(profileFile.empty() ? Fps::defaultProfileFileName : profileFile);
+}
+
 Game& Game::get()
 {
 	static Game instance;
@@ -3,12 +3,20 @@
 
 #include <list>
 #include <string>
+#include <boost/atomic.hpp>
 
 #include "Options.h"
 #include "System.h"
 #include "EventLoop.h"
 #include "FPS.h"
 #include "World.h"
+#include "Camera.h"
+#include "WorldSnapshot.h"
+#include "TripleBuffer.h"
+#include "Replay.h"
+
+class BotController;
+class ThreadPool;
 
 /**
  * @brief
@@ -33,8 +41,111 @@ private:
 	/**
 	 * @brief
 	 * True while in the gameloop. When this variable gets false, the game shuts down.
+	 * 
+	 * @remarks
+	 * Atomic, in the pipelined loop it is read by both the render and the simulation thread.
+	 */
+	boost::atomic<bool> m_running;
+
+	/**
+	 * @brief
+	 * True when running as a dedicated server without window, rendering and display.
+	 * 
+	 * Set by the -headless command line switch.
+	 */
+	bool m_headless;
+
+	/**
+	 * @brief
+	 * When headless, simulate ticks back to back instead of pacing them to the tick rate.
+	 * 
+	 * Set by the -flatout command line switch.
+	 */
+	bool m_flatOut;
+
+	/**
+	 * @brief
+	 * Number of matches to run in the match runner, 0 for a normal game.
+	 * 
+	 * Set by the -matches command line switch.
+	 * 
+	 * @see
+	 * MatchRunner
+	 */
+	unsigned int m_matchCount;
+
+	/**
+	 * @brief
+	 * Length of each match run by the match runner, in ticks.
+	 * 
+	 * Set by the -matchticks command line switch.
+	 */
+	unsigned int m_matchTicks;
+
+	/**
+	 * @brief
+	 * Simulate and render on two separate threads.
+	 * 
+	 * Set by the -pipelined command line switch.
+	 * 
+	 * @see
+	 * Game::runPipelined
 	 */
-	bool m_running;
+	bool m_pipelined;
+
+	/**
+	 * @brief
+	 * File the dispatched events are recorded to, empty when not recording.
+	 * 
+	 * Set by the -record command line switch.
+	 */
+	std::string m_recordFile;
+
+	/**
+	 * @brief
+	 * Replay file to play back instead of running the game, empty for a normal game.
+	 * 
+	 * Set by the -replay command line switch, implies -headless.
+	 * 
+	 * @see
+	 * Game::runReplay
+	 */
+	std::string m_replayFile;
+
+	/**
+	 * @brief
+	 * Compiled level file to play, empty for the built-in level.
+	 * 
+	 * Set by the -level command line switch.
+	 * 
+	 * @see
+	 * World::loadLevel
+	 */
+	std::string m_levelFile;
+
+	/**
+	 * @brief
+	 * Writes the replay when recording.
+	 */
+	ReplayWriter m_recorder;
+
+	/**
+	 * @brief
+	 * Handoff of the simulated ticks from the simulation to the render thread in the pipelined loop.
+	 */
+	TripleBuffer<WorldSnapshot> m_snapshots;
+
+	/**
+	 * @brief
+	 * Clock shared by both threads of the pipelined loop, used to timestamp snapshots.
+	 */
+	PrecisionClock m_pipelineClock;
+
+	/**
+	 * @brief
+	 * Set by dumpProfile(), the profile is written by the loop thread at the end of the frame.
+	 */
+	boost::atomic<bool> m_profileDumpRequested;
 
 	/**
 	 * @brief
@@ -67,14 +178,25 @@ private:
 	 */
 	World m_world;
 
+	/**
+	 * @brief
+	 * View of the world on screen.
+	 */
+	Camera m_camera;
+	/**
+	 * @brief
+	 * Runs the bots (bots.count option) after every tick, NULL without bots or when playing a replay.
+	 */
+	BotController *m_bots;
+	/**
+	 * @brief
+	 * Workers of World::collideObjects (simulation.collisionThreads option), NULL when it runs on the simulation thread.
+	 */
+	ThreadPool *m_collisionPool;
+
 private:
-	Game() :
-		m_initialized(false),
-		m_running(false),
-		m_loop(m_system),
-		m_fps(m_system.m_appWindow)
-		{}
-		
+	Game();
+
 
 	/**
 	 * @brief
@@ -102,6 +224,89 @@ private:
 	 */
 	void shutdown();
 
+	/**
+	 * @brief
+	 * Length of one simulation tick.
+	 * 
+	 * @returns
+	 * Fixed delta time derived from the simulation.tickRate option.
+	 */
+	DeltaTime tickDelta() const;
+
+	/**
+	 * @brief
+	 * The game as recorded into and expected from replays, see ReplaySettings.
+	 * 
+	 * Valid after initialize() until the first tick.
+	 */
+	ReplaySettings replaySettings() const;
+
+	/**
+	 * @brief
+	 * Game loop of the dedicated server.
+	 * 
+	 * Runs only event processing and world simulation, no window is touched.
+	 * Ticks are paced to the tick rate by a FramePacer unless -flatout was given.
+	 * 
+	 * @see
+	 * Game::run
+	 */
+	void runHeadless();
+
+	/**
+	 * @brief
+	 * Runs the matches requested by -matches on all cores and prints the throughput.
+	 * 
+	 * @see
+	 * MatchRunner
+	 */
+	void runMatches();
+
+	/**
+	 * @brief
+	 * Plays back the replay given by -replay as fast as possible and prints the tick rate.
+	 * 
+	 * Every recorded event is dispatched in the tick it was recorded in, the world is
+	 * simulated with the tick rate of the recording until its final tick. No window
+	 * is opened and ticks are not paced. Replays recorded with another level, number
+	 * of players or bots or tick rate are refused.
+	 * 
+	 * @see
+	 * ReplayReader
+	 */
+	void runReplay();
+
+	/**
+	 * @brief
+	 * Game loop with simulation and rendering on separate threads.
+	 * 
+	 * A simulation thread runs the fixed ticks and publishes a WorldSnapshot of every
+	 * tick, while this (window) thread reads system events and draws the newest
+	 * snapshot. The snapshots are handed over through a lock-free triple buffer,
+	 * so frame time is the longer of simulation and rendering, not their sum.
+	 * 
+	 * @see
+	 * Game::simulationLoop | TripleBuffer
+	 */
+	void runPipelined();
+
+	/**
+	 * @brief
+	 * Body of the simulation thread of the pipelined loop.
+	 * 
+	 * Handles the queued events, simulates the world paced to the tick rate
+	 * and publishes a snapshot after every tick.
+	 */
+	void simulationLoop();
+
+	/**
+	 * @brief
+	 * Writes the frame profile if it was requested since the last call.
+	 * 
+	 * Called by the thread owning m_fps at the end of each frame.
+	 */
+	void flushProfileDump();
+
 public:
 	/**
 	 * @brief
@@ -111,6 +316,7 @@ public:
 	 * False if initialization fails.
 	 * 
 	 * Initializes the game, window, graphics context, audio and menu system.
+	 * In headless mode only the options and the world are initialized.
 	 */
 	bool initialize(const std::list<std::string>& parameters);
 
@@ -119,7 +325,9 @@ public:
 	 * @brief
 	 * Processes the game loop.
 	 * 
-	 * Runs the entire game logic and performs rendering.
+	 * Runs the entire game logic and performs rendering. The world is simulated
+	 * in fixed ticks (simulation.tickRate option) independently of the frame rate,
+	 * rendering interpolates between the last two simulated ticks.
 	 */
 	void run();
 
@@ -133,6 +341,21 @@ public:
 	 */
 	void close();
 
+	/**
+	 * @brief
+	 * Requests the frame profile to be written.
+	 * 
+	 * The profile is written at the end of the current frame to the file set in
+	 * the debug.profileFile option, or to Fps::defaultProfileFileName.
+	 * 
+	 * @remarks
+	 * Threadsafe.
+	 * 
+	 * @see
+	 * Fps::dumpProfile
+	 */
+	void dumpProfile();
+
 	/**
 	 * @brief
 	 * Returns the Game singleton
@@ -148,9 +371,20 @@ public:
 	System& system() { return m_system; }
 	const System& system() const { return m_system; }
 
+	bool isHeadless() const { return m_headless; }
+
 public:
 	// Constants
 	static const char *name;
+
+	/**
+	 * @brief
+	 * Maximum number of simulation ticks run in a single frame.
+	 * 
+	 * When the simulation falls further behind (debugger break, long hitch),
+	 * the remaining time is dropped instead of trying to catch up.
+	 */
+	static const unsigned int MaxTicksPerFrame = 8;
 };
 
 #endif
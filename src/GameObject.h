@@ -3,6 +3,9 @@
 
 #include "Renderable.h"
 #include "Simulable.h"
+#include "WorldSnapshot.h"
+#include "StateBuffer.h"
+#include "CollisionTable.h"
 
 /**
  * @brief
@@ -15,16 +18,150 @@
  */
 class GameObject : public Renderable, public Simulable {
 public:
-	GameObject(float x, float y, float width = 1, float height = 1) : 
-	  m_x(x), m_y(y), m_width(width), m_height(height) 
+	GameObject(float x, float y, float width = 1, float height = 1, unsigned char collisionType = COLLISION_TYPE_NONE) : 
+	  m_x(x), m_y(y), m_width(width), m_height(height), m_prevX(x), m_prevY(y), m_collisionType(collisionType)
 	  {}
 
-	virtual bool checkCollision(GameObject& other) = 0;
-	virtual bool acceptCollision(GameObject& oth) = 0;
+	virtual ~GameObject() {}
+
+	/**
+	 * @brief
+	 * Row and column of the object in the collision dispatch table, one of CollisionTypeId.
+	 * 
+	 * @see
+	 * CollisionTable
+	 */
+	unsigned char collisionType() const { return m_collisionType; }
+
+	/**
+	 * @brief
+	 * Remembers the current position as the state of the previous simulation tick.
+	 * 
+	 * Called by World right before each simulation tick so that rendering can
+	 * interpolate between the last two simulated states.
+	 * 
+	 * @see
+	 * World::simulate | GameObject::interpolatedX
+	 */
+	void storePreviousState() { m_prevX = m_x; m_prevY = m_y; }
+
+	/**
+	 * @brief
+	 * Position interpolated between the previous and the current simulation tick.
+	 * 
+	 * @param alpha
+	 * Interpolation factor, see Renderable::render.
+	 */
+	float interpolatedX(float alpha) const { return m_prevX + (m_x - m_prevX) * alpha; }
+	float interpolatedY(float alpha) const { return m_prevY + (m_y - m_prevY) * alpha; }
+
+	/**
+	 * @brief
+	 * Center of the object in the current simulation tick.
+	 */
+	sf::Vector2f center() const { return sf::Vector2f(m_x + m_width / 2, m_y + m_height / 2); }
+
+	/**
+	 * @brief
+	 * True if the object overlaps another one in the current tick, touching edges do not count.
+	 */
+	bool overlaps(const GameObject& other) const
+	{
+		return m_x < other.m_x + other.m_width && other.m_x < m_x + m_width
+			&& m_y < other.m_y + other.m_height && other.m_y < m_y + m_height;
+	}
+
+	/**
+	 * @brief
+	 * World space rectangle covered by the object in the previous and the current tick.
+	 * 
+	 * Contains every interpolated position, used to cull objects outside of the view.
+	 * 
+	 * @see
+	 * World::render
+	 */
+	sf::FloatRect bounds() const
+	{
+		return sf::FloatRect(m_x < m_prevX ? m_x : m_prevX, m_y < m_prevY ? m_y : m_prevY,
+			(m_x > m_prevX ? m_x : m_prevX) + m_width, (m_y > m_prevY ? m_y : m_prevY) + m_height);
+	}
+
+	/**
+	 * @brief
+	 * Stores the render state of the object into a snapshot.
+	 * 
+	 * @param snapshot
+	 * The snapshot to fill (output).
+	 * 
+	 * Override to add object specific state, such as sprite frames, and the
+	 * renderer. The base sets no renderer, the object is not drawn.
+	 * 
+	 * @see
+	 * World::captureSnapshot
+	 */
+	virtual void captureSnapshot(ObjectSnapshot& snapshot) const
+	{
+		snapshot.renderer = NULL;
+		snapshot.sprite = NULL;
+		snapshot.x = m_x;
+		snapshot.y = m_y;
+		snapshot.prevX = m_prevX;
+		snapshot.prevY = m_prevY;
+		snapshot.width = m_width;
+		snapshot.height = m_height;
+		snapshot.frame = 0;
+	}
+
+	/**
+	 * @brief
+	 * Appends the simulation state of the object to a state buffer.
+	 * 
+	 * @param state
+	 * The buffer to write to.
+	 * 
+	 * Override to add object specific state, the override must call the base
+	 * class first. Must not allocate.
+	 * 
+	 * @see
+	 * GameObject::loadState | World::saveState
+	 */
+	virtual void saveState(StateBuffer& state) const
+	{
+		state.write(m_x);
+		state.write(m_y);
+		state.write(m_width);
+		state.write(m_height);
+		state.write(m_prevX);
+		state.write(m_prevY);
+	}
+
+	/**
+	 * @brief
+	 * Restores the state written by saveState.
+	 * 
+	 * @param state
+	 * The buffer to read from, positioned where saveState started writing.
+	 * 
+	 * @returns
+	 * False if the buffer ended prematurely.
+	 */
+	virtual bool loadState(StateBuffer& state)
+	{
+		return state.read(m_x) && state.read(m_y) && state.read(m_width) && state.read(m_height)
+			&& state.read(m_prevX) && state.read(m_prevY);
+	}
 
 protected:
 	float m_x, m_y, m_width, m_height;
 
+	/**
+	 * @brief
+	 * Position in the previous simulation tick, used for render interpolation.
+	 */
+	float m_prevX, m_prevY;
+
+private:
+	unsigned char m_collisionType;
 };
 
 #endif
\ No newline at end of file
@@ -4,7 +4,7 @@
 IniReader::KeywordList IniReader::DefaultKeywords;
 
 
-IniReader::IniReader(const std::string& filename, KeywordList& keywords) : m_filename(filename), m_keywords(keywords) {
+IniReader::IniReader(const std::string& filename, KeywordList& keywords) : m_filename(filename), m_keywords(keywords), m_curSection(NULL) {
 	// Initialize basic keywords here
 	if (IniReader::DefaultKeywords.empty())  {
 		(IniReader::DefaultKeywords)["true"] = true;
@@ -14,7 +14,7 @@ IniReader::IniReader(const std::string& filename, KeywordList& keywords) : m_fil
 
 bool IniReader::parse() {
 	std::ifstream f;
-	f.open(m_filename);
+	f.open(m_filename.c_str());
 	if(!f.is_open())
 		return false;
 
@@ -31,9 +31,10 @@ bool IniReader::parse() {
 	std::string propname, section, value;
 	
 	while(f.good()) {
-		unsigned char c = 0;
-		f >> c;
-		if(!f.good()) break;
+		// Not operator>>, it would skip the newlines that end the entries
+		const int ch = f.get();
+		if(ch == EOF) break;
+		const unsigned char c = (unsigned char)ch;
 
 		if(c == '\r') continue; // ignore this
 		
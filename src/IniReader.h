@@ -193,7 +193,7 @@ public:
 		// Try and find a keyword with matching keys
 		KeywordList::const_iterator f = m_keywords.find(string);
 		if(f != m_keywords.end()) {
-			*value = f->second;
+			value = (IntegralT)f->second;
 			return true;
 		}
 
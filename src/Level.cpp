@@ -1,41 +1,757 @@
+#include <cmath>
+#include <cstring>
 #include "Level.h"
-#include "tiles/EmptyTile.h"
+#include "WorldSnapshot.h"
+#include "tiles/BombTile.h"
 
-static sf::Sprite tempSprite = sf::Sprite();
+Level::Level(int width, int height) : m_packDistance(0), m_changeCount(0), m_copySource(NULL), m_copyChangeCount(0), m_tileLogBase(1), m_tileLogActive(false), m_fieldsEnabled(false)
+{
+	reset(width, height);
+}
+
+void Level::reset(int width, int height)
+{
+	sf::Lock lock(m_chunkMutex);
+
+	// All chunks start empty, nothing is allocated for the tiles
+	m_Tilewidth = width;
+	m_Tileheight = height;
+	m_chunksX = (m_Tilewidth + LevelChunk::Size - 1) / LevelChunk::Size;
+	m_chunksY = (m_Tileheight + LevelChunk::Size - 1) / LevelChunk::Size;
+	m_chunks.clear();
+	m_chunks.resize(m_chunksX * m_chunksY);
+	m_chunkChanges.assign(m_chunks.size(), ++m_changeCount);
+	m_active.clear();
+	m_explosions.clear();
+	for(int p = 0; p < TILE_PLANE_COUNT; ++p)
+		m_planes[p].resize(m_Tilewidth, m_Tileheight);
+	m_batch.resize(m_Tilewidth, m_Tileheight);
+	restartTileLog();
+	if(m_fieldsEnabled)
+		resizeFields();
+}
+
+bool Level::load(const LevelFileReader& file)
+{
+	// The file refers to the tile types by name, their ids may differ in this build
+	unsigned char types[256];
+	for(unsigned int i = 0; i < file.typeCount(); ++i)
+	{
+		types[i] = findTileType(file.typeName(i).c_str());
+		if(types[i] == TILE_TYPE_COUNT)
+			return false;
+	}
+
+	reset(file.width(), file.height());
+
+	sf::Lock lock(m_chunkMutex);
+	for(unsigned int i = 0; i < file.chunkCount(); ++i)
+	{
+		size_t size = 0;
+		const unsigned char *packed = file.chunk(i, size);
+		if(size == 0)
+			continue;
+
+		if(size % LevelChunk::RunSize != 0)
+		{
+			m_chunks.assign(m_chunks.size(), LevelChunk());
+			return false;
+		}
+
+		// Translate the type of every run, not of every tile
+		m_loadRuns.assign(packed, packed + size);
+		bool simulated = false;
+		for(size_t run = 0; run < size; run += LevelChunk::RunSize)
+		{
+			if(m_loadRuns[run + 1] >= file.typeCount())
+			{
+				m_chunks.assign(m_chunks.size(), LevelChunk());
+				return false;
+			}
+
+			m_loadRuns[run + 1] = types[m_loadRuns[run + 1]];
+			simulated = simulated || tileType(m_loadRuns[run + 1]).simulate != NULL;
+		}
+
+		setRunPlanes(i, &m_loadRuns[0], size);
+
+		LevelChunk& c = m_chunks[i];
+		c.assignPacked(&m_loadRuns[0], size);
+		if(simulated || m_packDistance <= 0 || size >= LevelChunk::TileCount * sizeof(Tile))
+			c.allocate();
+		if(simulated)
+			activateChunk(i);
+	}
+
+	m_batch.invalidateAll();
+	restartTileLog();
+	return true;
+}
+
+void Level::setTile(int x, int y, unsigned char type)
+{
+	// The tile may still be in the active tile list, keep it marked as such
+	Tile& t = editTile(x, y);
+	t.type = type;
+	t.flags = tileType(type).defaultFlags | (t.flags & TILE_FLAG_QUEUED);
+	t.state = 0;
+	invalidateTile(x, y);
+	updatePlanes(x, y, t);
+
+	if(tileType(type).simulate != NULL)
+		activateTile(x, y);
+}
+
+void Level::setTileFlags(int x, int y, unsigned char flags)
+{
+	Tile& t = editTile(x, y);
+	t.flags = (flags & ~(TILE_FLAG_ACTIVE | TILE_FLAG_QUEUED)) | (t.flags & (TILE_FLAG_ACTIVE | TILE_FLAG_QUEUED));
+	updatePlanes(x, y, t);
+}
+
+void Level::updatePlanes(int x, int y, const Tile& t)
+{
+	const unsigned int planes = planesOf(t);
+	unsigned int changed = 0;
+	for(int p = 0; p < TILE_PLANE_COUNT; ++p)
+	{
+		const bool set = (planes & (1 << p)) != 0;
+		if(m_planes[p].test(x, y) != set)
+		{
+			changed |= 1 << p;
+			m_planes[p].assign(x, y, set);
+		}
+	}
+
+	if(!m_fieldsEnabled)
+		return;
+
+	// Blasts depend on these planes, walking on the solid one only
+	if(changed & ((1 << TILE_PLANE_SOLID) | (1 << TILE_PLANE_DESTRUCTIBLE) | (1 << TILE_PLANE_BOMB)))
+		m_danger.invalidate(x, y);
+	if(changed & (1 << TILE_PLANE_SOLID))
+	{
+		for(size_t i = 0; i < m_distances.size(); ++i)
+			m_distances[i].invalidate(x, y);
+	}
+}
+
+void Level::enableFields()
+{
+	if(!m_fieldsEnabled)
+	{
+		m_fieldsEnabled = true;
+		resizeFields();
+	}
+}
+
+void Level::resizeFields()
+{
+	m_danger.resize(m_Tilewidth, m_Tileheight);
+	for(size_t i = 0; i < m_distances.size(); ++i)
+		m_distances[i].resize(m_Tilewidth, m_Tileheight);
+}
+
+int Level::addDistanceField()
+{
+	enableFields();
+	m_distances.push_back(DistanceField());
+	m_distances.back().resize(m_Tilewidth, m_Tileheight);
+	return (int) m_distances.size() - 1;
+}
+
+void Level::updateFields(unsigned int tick)
+{
+	if(!m_fieldsEnabled)
+		return;
+
+	m_danger.update(*this, tick);
+	for(size_t i = 0; i < m_distances.size(); ++i)
+		m_distances[i].update(*this);
+}
+
+void Level::copyFrom(const Level& source)
+{
+	if(m_Tilewidth != source.m_Tilewidth || m_Tileheight != source.m_Tileheight)
+		reset(source.m_Tilewidth, source.m_Tileheight);
+	if(m_copySource != &source || m_copyChangeCount != m_changeCount || m_copiedChanges.size() != m_chunks.size())
+	{
+		m_copySource = &source;
+		m_copiedChanges.assign(m_chunks.size(), 0);
+	}
+
+	for(int cy = 0; cy < m_chunksY; ++cy)
+	{
+		for(int cx = 0; cx < m_chunksX; ++cx)
+		{
+			const int i = cy * m_chunksX + cx;
+			if(m_copiedChanges[i] == source.m_chunkChanges[i])
+				continue;
+
+			const LevelChunk& c = source.m_chunks[i];
+			c.read(m_chunkTiles);
+			updateChanged(cx, cy, m_chunkTiles);
+			sf::Lock lock(m_chunkMutex);
+			m_chunks[i] = c;
+			m_copiedChanges[i] = source.m_chunkChanges[i];
+			chunkChanged(i);
+		}
+	}
+	m_copyChangeCount = m_changeCount;
+
+	m_active = source.m_active;
+	m_explosions = source.m_explosions;
+	m_fieldsEnabled = source.m_fieldsEnabled;
+	m_danger = source.m_danger;
+	m_distances = source.m_distances;
+}
+
+void Level::blastZone(int x, int y, int radius, BitPlane& zone) const
+{
+	int left, right, top, bottom;
+	blastArms(x, y, radius, left, right, top, bottom);
+	zone.setRow(y, left, right);
+	zone.setColumn(x, top, bottom);
+}
+
+void Level::blastArms(int x, int y, int radius, int& left, int& right, int& top, int& bottom) const
+{
+	const BitPlane& solid = m_planes[TILE_PLANE_SOLID];
+
+	// The nearest solid cell in each direction ends the explosion, destructible ones and bombs burn too
+	const int leftEnd = x - radius > 0 ? x - radius : 0, rightEnd = x + radius < m_Tilewidth - 1 ? x + radius : m_Tilewidth - 1;
+	const int topEnd = y - radius > 0 ? y - radius : 0, bottomEnd = y + radius < m_Tileheight - 1 ? y + radius : m_Tileheight - 1;
+	left = leftEnd;
+	right = rightEnd;
+	top = topEnd;
+	bottom = bottomEnd;
+	int hit;
+	if(x > 0 && (hit = solid.findInRow(y, x - 1, leftEnd)) >= 0)
+		left = isBlastable(hit, y) ? hit : hit + 1;
+	if(x < m_Tilewidth - 1 && (hit = solid.findInRow(y, x + 1, rightEnd)) >= 0)
+		right = isBlastable(hit, y) ? hit : hit - 1;
+	if(y > 0 && (hit = solid.findInColumn(x, y - 1, topEnd)) >= 0)
+		top = isBlastable(x, hit) ? hit : hit + 1;
+	if(y < m_Tileheight - 1 && (hit = solid.findInColumn(x, y + 1, bottomEnd)) >= 0)
+		bottom = isBlastable(x, hit) ? hit : hit - 1;
+}
+
+/**
+ * @brief
+ * Times the edges of a moving interval enter and leave a fixed one, as fractions of the movement.
+ * 
+ * @returns
+ * False if the intervals never overlap.
+ */
+static bool sweepAxis(float start, float end, float delta, float cellStart, float cellEnd, float& entry, float& exit)
+{
+	if(delta == 0)
+	{
+		// Standing still, overlapping all the time or never
+		entry = -HUGE_VAL;
+		exit = HUGE_VAL;
+		return start < cellEnd && cellStart < end;
+	}
+
+	if(delta > 0)
+	{
+		entry = (cellStart - end) / delta;
+		exit = (cellEnd - start) / delta;
+	}
+	else
+	{
+		entry = (cellEnd - start) / delta;
+		exit = (cellStart - end) / delta;
+	}
+	return true;
+}
+
+bool Level::sweep(const sf::FloatRect& rect, float dx, float dy, TileHit& hit) const
+{
+	// Cells of the whole path, and the cells overlapped at the start which do not block
+	const float left = rect.Left + (dx < 0 ? dx : 0), right = rect.Right + (dx > 0 ? dx : 0);
+	const float top = rect.Top + (dy < 0 ? dy : 0), bottom = rect.Bottom + (dy > 0 ? dy : 0);
+	const int pathLeft = (int)floor(left / LEVEL_TILE_WIDTH), pathRight = (int)ceil(right / LEVEL_TILE_WIDTH) - 1;
+	const int pathTop = (int)floor(top / LEVEL_TILE_HEIGHT), pathBottom = (int)ceil(bottom / LEVEL_TILE_HEIGHT) - 1;
+	const int startLeft = (int)floor(rect.Left / LEVEL_TILE_WIDTH), startRight = (int)ceil(rect.Right / LEVEL_TILE_WIDTH) - 1;
+	const int startTop = (int)floor(rect.Top / LEVEL_TILE_HEIGHT), startBottom = (int)ceil(rect.Bottom / LEVEL_TILE_HEIGHT) - 1;
+
+	bool found = false;
+	hit.time = 1;
+	for(int y = pathTop; y <= pathBottom; ++y)
+	{
+		for(int x = pathLeft; x <= pathRight; ++x)
+		{
+			if(x >= startLeft && x <= startRight && y >= startTop && y <= startBottom)
+				continue;
+			if(isInside(x, y) && !isSolid(x, y))
+				continue;
+
+			float entryX, exitX, entryY, exitY;
+			if(!sweepAxis(rect.Left, rect.Right, dx, (float)(x * LEVEL_TILE_WIDTH), (float)((x + 1) * LEVEL_TILE_WIDTH), entryX, exitX)
+				|| !sweepAxis(rect.Top, rect.Bottom, dy, (float)(y * LEVEL_TILE_HEIGHT), (float)((y + 1) * LEVEL_TILE_HEIGHT), entryY, exitY))
+				continue;
+
+			// Touching the cell at the end of the movement or leaving it is no hit, on a tie the earlier cell wins
+			const float entry = entryX > entryY ? entryX : entryY, exit = exitX < exitY ? exitX : exitY;
+			if(exit <= 0 || entry >= exit || entry >= hit.time)
+				continue;
+
+			found = true;
+			hit.time = entry > 0 ? entry : 0;
+			hit.x = x;
+			hit.y = y;
+
+			// Reaching both sides at once (a corner) blocks the horizontal movement
+			hit.normalX = entryX >= entryY ? (dx > 0 ? -1 : 1) : 0;
+			hit.normalY = entryX >= entryY ? 0 : (dy > 0 ? -1 : 1);
+		}
+	}
+	return found;
+}
+
+sf::Vector2f Level::slide(const sf::FloatRect& rect, float dx, float dy) const
+{
+	const float width = rect.Right - rect.Left, height = rect.Bottom - rect.Top;
+	float x = rect.Left, y = rect.Top;
+
+	// Every contact stops one axis, so there are at most two
+	TileHit hit;
+	for(int contact = 0; contact < 2 && (dx != 0 || dy != 0); ++contact)
+	{
+		if(!sweep(sf::FloatRect(x, y, x + width, y + height), dx, dy, hit))
+			break;
+
+		// Snap the blocked axis onto the side of the cell, so rounding never leaves the rectangle inside it
+		if(hit.normalX != 0)
+		{
+			x = hit.normalX < 0 ? (float)(hit.x * LEVEL_TILE_WIDTH) - width : (float)((hit.x + 1) * LEVEL_TILE_WIDTH);
+			y += dy * hit.time;
+			dy *= 1 - hit.time;
+			dx = 0;
+		}
+		else
+		{
+			y = hit.normalY < 0 ? (float)(hit.y * LEVEL_TILE_HEIGHT) - height : (float)((hit.y + 1) * LEVEL_TILE_HEIGHT);
+			x += dx * hit.time;
+			dx *= 1 - hit.time;
+			dy = 0;
+		}
+	}
+	return sf::Vector2f(x + dx, y + dy);
+}
+
+void Level::detonate(int x, int y)
+{
+	const Tile t = tile(x, y);
+	if(t.type != TILE_BOMB)
+		return;
+
+	// The bomb turns into fire right away, so that no other explosion queues it again
+	const Explosion explosion = { y * m_Tilewidth + x, BombTile::radius(t) };
+	m_explosions.push_back(explosion);
+	setTile(x, y, TILE_FLAME);
+}
+
+void Level::resolveExplosions()
+{
+	// Bombs reached by an explosion are appended, so chains resolve in this pass in a fixed order
+	for(size_t i = 0; i < m_explosions.size(); ++i)
+	{
+		const Explosion explosion = m_explosions[i];
+		const int x = explosion.index % m_Tilewidth, y = explosion.index / m_Tilewidth;
+		int left, right, top, bottom;
+		blastArms(x, y, explosion.radius, left, right, top, bottom);
+
+		for(int cx = left; cx <= right; ++cx)
+			burn(cx, y);
+		for(int cy = top; cy <= bottom; ++cy)
+		{
+			if(cy != y)
+				burn(x, cy);
+		}
+	}
+
+	m_explosions.clear();
+}
 
-Level::Level(int width, int height) : m_Tilewidth(width), m_Tileheight(height) 
+void Level::burn(int x, int y)
 {
-	tempSprite.Resize(LEVEL_TILE_WIDTH, LEVEL_TILE_HEIGHT);
-	m_tileArray.resize(boost::extents[m_Tilewidth][m_Tileheight]);
-	for(index i = 0; i < m_Tilewidth; ++i)
+	if(m_planes[TILE_PLANE_BOMB].test(x, y))
+		detonate(x, y);
+	else
+		setTile(x, y, TILE_FLAME);
+}
+
+void Level::activateTile(int x, int y)
+{
+	Tile& t = editTile(x, y);
+	t.flags |= TILE_FLAG_ACTIVE;
+	if(t.flags & TILE_FLAG_QUEUED)
+		return;
+
+	t.flags |= TILE_FLAG_QUEUED;
+	m_active.push_back(y * m_Tilewidth + x);
+}
+
+void Level::setRunPlanes(int chunk, const unsigned char *packed, size_t size)
+{
+	const int left = (chunk % m_chunksX) * LevelChunk::Size, top = (chunk / m_chunksX) * LevelChunk::Size;
+
+	int index = 0;
+	for(size_t run = 0; run + LevelChunk::RunSize <= size; run += LevelChunk::RunSize)
 	{
-		for(index j = 0; j < m_Tileheight; ++j)
+		Tile t;
+		t.type = packed[run + 1];
+		t.flags = packed[run + 2];
+		const unsigned int planes = planesOf(t);
+		const int end = index + packed[run];
+
+		// A run continues over the ends of the chunk rows, set it row by row
+		for(int first = index; planes != 0 && first < end; )
 		{
-			m_tileArray[i][j] = new EmptyTile((float) (i * LEVEL_TILE_WIDTH), (float) (j * LEVEL_TILE_HEIGHT), tempSprite);
+			const int row = first / LevelChunk::Size, last = end - 1 < (row + 1) * LevelChunk::Size - 1 ? end - 1 : (row + 1) * LevelChunk::Size - 1;
+			const int y = top + row, x1 = left + first % LevelChunk::Size, x2 = left + last % LevelChunk::Size;
+			if(y < m_Tileheight && x1 < m_Tilewidth)
+			{
+				for(int p = 0; p < TILE_PLANE_COUNT; ++p)
+				{
+					if(planes & (1 << p))
+						m_planes[p].setRow(y, x1, x2 < m_Tilewidth ? x2 : m_Tilewidth - 1);
+				}
+			}
+			first = last + 1;
 		}
+		index = end;
 	}
 }
 
-void Level::render(sf::RenderTarget& target, DeltaTime dt)
+void Level::activateChunk(int chunk)
 {
-	for(index i = 0; i < m_Tilewidth; ++i)
+	const int left = (chunk % m_chunksX) * LevelChunk::Size, top = (chunk / m_chunksX) * LevelChunk::Size;
+	const int right = left + LevelChunk::Size < m_Tilewidth ? left + LevelChunk::Size : m_Tilewidth;
+	const int bottom = top + LevelChunk::Size < m_Tileheight ? top + LevelChunk::Size : m_Tileheight;
+
+	for(int j = top; j < bottom; ++j)
 	{
-		for(index j = 0; j < m_Tileheight; ++j)
+		for(int i = left; i < right; ++i)
 		{
-			if(m_tileArray[i][j] != NULL)
-				m_tileArray[i][j]->render(target, dt);
+			if(tileType(tile(i, j).type).simulate != NULL)
+				activateTile(i, j);
 		}
 	}
 }
+
+Tile& Level::allocateTile(LevelChunk& c, int index)
+{
+	sf::Lock lock(m_chunkMutex);
+	return c.edit(index);
+}
+
+void Level::render(sf::RenderTarget& target, DeltaTime dt, float alpha)
+{
+	render(target, Camera(target.GetView().GetRect()), dt, alpha);
+}
+
+void Level::render(sf::RenderTarget& target, const Camera& camera, DeltaTime dt, float alpha)
+{
+	m_batch.render(target, *this, visibleTiles(camera));
+}
+
+sf::IntRect Level::visibleTiles(const Camera& camera, int width, int height)
+{
+	const sf::FloatRect& view = camera.rect();
+	int left = (int) floor(view.Left / LEVEL_TILE_WIDTH), top = (int) floor(view.Top / LEVEL_TILE_HEIGHT);
+	int right = (int) ceil(view.Right / LEVEL_TILE_WIDTH), bottom = (int) ceil(view.Bottom / LEVEL_TILE_HEIGHT);
+
+	left = left < 0 ? 0 : left;
+	top = top < 0 ? 0 : top;
+	right = right > width ? width : right;
+	bottom = bottom > height ? height : bottom;
+	if(right <= left || bottom <= top)
+		return sf::IntRect(0, 0, 0, 0);
+
+	return sf::IntRect(left, top, right, bottom);
+}
 	
-void Level::simulate(DeltaTime dt) 
+void Level::simulate(DeltaTime dt)
+{
+	// Tiles activated during the pass are appended, they are simulated from the next tick on
+	const size_t count = m_active.size();
+	size_t kept = 0;
+	for(size_t i = 0; i < count; ++i)
+	{
+		const int index = m_active[i];
+		const int x = index % m_Tilewidth, y = index / m_Tilewidth;
+
+		// Queued tiles are in allocated chunks, the reference stays valid during the simulation
+		Tile& t = editTile(x, y);
+		if(t.flags & TILE_FLAG_ACTIVE)
+		{
+			const TileType& type = tileType(t.type);
+			if(type.simulate != NULL)
+				type.simulate(*this, x, y, dt);
+		}
+
+		// Drop the tiles deactivated before or during their simulation
+		if(t.flags & TILE_FLAG_ACTIVE)
+			m_active[kept++] = index;
+		else
+			t.flags &= ~TILE_FLAG_QUEUED;
+	}
+
+	m_active.erase(m_active.begin() + kept, m_active.begin() + count);
+
+	if(!m_explosions.empty())
+		resolveExplosions();
+}
+
+void Level::compact(const std::vector<sf::FloatRect>& activeAreas)
+{
+	const float chunkWidth = (float) (LevelChunk::Size * LEVEL_TILE_WIDTH), chunkHeight = (float) (LevelChunk::Size * LEVEL_TILE_HEIGHT);
+	const float marginX = (float) (m_packDistance * LEVEL_TILE_WIDTH), marginY = (float) (m_packDistance * LEVEL_TILE_HEIGHT);
+
+	// Releasing and packing free tile arrays the render thread may be reading, see TileBatch::update
+	sf::Lock lock(m_chunkMutex);
+	for(int cy = 0; cy < m_chunksY; ++cy)
+	{
+		for(int cx = 0; cx < m_chunksX; ++cx)
+		{
+			LevelChunk& c = m_chunks[cy * m_chunksX + cx];
+			if(!c.isAllocated() || c.release() || m_packDistance <= 0)
+				continue;
+
+			// Keep chunks near the players unpacked, they are likely to change soon
+			const sf::FloatRect area(cx * chunkWidth - marginX, cy * chunkHeight - marginY,
+				(cx + 1) * chunkWidth + marginX, (cy + 1) * chunkHeight + marginY);
+			bool active = false;
+			for(size_t i = 0; i < activeAreas.size() && !active; ++i)
+				active = activeAreas[i].Right > area.Left && activeAreas[i].Left < area.Right && activeAreas[i].Bottom > area.Top && activeAreas[i].Top < area.Bottom;
+			if(active)
+				continue;
+
+			// Active tiles need the unpacked tiles every tick
+			const Tile *tiles = c.tiles();
+			bool queued = false;
+			for(int i = 0; i < LevelChunk::TileCount && !queued; ++i)
+				queued = (tiles[i].flags & TILE_FLAG_QUEUED) != 0;
+			if(!queued)
+				c.pack();
+		}
+	}
+}
+
+void Level::captureTiles(TileSnapshot& snapshot)
+{
+	m_tileLogActive = true;
+	const unsigned int version = m_tileLogBase + (unsigned int) m_tileLog.size();
+
+	if(snapshot.width != m_Tilewidth || snapshot.height != m_Tileheight || snapshot.version < m_tileLogBase)
+	{
+		snapshot.width = m_Tilewidth;
+		snapshot.height = m_Tileheight;
+		snapshot.types.resize(m_Tilewidth * m_Tileheight);
+		for(int y = 0; y < m_Tileheight; ++y)
+		{
+			for(int x = 0; x < m_Tilewidth; ++x)
+				snapshot.types[y * m_Tilewidth + x] = tile(x, y).type;
+		}
+	}
+	else
+	{
+		for(size_t i = snapshot.version - m_tileLogBase; i < m_tileLog.size(); ++i)
+		{
+			const int index = m_tileLog[i];
+			snapshot.types[index] = tile(index % m_Tilewidth, index / m_Tilewidth).type;
+		}
+	}
+	snapshot.version = version;
+
+	// A long log costs more to replay than copying the level, snapshots behind it are copied whole instead
+	const size_t maxLog = (size_t) (m_Tilewidth * m_Tileheight) / 16;
+	if(m_tileLog.size() > (maxLog > 4096 ? maxLog : 4096))
+		restartTileLog();
+}
+
+size_t Level::memoryUsage() const
+{
+	size_t usage = m_chunks.capacity() * sizeof(LevelChunk);
+	for(size_t i = 0; i < m_chunks.size(); ++i)
+		usage += m_chunks[i].memoryUsage();
+	return usage;
+}
+
+int Level::allocatedChunkCount() const
+{
+	int count = 0;
+	for(size_t i = 0; i < m_chunks.size(); ++i)
+	{
+		if(m_chunks[i].isAllocated())
+			++count;
+	}
+	return count;
+}
+
+unsigned int Level::hash() const
+{
+	unsigned int hash = 2166136261u;
+	const unsigned int size[2] = { (unsigned int) m_Tilewidth, (unsigned int) m_Tileheight };
+	for(int i = 0; i < 2; ++i)
+	{
+		// Byte by byte, so the hash does not depend on the byte order of the machine
+		for(int b = 0; b < 32; b += 8)
+			hash = (hash ^ ((size[i] >> b) & 0xff)) * 16777619u;
+	}
+
+	for(int y = 0; y < m_Tileheight; ++y)
+	{
+		for(int x = 0; x < m_Tilewidth; ++x)
+		{
+			const Tile t = tile(x, y);
+			hash = (hash ^ t.type) * 16777619u;
+			hash = (hash ^ t.flags) * 16777619u;
+			hash = (hash ^ t.state) * 16777619u;
+		}
+	}
+	return hash;
+}
+
+void Level::saveState(StateBuffer& state) const
+{
+	state.write(m_Tilewidth);
+	state.write(m_Tileheight);
+
+	// Per chunk: 0 for empty, 1 followed by the tiles, 2 followed by the packed runs
+	for(size_t i = 0; i < m_chunks.size(); ++i)
+	{
+		const LevelChunk& c = m_chunks[i];
+		const unsigned char kind = c.isEmpty() ? 0 : (c.isPacked() ? 2 : 1);
+		state.write(kind);
+		if(kind == 1)
+		{
+			state.write(c.tiles(), LevelChunk::TileCount * sizeof(Tile));
+		}
+		else if(kind == 2)
+		{
+			const unsigned int size = (unsigned int) c.packed().size();
+			state.write(size);
+			state.write(&c.packed()[0], size);
+		}
+	}
+
+	const unsigned int active = (unsigned int) m_active.size();
+	state.write(active);
+	if(active > 0)
+		state.write(&m_active[0], active * sizeof(int));
+
+	// Explosions are pending only when detonate was called outside of simulate
+	const unsigned int explosions = (unsigned int) m_explosions.size();
+	state.write(explosions);
+	if(explosions > 0)
+		state.write(&m_explosions[0], explosions * sizeof(Explosion));
+}
+
+void Level::updateChanged(int chunkX, int chunkY, const Tile *saved)
 {
-	for(index i = 0; i < m_Tilewidth; ++i)
+	const LevelChunk& c = m_chunks[chunkY * m_chunksX + chunkX];
+	const int left = chunkX * LevelChunk::Size, top = chunkY * LevelChunk::Size;
+	const int right = left + LevelChunk::Size < m_Tilewidth ? left + LevelChunk::Size : m_Tilewidth;
+	const int bottom = top + LevelChunk::Size < m_Tileheight ? top + LevelChunk::Size : m_Tileheight;
+
+	for(int j = top; j < bottom; ++j)
 	{
-		for(index j = 0; j < m_Tileheight; ++j)
+		for(int i = left; i < right; ++i)
 		{
-			if(m_tileArray[i][j] != NULL)
-				m_tileArray[i][j]->simulate(dt);
+			const Tile current = c.tile(chunkIndex(i, j)), restored = saved[chunkIndex(i, j)];
+			if(current.type != restored.type)
+				invalidateTile(i, j);
+			if(planesOf(current) != planesOf(restored))
+				updatePlanes(i, j, restored);
 		}
 	}
-}
\ No newline at end of file
+}
+
+bool Level::loadState(StateBuffer& state)
+{
+	int width = 0, height = 0;
+	if(!state.read(width) || !state.read(height) || width != m_Tilewidth || height != m_Tileheight)
+		return false;
+
+	for(int cy = 0; cy < m_chunksY; ++cy)
+	{
+		for(int cx = 0; cx < m_chunksX; ++cx)
+		{
+			LevelChunk& c = m_chunks[cy * m_chunksX + cx];
+			unsigned char kind = 0;
+			if(!state.read(kind))
+				return false;
+
+			// Only update the chunks and tiles the rollback actually changed
+			if(kind == 0)
+			{
+				if(c.isEmpty())
+					continue;
+
+				memset(m_chunkTiles, 0, sizeof(m_chunkTiles));
+				updateChanged(cx, cy, m_chunkTiles);
+				chunkChanged(cy * m_chunksX + cx);
+				sf::Lock lock(m_chunkMutex);
+				c.clear();
+			}
+			else if(kind == 1)
+			{
+				const Tile *saved = (const Tile *) state.skip(LevelChunk::TileCount * sizeof(Tile));
+				if(saved == NULL)
+					return false;
+
+				if(c.isAllocated() && memcmp(saved, c.tiles(), LevelChunk::TileCount * sizeof(Tile)) == 0)
+					continue;
+
+				updateChanged(cx, cy, saved);
+				chunkChanged(cy * m_chunksX + cx);
+				sf::Lock lock(m_chunkMutex);
+				c.assign(saved);
+			}
+			else
+			{
+				unsigned int size = 0;
+				const unsigned char *packed = NULL;
+				if(!state.read(size) || (packed = (const unsigned char *) state.skip(size)) == NULL)
+					return false;
+
+				if(c.isPacked() && c.packed().size() == size && memcmp(packed, &c.packed()[0], size) == 0)
+					continue;
+
+				// Restored packed into the buffer of the chunk, so the next save writes the same runs
+				LevelChunk::unpack(packed, size, m_chunkTiles);
+				updateChanged(cx, cy, m_chunkTiles);
+				chunkChanged(cy * m_chunksX + cx);
+				sf::Lock lock(m_chunkMutex);
+				c.assignPacked(packed, size);
+			}
+		}
+	}
+
+	unsigned int active = 0;
+	if(!state.read(active))
+		return false;
+
+	// Read, not cast in place, the state buffer does not align its contents
+	m_active.resize(active);
+	if(active > 0 && !state.read(&m_active[0], active * sizeof(int)))
+		return false;
+
+	unsigned int explosions = 0;
+	if(!state.read(explosions))
+		return false;
+
+	m_explosions.resize(explosions);
+	if(explosions > 0 && !state.read(&m_explosions[0], explosions * sizeof(Explosion)))
+		return false;
+
+	// The fuses went back in time as well, the fields are rebuilt by the next updateFields
+	m_danger.invalidateAll();
+	for(size_t i = 0; i < m_distances.size(); ++i)
+		m_distances[i].invalidateAll();
+	return true;
+}
@@ -1,8 +1,20 @@
 #ifndef LEVEL_H
 #define LEVEL_H
 
-#include <boost/multi_array.hpp>
+#include <vector>
+#include "Renderable.h"
+#include "Simulable.h"
+#include "StateBuffer.h"
 #include "Tile.h"
+#include "LevelChunk.h"
+#include "LevelFile.h"
+#include "BitPlane.h"
+#include "DangerField.h"
+#include "DistanceField.h"
+#include "TileBatch.h"
+#include "Camera.h"
+
+struct TileSnapshot;
 
 /**
  * @brief
@@ -15,6 +27,30 @@ static const int LEVEL_TILE_WIDTH = 40;
  */
 static const int LEVEL_TILE_HEIGHT = 40;
 
+/**
+ * @brief
+ * First solid cell in the way of a moving rectangle, see Level::sweep.
+ */
+struct TileHit  {
+	/**
+	 * @brief
+	 * Fraction of the movement done before the contact, in [0, 1).
+	 */
+	float time;
+
+	/**
+	 * @brief
+	 * Normal of the side of the cell that was hit, pointing out of the cell: one axis is -1 or 1, the other 0.
+	 */
+	int normalX, normalY;
+
+	/**
+	 * @brief
+	 * Column and row of the cell.
+	 */
+	int x, y;
+};
+
 /**
  * @brief
  * Container for whole level information.
@@ -22,26 +58,590 @@ static const int LEVEL_TILE_HEIGHT = 40;
  * Level contains information about its content, 
  * know how to draw it and simulate changes during time
  * 
+ * The tiles are stored in chunks of LevelChunk::Size x LevelChunk::Size tiles,
+ * allocated when a tile in them is first changed, so memory and startup time
+ * scale with the used part of the level. Behaviour of each tile is looked up
+ * in the tile type table. Only the tiles in the active tile list are simulated,
+ * so the cost of a tick does not depend on the level size. Cell properties are
+ * mirrored in bit-planes, which gameplay queries instead of the tiles. For the
+ * bots the level can also maintain danger and distance fields, see enableFields.
+ * Rendering draws prebuilt vertex arrays of the tiles, tiles that change must be
+ * passed to invalidateTile.
+ * 
  * @see
- * GameObject
+ * Tile | TileType
  */
 class Level : public Renderable, public Simulable {
 public:
 	Level(int width, int height);
-	~Level() {}
 
-	void render(sf::RenderTarget& target, DeltaTime dt);
+	void render(sf::RenderTarget& target, DeltaTime dt, float alpha);
 	void simulate(DeltaTime dt);
 
+	/**
+	 * @brief
+	 * Resizes the level and makes all its tiles empty.
+	 */
+	void reset(int width, int height);
+
+	/**
+	 * @brief
+	 * Replaces the level by the contents of a level file.
+	 * 
+	 * @param file
+	 * An open level file.
+	 * 
+	 * @returns
+	 * False if the file uses tile types unknown to this build or contains invalid
+	 * tiles. The level is left empty then.
+	 * 
+	 * The packed chunks of the file are copied as they are, tile types are
+	 * translated per run. Chunks are unpacked only if they contain simulated
+	 * tiles, packing would not save memory or packing is disabled, see setPackDistance.
+	 */
+	bool load(const LevelFileReader& file);
+
+	/**
+	 * @brief
+	 * Renders the tiles visible by a camera.
+	 * 
+	 * @param target
+	 * The render target.
+	 * 
+	 * @param camera
+	 * The camera, only tiles inside its view are drawn.
+	 * 
+	 * @param dt
+	 * Delta time of last frame.
+	 * 
+	 * @param alpha
+	 * Interpolation factor, see Renderable::render.
+	 */
+	void render(sf::RenderTarget& target, const Camera& camera, DeltaTime dt, float alpha);
+
+	/**
+	 * @brief
+	 * Rectangle of the tiles visible by a camera, clamped to the level.
+	 * 
+	 * @returns
+	 * Tile coordinates, Right and Bottom exclusive. Empty when the camera looks outside of the level.
+	 */
+	sf::IntRect visibleTiles(const Camera& camera) const { return visibleTiles(camera, m_Tilewidth, m_Tileheight); }
+
+	/**
+	 * @brief
+	 * Rectangle of the tiles visible by a camera, clamped to a level of the given size.
+	 */
+	static sf::IntRect visibleTiles(const Camera& camera, int width, int height);
+
+	/**
+	 * @brief
+	 * Appends the state of all tiles to a state buffer.
+	 * 
+	 * @see
+	 * World::saveState
+	 */
+	void saveState(StateBuffer& state) const;
+
+	/**
+	 * @brief
+	 * Restores the tile state written by saveState.
+	 * 
+	 * @returns
+	 * False if the buffer does not hold a level of this size.
+	 */
+	bool loadState(StateBuffer& state);
+
+	/**
+	 * @brief
+	 * Places a tile of the given type, with the default flags of the type.
+	 * 
+	 * The tile is activated if its type has a simulate function and deactivated otherwise.
+	 * 
+	 * @param x
+	 * Column of the tile.
+	 * 
+	 * @param y
+	 * Row of the tile.
+	 * 
+	 * @param type
+	 * One of TileTypeId.
+	 */
+	void setTile(int x, int y, unsigned char type);
+
+	/**
+	 * @brief
+	 * Changes the flags of a tile (combination of TileFlags) and updates the planes.
+	 * 
+	 * TILE_FLAG_ACTIVE and TILE_FLAG_QUEUED are kept, see activateTile.
+	 */
+	void setTileFlags(int x, int y, unsigned char flags);
+
+	/**
+	 * @brief
+	 * Marks a tile whose type changed, it is drawn updated on the next render.
+	 * 
+	 * @param x
+	 * Column of the tile.
+	 * 
+	 * @param y
+	 * Row of the tile.
+	 * 
+	 * Needed only when a tile is changed through editTile(), setTile does it automatically.
+	 * The change is also logged for captureTiles.
+	 */
+	void invalidateTile(int x, int y)
+	{
+		m_batch.invalidate(y * m_Tilewidth + x);
+		if(m_tileLogActive)
+			m_tileLog.push_back(y * m_Tilewidth + x);
+	}
+
+	/**
+	 * @brief
+	 * Brings a tile snapshot up to date with the level.
+	 * 
+	 * @param snapshot
+	 * The snapshot, empty or captured from this level before.
+	 * 
+	 * Only the tiles changed since the snapshot was captured last are copied.
+	 * Snapshots of another level size, or older than the oldest logged change,
+	 * are copied whole. The change log is kept from the first call on and
+	 * restarted when it grows too long.
+	 * 
+	 * @see
+	 * World::captureSnapshot | TileBatch::update
+	 */
+	void captureTiles(TileSnapshot& snapshot);
+
+	/**
+	 * @brief
+	 * Returns a tile for modification.
+	 * 
+	 * @param x
+	 * Column of the tile.
+	 * 
+	 * @param y
+	 * Row of the tile.
+	 * 
+	 * Allocates the chunk of the tile if needed and marks it changed for
+	 * copyFrom. Meant for the type specific state,
+	 * use setTile and setTileFlags to change the type and flags, they keep the planes
+	 * and the vertex arrays up to date.
+	 */
+	Tile& editTile(int x, int y)
+	{
+		const int n = chunkNumber(x, y);
+		LevelChunk& c = m_chunks[n];
+		m_chunkChanges[n] = ++m_changeCount;
+		return c.isAllocated() ? c.edit(chunkIndex(x, y)) : allocateTile(c, chunkIndex(x, y));
+	}
+
+	/**
+	 * @brief
+	 * Adds a tile to the tiles simulated every tick.
+	 * 
+	 * @param x
+	 * Column of the tile.
+	 * 
+	 * @param y
+	 * Row of the tile.
+	 * 
+	 * Does nothing if the tile is active already. Tiles activated while the level is
+	 * being simulated are simulated from the next tick on.
+	 */
+	void activateTile(int x, int y);
+
+	/**
+	 * @brief
+	 * Stops simulating a tile, for example when its animation ended.
+	 * 
+	 * The tile stays in the active tile list until the next simulate(), which drops it.
+	 * May be called from the simulate function of the tile itself.
+	 */
+	void deactivateTile(int x, int y) { editTile(x, y).flags &= ~TILE_FLAG_ACTIVE; }
+
+	/**
+	 * @brief
+	 * Marks the cells an explosion reaches in a plane.
+	 * 
+	 * @param x
+	 * Column of the explosion.
+	 * 
+	 * @param y
+	 * Row of the explosion.
+	 * 
+	 * @param radius
+	 * Range of the explosion in tiles, in each of the four directions.
+	 * 
+	 * @param zone
+	 * Plane of the level size (output). It is not cleared, so the zones of several
+	 * explosions can be collected in one plane.
+	 * 
+	 * The explosion stops in front of solid cells, destructible ones and bombs are reached.
+	 * Each direction is found by one word-parallel scan of the solid plane.
+	 */
+	void blastZone(int x, int y, int radius, BitPlane& zone) const;
+
+	/**
+	 * @brief
+	 * Finds the first solid cell a moving rectangle runs into (swept AABB test).
+	 * 
+	 * @param rect
+	 * Rectangle at the start of the movement in world space, the right and bottom edges are exclusive.
+	 * 
+	 * @param dx
+	 * Horizontal movement in world space.
+	 * 
+	 * @param dy
+	 * Vertical movement in world space.
+	 * 
+	 * @param hit
+	 * The contact (output), only set when something was hit.
+	 * 
+	 * @returns
+	 * True if the rectangle hits a solid cell before the end of the movement.
+	 * 
+	 * Cells outside of the level count as solid. Cells the rectangle overlaps at
+	 * the start are ignored, so a player can walk off a bomb placed under it.
+	 * Touching a cell is no overlap: a rectangle touching a wall can slide along
+	 * it, but not move into it. The whole path is tested, however long, so large
+	 * time steps cannot tunnel through walls. The cost grows with the cells
+	 * covered by the path, a few for a usual tick.
+	 * 
+	 * @see
+	 * slide
+	 */
+	bool sweep(const sf::FloatRect& rect, float dx, float dy, TileHit& hit) const;
+
+	/**
+	 * @brief
+	 * Moves a rectangle as far as the solid cells let it, sliding along the cells it hits.
+	 * 
+	 * @param rect
+	 * Rectangle at the start of the movement in world space, see sweep.
+	 * 
+	 * @param dx
+	 * Horizontal movement in world space.
+	 * 
+	 * @param dy
+	 * Vertical movement in world space.
+	 * 
+	 * @returns
+	 * Top left corner of the rectangle at the end of the movement.
+	 * 
+	 * At a contact the rectangle is placed exactly onto the side of the cell and
+	 * the rest of the movement continues along it, without the part into the cell.
+	 */
+	sf::Vector2f slide(const sf::FloatRect& rect, float dx, float dy) const;
+
+	/**
+	 * @brief
+	 * Explodes a bomb, does nothing if the tile is not a bomb.
+	 * 
+	 * @param x
+	 * Column of the bomb.
+	 * 
+	 * @param y
+	 * Row of the bomb.
+	 * 
+	 * The bomb is replaced by a flame and its explosion is queued. The queue is
+	 * resolved at the end of simulate(): every explosion sets its blast zone on
+	 * fire, destroys the destructible cells at its ends and detonates the bombs
+	 * it reaches, which are appended to the queue. Whole chains so explode in the
+	 * tick they started in, in the order the bombs were reached.
+	 * 
+	 * @see
+	 * blastZone | BombTile
+	 */
+	void detonate(int x, int y);
+
+	/**
+	 * @brief
+	 * Frees chunks that contain only empty tiles and packs static chunks far from the players.
+	 * 
+	 * @param activeAreas
+	 * World space rectangles around which chunks stay unpacked, such as player bounds.
+	 * 
+	 * Chunks are packed only when setPackDistance enabled it and none of their
+	 * tiles is simulated. Packed chunks are unpacked again when a tile in them changes.
+	 * 
+	 * @see
+	 * World::simulate
+	 */
+	void compact(const std::vector<sf::FloatRect>& activeAreas);
+
+	/**
+	 * @brief
+	 * Enables packing of chunks far from the active areas.
+	 * 
+	 * @param tiles
+	 * Minimum distance of a packed chunk from every active area in tiles, 0 disables packing.
+	 * 
+	 * @see
+	 * Level::compact
+	 */
+	void setPackDistance(int tiles) { m_packDistance = tiles; }
+
+	/**
+	 * @brief
+	 * Starts maintaining the danger field and the distance fields.
+	 * 
+	 * Costs two bytes per cell and field, so it is off until bots need it.
+	 * 
+	 * @see
+	 * danger | addDistanceField
+	 */
+	void enableFields();
+
+	/**
+	 * @brief
+	 * Adds a field of walking distances, enables the fields.
+	 * 
+	 * @returns
+	 * Index of the field, for setDistanceSource and distances.
+	 */
+	int addDistanceField();
+
+	/**
+	 * @brief
+	 * Moves the source of a distance field, for example to the cell of its player.
+	 */
+	void setDistanceSource(int field, int x, int y) { m_distances[field].setSource(x, y); }
+
+	/**
+	 * @brief
+	 * Brings the danger and distance fields up to date with the tile changes since the last call.
+	 * 
+	 * @param tick
+	 * Number of ticks simulated so far, see World::tick.
+	 * 
+	 * Only the parts affected by the changes are recomputed. Called once per
+	 * tick, after the level and the objects were simulated.
+	 */
+	void updateFields(unsigned int tick);
+
+	/**
+	 * @brief
+	 * Makes this level a copy of another one, tiles, active tiles and fields.
+	 * 
+	 * @param source
+	 * The level to copy, resized to if the sizes differ.
+	 * 
+	 * Repeated copies of the same source copy only the chunks changed in the
+	 * source since the last copy, so a copy per tick costs the changes, not
+	 * the level. Chunks are copied as they are, packed chunks stay packed.
+	 * Changing this level in between makes the next copy a full one.
+	 * 
+	 * @see
+	 * World::copyView
+	 */
+	void copyFrom(const Level& source);
+
+	// Properties
+
+	Tile tile(int x, int y) const { return chunk(x, y).tile(chunkIndex(x, y)); }
+
+	/**
+	 * @brief
+	 * One of the bit-planes, see TilePlane.
+	 */
+	const BitPlane& plane(int plane) const { return m_planes[plane]; }
+
+	bool isSolid(int x, int y) const { return m_planes[TILE_PLANE_SOLID].test(x, y); }
+
+	/**
+	 * @brief
+	 * True if a solid cell burns when an explosion reaches it (destructible walls and bombs), see blastZone.
+	 */
+	bool isBlastable(int x, int y) const { return m_planes[TILE_PLANE_DESTRUCTIBLE].test(x, y) || m_planes[TILE_PLANE_BOMB].test(x, y); }
+
+	/**
+	 * @brief
+	 * Ticks until each cell is hit by an explosion, valid after updateFields.
+	 */
+	const DangerField& danger() const { return m_danger; }
+
+	/**
+	 * @brief
+	 * One of the distance fields, valid after updateFields.
+	 */
+	const DistanceField& distances(int field) const { return m_distances[field]; }
+
+	size_t distanceFieldCount() const { return m_distances.size(); }
+
+	bool isInside(int x, int y) const { return x >= 0 && y >= 0 && x < m_Tilewidth && y < m_Tileheight; }
+
+	const TileBatch& batch() const { return m_batch; }
+
+	/**
+	 * @brief
+	 * Locked whenever chunks are allocated, packed or freed.
+	 * 
+	 * The render thread holds it while it reads tiles, see TileBatch::update.
+	 */
+	sf::Mutex& chunkMutex() const { return m_chunkMutex; }
+
+	int width() const { return m_Tilewidth; }
+	int height() const { return m_Tileheight; }
+
+	/**
+	 * @brief
+	 * Heap memory used by the tiles, in bytes.
+	 */
+	size_t memoryUsage() const;
+
+	/**
+	 * @brief
+	 * Number of chunks that own their tiles (not empty nor packed).
+	 */
+	int allocatedChunkCount() const;
+
+	/**
+	 * @brief
+	 * Hash of the size and the tiles of the level (FNV-1a), the same for the
+	 * same tiles however they are stored. Identifies the level of a replay.
+	 */
+	unsigned int hash() const;
+
+	/**
+	 * @brief
+	 * Number of entries in the active tile list, including tiles deactivated since the last simulate().
+	 */
+	size_t activeTileCount() const { return m_active.size(); }
+
 	int m_Tilewidth, m_Tileheight;
 
 private:
-	Tile* levelData;
-	
-	// multidimensional array for level tiles (by boost)
-	typedef boost::multi_array<Tile*, 2> tile_array;
-	typedef tile_array::index index;
-	tile_array m_tileArray;
+	/**
+	 * @brief
+	 * All chunks, row by row.
+	 */
+	std::vector<LevelChunk> m_chunks;
+
+	/**
+	 * @brief
+	 * Level size in chunks.
+	 */
+	int m_chunksX, m_chunksY;
+
+	/**
+	 * @brief
+	 * See setPackDistance.
+	 */
+	int m_packDistance;
+
+	/**
+	 * @brief
+	 * Change number of the last edit of each chunk, from m_changeCount.
+	 */
+	std::vector<unsigned int> m_chunkChanges;
+	unsigned int m_changeCount;
+
+	/**
+	 * @brief
+	 * State of the last copyFrom: the source, the change numbers of its chunks
+	 * that were copied and m_changeCount after the copy.
+	 */
+	const Level *m_copySource;
+	std::vector<unsigned int> m_copiedChanges;
+	unsigned int m_copyChangeCount;
+
+	mutable sf::Mutex m_chunkMutex;
+
+	/**
+	 * @brief
+	 * Cell properties of the tiles, see TilePlane.
+	 */
+	BitPlane m_planes[TILE_PLANE_COUNT];
+
+	/**
+	 * @brief
+	 * Indices (y * width + x) of the tiles simulated every tick, in activation order.
+	 * 
+	 * Tiles with TILE_FLAG_QUEUED are in the list. Deactivated tiles are removed
+	 * lazily by simulate(), so neither activation nor deactivation searches the list.
+	 */
+	std::vector<int> m_active;
+
+	/**
+	 * @brief
+	 * Indices of the tiles whose type changed, in order, see captureTiles.
+	 * 
+	 * Change number m_tileLogBase + i is m_tileLog[i]. Restarting the log moves
+	 * the base past all changes, snapshots older than the base are copied whole.
+	 */
+	std::vector<int> m_tileLog;
+	unsigned int m_tileLogBase;
+	bool m_tileLogActive;
+
+	void restartTileLog()
+	{
+		m_tileLogBase += (unsigned int) m_tileLog.size() + 1;
+		m_tileLog.clear();
+	}
+
+	/**
+	 * @brief
+	 * A queued explosion of a bomb, see detonate.
+	 */
+	struct Explosion  {
+		int index;
+		int radius;
+	};
+
+	/**
+	 * @brief
+	 * Explosions waiting for resolveExplosions, in detonation order.
+	 */
+	std::vector<Explosion> m_explosions;
+
+	/**
+	 * @brief
+	 * See enableFields.
+	 */
+	bool m_fieldsEnabled;
+
+	DangerField m_danger;
+	std::vector<DistanceField> m_distances;
+
+	/**
+	 * @brief
+	 * Scratch space for the runs of a loaded chunk.
+	 */
+	std::vector<unsigned char> m_loadRuns;
+
+	/**
+	 * @brief
+	 * Scratch space for whole chunks, used when restoring state.
+	 */
+	Tile m_chunkTiles[LevelChunk::TileCount];
+
+	int chunkNumber(int x, int y) const { return (y / LevelChunk::Size) * m_chunksX + x / LevelChunk::Size; }
+	LevelChunk& chunk(int x, int y) { return m_chunks[chunkNumber(x, y)]; }
+	const LevelChunk& chunk(int x, int y) const { return m_chunks[chunkNumber(x, y)]; }
+	void chunkChanged(int chunk) { m_chunkChanges[chunk] = ++m_changeCount; }
+	static int chunkIndex(int x, int y) { return (y % LevelChunk::Size) * LevelChunk::Size + x % LevelChunk::Size; }
+
+	Tile& allocateTile(LevelChunk& c, int index);
+	void activateChunk(int chunk);
+	void setRunPlanes(int chunk, const unsigned char *packed, size_t size);
+	void updatePlanes(int x, int y, const Tile& t);
+	void blastArms(int x, int y, int radius, int& left, int& right, int& top, int& bottom) const;
+	void resolveExplosions();
+	void resizeFields();
+	void burn(int x, int y);
+	static unsigned int planesOf(const Tile& t) { return tileType(t.type).planes | ((t.flags & TILE_FLAG_SOLID) ? 1 << TILE_PLANE_SOLID : 0); }
+	void updateChanged(int chunkX, int chunkY, const Tile *saved);
+
+	/**
+	 * @brief
+	 * Vertex arrays of the tiles.
+	 */
+	TileBatch m_batch;
+
+	Level(const Level&);
+	Level& operator= (const Level&);
 };
 
-#endif
\ No newline at end of file
+#endif
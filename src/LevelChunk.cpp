@@ -0,0 +1,194 @@
+#include <cstring>
+#include "LevelChunk.h"
+
+/**
+ * @brief
+ * Tiles of all empty chunks. TILE_EMPTY has id 0 and no flags, so zero initialization is right.
+ */
+static Tile emptyTiles[LevelChunk::TileCount];
+
+LevelChunk::LevelChunk() : m_tiles(emptyTiles)
+{
+}
+
+LevelChunk::LevelChunk(const LevelChunk& other) : m_tiles(emptyTiles)
+{
+	*this = other;
+}
+
+LevelChunk& LevelChunk::operator= (const LevelChunk& other)
+{
+	if (this == &other)
+		return *this;
+
+	if (other.isAllocated())  {
+		assign(other.m_tiles);
+	} else  {
+		free();
+		m_tiles = other.m_tiles;
+		m_packed = other.m_packed;
+	}
+	return *this;
+}
+
+LevelChunk::~LevelChunk()
+{
+	free();
+}
+
+void LevelChunk::free()
+{
+	if (isAllocated())
+		delete[] m_tiles;
+	m_tiles = emptyTiles;
+	m_packed.clear();
+}
+
+bool LevelChunk::isEmpty() const
+{
+	return m_tiles == emptyTiles;
+}
+
+Tile& LevelChunk::edit(int index)
+{
+	allocate();
+	return m_tiles[index];
+}
+
+void LevelChunk::allocate()
+{
+	if (isAllocated())
+		return;
+
+	Tile *tiles = new Tile[TileCount];
+	read(tiles);
+	m_tiles = tiles;
+
+	// Keep the buffer of the runs, a rollback to the packed chunk reuses it, see Level::loadState
+	m_packed.clear();
+}
+
+void LevelChunk::read(Tile *tiles) const
+{
+	if (m_tiles != NULL)  {
+		memcpy(tiles, m_tiles, TileCount * sizeof(Tile));
+		return;
+	}
+
+	unpack(&m_packed[0], m_packed.size(), tiles);
+}
+
+void LevelChunk::assign(const Tile *tiles)
+{
+	if (!isAllocated())  {
+		m_packed.clear();
+		m_tiles = new Tile[TileCount];
+	}
+	memcpy(m_tiles, tiles, TileCount * sizeof(Tile));
+}
+
+void LevelChunk::assignPacked(const unsigned char *packed, size_t size)
+{
+	free();
+	if (size == 0)
+		return;
+
+	m_packed.assign(packed, packed + size);
+	m_tiles = NULL;
+}
+
+void LevelChunk::clear()
+{
+	free();
+}
+
+bool LevelChunk::release()
+{
+	if (!isAllocated())
+		return false;
+
+	for (int i = 0; i < TileCount; ++i)  {
+		if (m_tiles[i].type != TILE_EMPTY || m_tiles[i].flags != 0 || m_tiles[i].state != 0)
+			return false;
+	}
+
+	free();
+	return true;
+}
+
+void LevelChunk::pack()
+{
+	if (!isAllocated())
+		return;
+
+	pack(m_tiles, m_packed);
+	if (m_packed.size() >= TileCount * sizeof(Tile))  {
+		std::vector<unsigned char>().swap(m_packed);
+		return;
+	}
+
+	delete[] m_tiles;
+	m_tiles = NULL;
+}
+
+void LevelChunk::pack(const Tile *tiles, std::vector<unsigned char>& packed)
+{
+	packed.clear();
+	for (int i = 0; i < TileCount; )  {
+		const Tile& tile = tiles[i];
+		int count = 1;
+		while (i + count < TileCount && count < 255 && tiles[i + count].type == tile.type && tiles[i + count].flags == tile.flags && tiles[i + count].state == tile.state)
+			++count;
+
+		packed.push_back((unsigned char)count);
+		packed.push_back(tile.type);
+		packed.push_back(tile.flags);
+		packed.push_back(tile.state);
+		i += count;
+	}
+}
+
+/**
+ * @brief
+ * Decodes the tile of a run.
+ */
+static Tile runTile(const unsigned char *run)
+{
+	Tile tile;
+	tile.type = run[1];
+	tile.flags = run[2];
+	tile.state = run[3];
+	return tile;
+}
+
+Tile LevelChunk::unpackTile(const unsigned char *packed, size_t size, int index)
+{
+	for (size_t run = 0; run + RunSize <= size; run += RunSize)  {
+		if (index < packed[run])
+			return runTile(packed + run);
+		index -= packed[run];
+	}
+
+	return emptyTiles[0];
+}
+
+void LevelChunk::unpack(const unsigned char *packed, size_t size, Tile *tiles)
+{
+	int index = 0;
+	for (size_t run = 0; run + RunSize <= size; run += RunSize)  {
+		const Tile tile = runTile(packed + run);
+		for (int i = 0; i < packed[run] && index < TileCount; ++i)
+			tiles[index++] = tile;
+	}
+
+	// Malformed data, treat the rest as empty
+	for ( ; index < TileCount; ++index)
+		tiles[index] = emptyTiles[0];
+}
+
+size_t LevelChunk::memoryUsage() const
+{
+	if (isAllocated())
+		return TileCount * sizeof(Tile) + m_packed.capacity();
+	return m_packed.capacity();
+}
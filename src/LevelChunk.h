@@ -0,0 +1,184 @@
+#ifndef LEVELCHUNK_H
+#define LEVELCHUNK_H
+
+#include <vector>
+#include "Tile.h"
+
+/**
+ * @brief
+ * Square block of Size x Size level tiles.
+ * 
+ * A chunk is in one of three states:
+ * - empty: all tiles are TILE_EMPTY, the chunk points to a shared read-only
+ *   block of empty tiles and owns no memory,
+ * - allocated: the chunk owns its tiles,
+ * - packed: the tiles are run-length encoded, used for static chunks far
+ *   from all players.
+ * 
+ * Reading works in every state, changing a tile through edit() allocates the chunk.
+ * 
+ * @see
+ * Level
+ */
+class LevelChunk  {
+private:
+	/**
+	 * @brief
+	 * The tiles, the shared empty block when empty, NULL when packed.
+	 */
+	Tile *m_tiles;
+
+	/**
+	 * @brief
+	 * Runs of equal tiles when packed: count, type, flags, state.
+	 */
+	std::vector<unsigned char> m_packed;
+
+	void free();
+
+public:
+	LevelChunk();
+	LevelChunk(const LevelChunk& other);
+	LevelChunk& operator= (const LevelChunk& other);
+	~LevelChunk();
+
+	/**
+	 * @brief
+	 * Returns a tile of the chunk.
+	 * 
+	 * @param index
+	 * Index of the tile in the chunk, row by row.
+	 */
+	Tile tile(int index) const { return m_tiles != NULL ? m_tiles[index] : unpackTile(index); }
+
+	/**
+	 * @brief
+	 * Returns a tile for modification, allocates or unpacks the chunk first.
+	 */
+	Tile& edit(int index);
+
+	/**
+	 * @brief
+	 * Copies all tiles of the chunk.
+	 * 
+	 * @param tiles
+	 * Array of TileCount tiles (output).
+	 */
+	void read(Tile *tiles) const;
+
+	/**
+	 * @brief
+	 * Replaces all tiles of the chunk, allocates it if needed.
+	 * 
+	 * @param tiles
+	 * Array of TileCount tiles.
+	 */
+	void assign(const Tile *tiles);
+
+	/**
+	 * @brief
+	 * Replaces all tiles of the chunk by run-length encoded ones, the chunk becomes packed.
+	 * 
+	 * @param packed
+	 * Runs in the format of pack(), a size of 0 makes the chunk empty.
+	 */
+	void assignPacked(const unsigned char *packed, size_t size);
+
+	/**
+	 * @brief
+	 * Makes the chunk own its tiles, unpacking them if needed.
+	 */
+	void allocate();
+
+	/**
+	 * @brief
+	 * Makes the chunk empty, freeing its memory.
+	 */
+	void clear();
+
+	/**
+	 * @brief
+	 * Frees an allocated chunk that contains only empty tiles.
+	 * 
+	 * @returns
+	 * True if the chunk became empty.
+	 */
+	bool release();
+
+	/**
+	 * @brief
+	 * Run-length encodes an allocated chunk and frees its tiles.
+	 * 
+	 * Chunks whose runs would take more memory than the tiles stay allocated.
+	 */
+	void pack();
+
+	/**
+	 * @brief
+	 * Run-length encodes tiles as runs of RunSize bytes: count, type, flags and state.
+	 * 
+	 * @param tiles
+	 * Array of TileCount tiles.
+	 * 
+	 * @param packed
+	 * The runs (output), the previous content is replaced.
+	 */
+	static void pack(const Tile *tiles, std::vector<unsigned char>& packed);
+
+	/**
+	 * @brief
+	 * Unpacked tiles of an allocated chunk, NULL when the chunk is empty or packed.
+	 */
+	Tile *tiles() { return isAllocated() ? m_tiles : NULL; }
+	const Tile *tiles() const { return isAllocated() ? m_tiles : NULL; }
+
+	/**
+	 * @brief
+	 * Decodes one tile of run-length encoded data.
+	 */
+	static Tile unpackTile(const unsigned char *packed, size_t size, int index);
+
+	/**
+	 * @brief
+	 * Decodes run-length encoded data of a whole chunk.
+	 * 
+	 * @param tiles
+	 * Array of TileCount tiles (output).
+	 */
+	static void unpack(const unsigned char *packed, size_t size, Tile *tiles);
+
+	// Properties
+
+	bool isEmpty() const;
+	bool isPacked() const { return m_tiles == NULL; }
+	bool isAllocated() const { return m_tiles != NULL && !isEmpty(); }
+
+	const std::vector<unsigned char>& packed() const { return m_packed; }
+
+	/**
+	 * @brief
+	 * Heap memory owned by the chunk, in bytes.
+	 */
+	size_t memoryUsage() const;
+
+private:
+	Tile unpackTile(int index) const { return unpackTile(&m_packed[0], m_packed.size(), index); }
+
+public:
+	// Constants
+
+	/**
+	 * @brief
+	 * Side of a chunk in tiles.
+	 */
+	static const int Size = 32;
+	static const int TileCount = Size * Size;
+
+	/**
+	 * @brief
+	 * Bytes per run of packed tiles.
+	 */
+	static const int RunSize = 4;
+};
+
+#endif
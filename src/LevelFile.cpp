@@ -0,0 +1,248 @@
+#include <cstring>
+#include <fstream>
+#include <boost/cstdint.hpp>
+#include "LevelFile.h"
+#include "LevelChunk.h"
+
+static const char LevelMagic[4] = { 'U', 'H', 'K', 'L' };
+static const unsigned short LevelVersion = 2;
+
+/**
+ * @brief
+ * Largest accepted level side, keeps the size computations far from overflowing.
+ */
+static const unsigned int MaxLevelSide = 65536;
+
+static void writeU16(std::ostream& out, unsigned short value)
+{
+	const char bytes[2] = { (char)(value & 0xff), (char)(value >> 8) };
+	out.write(bytes, 2);
+}
+
+static void writeU32(std::ostream& out, unsigned int value)
+{
+	const char bytes[4] = { (char)(value & 0xff), (char)((value >> 8) & 0xff), (char)((value >> 16) & 0xff), (char)(value >> 24) };
+	out.write(bytes, 4);
+}
+
+static unsigned short readU16(const unsigned char *bytes)
+{
+	return (unsigned short)(bytes[0] | (bytes[1] << 8));
+}
+
+static unsigned int readU32(const unsigned char *bytes)
+{
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+static unsigned int chunkCountOf(unsigned int width, unsigned int height)
+{
+	return ((width + LevelChunk::Size - 1) / LevelChunk::Size) * ((height + LevelChunk::Size - 1) / LevelChunk::Size);
+}
+
+bool writeLevelFile(const std::string& fileName, const LevelDescription& level)
+{
+	if (level.width <= 0 || level.height <= 0 || (unsigned int)level.width > MaxLevelSide || (unsigned int)level.height > MaxLevelSide)
+		return false;
+	if (level.tiles.size() != (size_t)level.width * level.height)
+		return false;
+
+	// File type ids are assigned in order of first use, empty tiles always get 0 as they fill the chunk borders
+	unsigned char fileTypes[TILE_TYPE_COUNT];
+	memset(fileTypes, 0xff, sizeof(fileTypes));
+	std::vector<unsigned char> types;
+	fileTypes[TILE_EMPTY] = 0;
+	types.push_back(TILE_EMPTY);
+	for (size_t i = 0; i < level.tiles.size(); ++i)  {
+		const unsigned char type = level.tiles[i].type;
+		if (type >= TILE_TYPE_COUNT)
+			return false;
+		if (fileTypes[type] == 0xff)  {
+			fileTypes[type] = (unsigned char)types.size();
+			types.push_back(type);
+		}
+	}
+
+	std::string metadata;
+	for (auto it = level.metadata.begin(); it != level.metadata.end(); ++it)  {
+		if (it->first.empty() || it->first.find_first_of("=\n") != std::string::npos || it->second.find('\n') != std::string::npos)
+			return false;
+		metadata += it->first + "=" + it->second + "\n";
+	}
+
+	// Pack the chunks
+	const int chunksX = (level.width + LevelChunk::Size - 1) / LevelChunk::Size;
+	const int chunksY = (level.height + LevelChunk::Size - 1) / LevelChunk::Size;
+	std::vector<unsigned int> offsets, sizes;
+	std::vector<unsigned char> data, packed;
+	Tile tiles[LevelChunk::TileCount];
+	for (int cy = 0; cy < chunksY; ++cy)  {
+		for (int cx = 0; cx < chunksX; ++cx)  {
+			bool empty = true;
+			for (int j = 0; j < LevelChunk::Size; ++j)  {
+				for (int i = 0; i < LevelChunk::Size; ++i)  {
+					const int x = cx * LevelChunk::Size + i, y = cy * LevelChunk::Size + j;
+					Tile& tile = tiles[j * LevelChunk::Size + i];
+					tile.type = TILE_EMPTY;
+					tile.flags = TILE_FLAG_NONE;
+					tile.state = 0;
+					if (x < level.width && y < level.height)
+						tile = level.tiles[y * level.width + x];
+
+					empty = empty && tile.type == TILE_EMPTY && tile.flags == TILE_FLAG_NONE && tile.state == 0;
+					tile.type = fileTypes[tile.type];
+				}
+			}
+
+			offsets.push_back((unsigned int)data.size());
+			if (empty)  {
+				sizes.push_back(0);
+				continue;
+			}
+
+			LevelChunk::pack(tiles, packed);
+			sizes.push_back((unsigned int)packed.size());
+			data.insert(data.end(), packed.begin(), packed.end());
+		}
+	}
+
+	std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	file.write(LevelMagic, sizeof(LevelMagic));
+	writeU16(file, LevelVersion);
+	writeU16(file, 0);
+	writeU32(file, level.width);
+	writeU32(file, level.height);
+	writeU32(file, (unsigned int)types.size());
+	writeU32(file, (unsigned int)level.spawns.size());
+	writeU32(file, (unsigned int)metadata.size());
+
+	for (size_t i = 0; i < types.size(); ++i)  {
+		char name[LevelFileReader::TypeNameSize] = { 0 };
+		const char *typeName = tileType(types[i]).name;
+		if (strlen(typeName) >= sizeof(name))
+			return false;
+		memcpy(name, typeName, strlen(typeName));
+		file.write(name, sizeof(name));
+	}
+
+	for (size_t i = 0; i < level.spawns.size(); ++i)  {
+		writeU32(file, level.spawns[i].x);
+		writeU32(file, level.spawns[i].y);
+	}
+
+	file.write(metadata.data(), metadata.size());
+
+	for (size_t i = 0; i < offsets.size(); ++i)  {
+		writeU32(file, offsets[i]);
+		writeU32(file, sizes[i]);
+	}
+
+	if (!data.empty())
+		file.write((const char *)&data[0], data.size());
+
+	return file.good();
+}
+
+LevelFileReader::LevelFileReader() : m_width(0), m_height(0), m_typeCount(0), m_spawnCount(0), m_metadataSize(0),
+	m_types(NULL), m_spawns(NULL), m_metadata(NULL), m_chunkTable(NULL), m_chunkData(NULL), m_chunkDataSize(0)
+{
+}
+
+bool LevelFileReader::open(const std::string& fileName)
+{
+	if (!m_file.open(fileName))
+		return false;
+
+	const unsigned char *data = m_file.data();
+	const boost::uint64_t size = m_file.size();
+	if (size < HeaderSize || memcmp(data, LevelMagic, sizeof(LevelMagic)) != 0 || readU16(data + 4) != LevelVersion)  {
+		close();
+		return false;
+	}
+
+	m_width = readU32(data + 8);
+	m_height = readU32(data + 12);
+	m_typeCount = readU32(data + 16);
+	m_spawnCount = readU32(data + 20);
+	m_metadataSize = readU32(data + 24);
+	if (m_width == 0 || m_height == 0 || m_width > MaxLevelSide || m_height > MaxLevelSide || m_typeCount == 0 || m_typeCount > 256)  {
+		close();
+		return false;
+	}
+
+	// The sections follow each other, check that they all fit into the file
+	boost::uint64_t offset = HeaderSize;
+	const boost::uint64_t typesOffset = offset;
+	offset += (boost::uint64_t)m_typeCount * TypeNameSize;
+	const boost::uint64_t spawnsOffset = offset;
+	offset += (boost::uint64_t)m_spawnCount * 8;
+	const boost::uint64_t metadataOffset = offset;
+	offset += m_metadataSize;
+	const boost::uint64_t chunkTableOffset = offset;
+	offset += (boost::uint64_t)chunkCount() * 8;
+	if (offset > size)  {
+		close();
+		return false;
+	}
+
+	m_types = data + typesOffset;
+	m_spawns = data + spawnsOffset;
+	m_metadata = data + metadataOffset;
+	m_chunkTable = data + chunkTableOffset;
+	m_chunkData = data + offset;
+	m_chunkDataSize = (size_t)(size - offset);
+
+	for (unsigned int i = 0; i < chunkCount(); ++i)  {
+		const boost::uint64_t chunkOffset = readU32(m_chunkTable + i * 8), chunkSize = readU32(m_chunkTable + i * 8 + 4);
+		if (chunkOffset + chunkSize > m_chunkDataSize)  {
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::string LevelFileReader::typeName(unsigned int index) const
+{
+	const char *name = (const char *)m_types + index * TypeNameSize;
+	return std::string(name, strnlen(name, TypeNameSize));
+}
+
+LevelSpawn LevelFileReader::spawn(unsigned int index) const
+{
+	LevelSpawn spawn;
+	spawn.x = (int)readU32(m_spawns + index * 8);
+	spawn.y = (int)readU32(m_spawns + index * 8 + 4);
+	return spawn;
+}
+
+std::string LevelFileReader::metadata(const std::string& key) const
+{
+	const std::string lines((const char *)m_metadata, m_metadataSize);
+	size_t start = 0;
+	while (start < lines.size())  {
+		size_t end = lines.find('\n', start);
+		if (end == std::string::npos)
+			end = lines.size();
+
+		if (lines.compare(start, key.size(), key) == 0 && start + key.size() < end && lines[start + key.size()] == '=')
+			return lines.substr(start + key.size() + 1, end - start - key.size() - 1);
+		start = end + 1;
+	}
+	return std::string();
+}
+
+const unsigned char *LevelFileReader::chunk(unsigned int index, size_t& size) const
+{
+	size = readU32(m_chunkTable + index * 8 + 4);
+	return m_chunkData + readU32(m_chunkTable + index * 8);
+}
+
+unsigned int LevelFileReader::chunkCount() const
+{
+	return chunkCountOf(m_width, m_height);
+}
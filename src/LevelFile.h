@@ -0,0 +1,153 @@
+#ifndef LEVELFILE_H
+#define LEVELFILE_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "Tile.h"
+
+/**
+ * @brief
+ * Position of a player spawn, in tiles.
+ */
+struct LevelSpawn  {
+	int x, y;
+};
+
+/**
+ * @brief
+ * Complete contents of a level file, used to write one.
+ * 
+ * @see
+ * writeLevelFile | LevelFileReader
+ */
+struct LevelDescription  {
+	LevelDescription() : width(0), height(0) {}
+
+	int width, height;
+
+	/**
+	 * @brief
+	 * All tiles, row by row. The type ids are TileTypeId.
+	 */
+	std::vector<Tile> tiles;
+
+	std::vector<LevelSpawn> spawns;
+
+	/**
+	 * @brief
+	 * Free-form properties such as the level name or author.
+	 */
+	std::map<std::string, std::string> metadata;
+};
+
+/**
+ * @brief
+ * Writes a level in the binary level format.
+ * 
+ * @returns
+ * False if the file cannot be written or the description is invalid.
+ * 
+ * @see
+ * LevelFileReader
+ */
+bool writeLevelFile(const std::string& fileName, const LevelDescription& level);
+
+/**
+ * @brief
+ * Reads the binary level format through a memory mapping.
+ * 
+ * The file consists of the following parts, all numbers are little endian:
+ * 
+ *   header     "UHKL", u16 version, u16 reserved, u32 width, u32 height (in tiles),
+ *              u32 type count, u32 spawn count, u32 metadata size
+ *   types      type count zero padded names of TypeNameSize bytes, the tile
+ *              type ids in the file are indices into this table
+ *   spawns     spawn count times u32 x, u32 y (in tiles)
+ *   metadata   "key=value\n" lines
+ *   chunks     u32 offset, u32 size of every LevelChunk, row by row, followed by
+ *              the run-length encoded tiles of the chunks (see LevelChunk::pack).
+ *              Offsets are relative to the end of the chunk table, chunks of
+ *              size 0 contain only empty tiles.
+ * 
+ * Opening only validates the layout, the tiles are never parsed one by one.
+ * 
+ * @see
+ * Level::load | writeLevelFile
+ */
+class LevelFileReader  {
+private:
+	MappedFile m_file;
+
+	unsigned int m_width, m_height;
+	unsigned int m_typeCount, m_spawnCount, m_metadataSize;
+
+	const unsigned char *m_types;
+	const unsigned char *m_spawns;
+	const unsigned char *m_metadata;
+	const unsigned char *m_chunkTable;
+	const unsigned char *m_chunkData;
+	size_t m_chunkDataSize;
+
+public:
+	LevelFileReader();
+
+	/**
+	 * @brief
+	 * Maps a level file and checks its layout.
+	 * 
+	 * @returns
+	 * False if the file cannot be mapped, is not a level file or is truncated.
+	 */
+	bool open(const std::string& fileName);
+
+	void close() { m_file.close(); }
+
+	/**
+	 * @brief
+	 * Name of a tile type used by the file.
+	 * 
+	 * @param index
+	 * Tile type id in the file, less than typeCount().
+	 */
+	std::string typeName(unsigned int index) const;
+
+	LevelSpawn spawn(unsigned int index) const;
+
+	/**
+	 * @brief
+	 * Finds a metadata value.
+	 * 
+	 * @returns
+	 * The value, or an empty string if there is no such key.
+	 */
+	std::string metadata(const std::string& key) const;
+
+	/**
+	 * @brief
+	 * Returns the run-length encoded tiles of a chunk, see LevelChunk::unpack.
+	 * 
+	 * @param index
+	 * Chunk index, row by row.
+	 * 
+	 * @param size
+	 * Size of the data in bytes (output), 0 for an empty chunk.
+	 */
+	const unsigned char *chunk(unsigned int index, size_t& size) const;
+
+	// Properties
+
+	int width() const { return m_width; }
+	int height() const { return m_height; }
+	unsigned int typeCount() const { return m_typeCount; }
+	unsigned int spawnCount() const { return m_spawnCount; }
+	unsigned int chunkCount() const;
+
+	// Constants
+
+	static const unsigned int TypeNameSize = 16;
+	static const unsigned int HeaderSize = 28;
+};
+
+#endif
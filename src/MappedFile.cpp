@@ -0,0 +1,108 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+MappedFile::MappedFile() : m_data(NULL), m_size(0), m_file(INVALID_HANDLE_VALUE), m_mapping(NULL)
+{
+}
+
+bool MappedFile::open(const std::string& fileName)
+{
+	close();
+
+	m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0 || size.HighPart != 0)  {
+		close();
+		return false;
+	}
+
+	m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_mapping == NULL)  {
+		close();
+		return false;
+	}
+
+	m_data = (const unsigned char *)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (m_data == NULL)  {
+		close();
+		return false;
+	}
+
+	m_size = (size_t)size.QuadPart;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (m_data != NULL)
+		UnmapViewOfFile(m_data);
+	if (m_mapping != NULL)
+		CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+
+	m_data = NULL;
+	m_size = 0;
+	m_mapping = NULL;
+	m_file = INVALID_HANDLE_VALUE;
+}
+
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() : m_data(NULL), m_size(0), m_file(-1)
+{
+}
+
+bool MappedFile::open(const std::string& fileName)
+{
+	close();
+
+	m_file = ::open(fileName.c_str(), O_RDONLY);
+	if (m_file < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(m_file, &info) != 0 || info.st_size == 0)  {
+		close();
+		return false;
+	}
+
+	void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+	if (data == MAP_FAILED)  {
+		close();
+		return false;
+	}
+
+	m_data = (const unsigned char *)data;
+	m_size = (size_t)info.st_size;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (m_data != NULL)
+		munmap((void *)m_data, m_size);
+	if (m_file >= 0)
+		::close(m_file);
+
+	m_data = NULL;
+	m_size = 0;
+	m_file = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
@@ -0,0 +1,57 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+
+/**
+ * @brief
+ * A file mapped read-only into memory.
+ * 
+ * The pages are loaded by the operating system on first access, so opening
+ * even a large file is cheap and no copy of it is made.
+ */
+class MappedFile  {
+private:
+	const unsigned char *m_data;
+	size_t m_size;
+
+#ifdef _WIN32
+	void *m_file;
+	void *m_mapping;
+#else
+	int m_file;
+#endif
+
+	MappedFile(const MappedFile&);
+	MappedFile& operator= (const MappedFile&);
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	/**
+	 * @brief
+	 * Maps a file, closing the previously mapped one.
+	 * 
+	 * @param fileName
+	 * Path to the file.
+	 * 
+	 * @returns
+	 * False if the file cannot be opened or mapped. Empty files cannot be mapped.
+	 */
+	bool open(const std::string& fileName);
+
+	/**
+	 * @brief
+	 * Unmaps the file, pointers returned by data() become invalid.
+	 */
+	void close();
+
+	// Properties
+
+	const unsigned char *data() const { return m_data; }
+	size_t size() const { return m_size; }
+	bool isOpen() const { return m_data != NULL; }
+};
+
+#endif
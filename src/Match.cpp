@@ -0,0 +1,47 @@
+#include "Match.h"
+#include "BotController.h"
+#include "bots/SimpleBot.h"
+#include "events/PlayerActionEvent.h"
+#include "events/handlers/PlayerActionHandler.h"
+
+Match::Match(const Options& options, unsigned int tickLimit) : 
+	m_options(options), m_bots(NULL), m_tick(0), m_tickLimit(tickLimit), m_duration(0)
+{
+	m_loop.addHandler(new PlayerActionHandler(m_world));
+	m_world.initialize(false);
+
+	if (m_options.bots.count > 0)  {
+		m_bots = new BotController(1, m_options.bots.thinkBudget * 1e-6);
+		for (unsigned int i = 0; i < m_options.bots.count; ++i)
+			m_bots->addBot(new SimpleBot(), m_world.spawnPlayer());
+	}
+}
+
+Match::~Match()
+{
+	delete m_bots;
+}
+
+bool Match::step()
+{
+	if (isFinished())
+		return false;
+
+	const unsigned int tickRate = m_options.simulation.tickRate;
+	m_loop.setTick(m_world.tick());
+	m_loop.process();
+	m_world.simulate(1.0f / (tickRate > 0 ? tickRate : 1));
+	if (m_bots)
+		m_bots->think(m_world, m_loop);
+	++m_tick;
+
+	return !isFinished();
+}
+
+void Match::run()
+{
+	sf::Clock clock;
+	while (step())
+		;
+	m_duration = clock.GetElapsedTime();
+}
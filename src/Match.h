@@ -0,0 +1,101 @@
+#ifndef MATCH_H
+#define MATCH_H
+
+#include "Options.h"
+#include "EventLoop.h"
+#include "World.h"
+
+class BotController;
+
+/**
+ * @brief
+ * One independent game context - world, event loop and options.
+ * 
+ * A match does not touch the Game singleton, the window or any other global
+ * state, so many matches can be simulated in parallel, each on its own thread.
+ * The match runs headless with a fixed tick until the tick limit is reached.
+ * Its bots think on a single thread of their own, the cores are already
+ * shared by the matches.
+ * 
+ * @see
+ * MatchRunner
+ */
+class Match  {
+private:
+	Options m_options;
+	EventLoop m_loop;
+	World m_world;
+
+	/**
+	 * @brief
+	 * Runs the bots of the match (bots.count option), NULL without bots.
+	 */
+	BotController *m_bots;
+
+	/**
+	 * @brief
+	 * Number of ticks simulated so far.
+	 */
+	unsigned int m_tick;
+
+	/**
+	 * @brief
+	 * The match ends after this many ticks.
+	 */
+	unsigned int m_tickLimit;
+
+	/**
+	 * @brief
+	 * Wall clock time spent in run(), in seconds.
+	 */
+	float m_duration;
+
+	Match(const Match&);
+	Match& operator= (const Match&);
+
+public:
+	/**
+	 * @brief
+	 * Creates the match.
+	 * 
+	 * @param options
+	 * Options of the match, copied.
+	 * 
+	 * @param tickLimit
+	 * Length of the match in simulation ticks.
+	 */
+	Match(const Options& options, unsigned int tickLimit);
+
+	~Match();
+
+	/**
+	 * @brief
+	 * Simulates a single tick.
+	 * 
+	 * @returns
+	 * False when the match is over.
+	 */
+	bool step();
+
+	/**
+	 * @brief
+	 * Simulates the whole match as fast as possible.
+	 * 
+	 * @remarks
+	 * Called from a MatchRunner worker thread.
+	 */
+	void run();
+
+	// Properties
+
+	bool isFinished() const { return m_tick >= m_tickLimit; }
+	unsigned int tick() const { return m_tick; }
+	float duration() const { return m_duration; }
+
+	Options& options() { return m_options; }
+	EventLoop& loop() { return m_loop; }
+	World& world() { return m_world; }
+	BotController *bots() { return m_bots; }
+};
+
+#endif
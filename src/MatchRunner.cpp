@@ -0,0 +1,40 @@
+#include <boost/bind.hpp>
+#include "MatchRunner.h"
+#include "Match.h"
+
+MatchRunner::MatchRunner(unsigned int threads) : m_pool(threads), m_elapsed(0)
+{
+}
+
+MatchRunner::~MatchRunner()
+{
+	m_pool.wait();
+	for (auto it = m_matches.begin(); it != m_matches.end(); ++it)
+		delete (*it);
+}
+
+Match& MatchRunner::addMatch(const Options& options, unsigned int tickLimit)
+{
+	m_matches.push_back(new Match(options, tickLimit));
+	return *m_matches.back();
+}
+
+void MatchRunner::run()
+{
+	sf::Clock clock;
+	for (auto it = m_matches.begin(); it != m_matches.end(); ++it)  {
+		if (!(*it)->isFinished())
+			m_pool.submit(boost::bind(&Match::run, *it));
+	}
+
+	m_pool.wait();
+	m_elapsed = clock.GetElapsedTime();
+}
+
+float MatchRunner::matchesPerHour() const
+{
+	if (m_elapsed <= 0)
+		return 0;
+
+	return m_matches.size() * 3600.0f / m_elapsed;
+}
@@ -0,0 +1,89 @@
+#ifndef MATCHRUNNER_H
+#define MATCHRUNNER_H
+
+#include <vector>
+#include "ThreadPool.h"
+
+class Match;
+class Options;
+
+/**
+ * @brief
+ * Runs many independent matches in one process.
+ * 
+ * Every match is simulated to the end by a single worker of a thread pool
+ * sized to the core count. Matches share no state, so the throughput scales
+ * with the number of cores. Used for bot tournaments.
+ * 
+ * @see
+ * Match | ThreadPool
+ */
+class MatchRunner  {
+private:
+	ThreadPool m_pool;
+
+	/**
+	 * @brief
+	 * The hosted matches, owned by the runner.
+	 */
+	std::vector<Match *> m_matches;
+
+	/**
+	 * @brief
+	 * Wall clock time of the last run(), in seconds.
+	 */
+	float m_elapsed;
+
+	MatchRunner(const MatchRunner&);
+	MatchRunner& operator= (const MatchRunner&);
+
+public:
+	/**
+	 * @brief
+	 * Creates the runner.
+	 * 
+	 * @param threads
+	 * Number of worker threads, 0 means one per hardware thread.
+	 */
+	explicit MatchRunner(unsigned int threads = 0);
+
+	~MatchRunner();
+
+	/**
+	 * @brief
+	 * Adds a new match.
+	 * 
+	 * @param options
+	 * Options of the match, copied into the match.
+	 * 
+	 * @param tickLimit
+	 * Length of the match in simulation ticks.
+	 * 
+	 * @returns
+	 * The created match, owned by the runner.
+	 */
+	Match& addMatch(const Options& options, unsigned int tickLimit);
+
+	/**
+	 * @brief
+	 * Runs all matches that have not finished yet and waits for them.
+	 */
+	void run();
+
+	/**
+	 * @brief
+	 * Throughput of the last run().
+	 * 
+	 * @returns
+	 * Matches finished per hour of wall clock time.
+	 */
+	float matchesPerHour() const;
+
+	// Properties
+
+	size_t matchCount() const { return m_matches.size(); }
+	unsigned int threadCount() const { return m_pool.size(); }
+	float elapsed() const { return m_elapsed; }
+};
+
+#endif
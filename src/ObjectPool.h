@@ -0,0 +1,260 @@
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+
+#include <vector>
+#include "GameObject.h"
+
+/**
+ * @brief
+ * Reference to an object in an ObjectPool, valid while other objects are added and removed.
+ * 
+ * Slots of removed objects are reused, the generation tells their occupants
+ * apart, so the handle of a removed object never reaches the next one.
+ */
+struct ObjectHandle  {
+	static const unsigned int InvalidSlot = 0xFFFFFFFF;
+
+	ObjectHandle() : slot(InvalidSlot), generation(0) {}
+	ObjectHandle(unsigned int slot, unsigned int generation) : slot(slot), generation(generation) {}
+
+	unsigned int slot;
+	unsigned int generation;
+
+	/**
+	 * @brief
+	 * False for default constructed handles and the handles of failed additions.
+	 */
+	bool isValid() const { return slot != InvalidSlot; }
+
+	bool operator== (const ObjectHandle& other) const { return slot == other.slot && generation == other.generation; }
+	bool operator!= (const ObjectHandle& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief
+ * Type independent part of ObjectPool, World simulates and lists its pools through it.
+ */
+class ObjectPoolBase  {
+public:
+	virtual ~ObjectPoolBase() {}
+
+	/**
+	 * @brief
+	 * Simulates all objects of the pool, see World::simulateObjects.
+	 */
+	virtual void simulate(DeltaTime dt) = 0;
+
+	/**
+	 * @brief
+	 * Number of objects in the pool.
+	 */
+	virtual size_t size() const = 0;
+
+	/**
+	 * @brief
+	 * An object of the pool by index, see World::object.
+	 */
+	virtual GameObject& object(size_t index) = 0;
+	virtual const GameObject& object(size_t index) const = 0;
+
+	/**
+	 * @brief
+	 * Appends the addresses of all objects of the pool, in pool order, see World::collideObjects.
+	 */
+	virtual void listObjects(std::vector<GameObject *>& objects) = 0;
+
+protected:
+	ObjectPoolBase() {}
+
+private:
+	ObjectPoolBase(const ObjectPoolBase&);
+	ObjectPoolBase& operator= (const ObjectPoolBase&);
+};
+
+/**
+ * @brief
+ * Objects of one type stored by value in one dense array.
+ * 
+ * @param T
+ * The object type, derived from GameObject, copyable and assignable.
+ * 
+ * The objects lie next to each other in memory and are simulated in a loop
+ * calling T::simulate directly, so with thousands of small objects there is
+ * neither a virtual call nor a cache miss on a scattered heap block per object.
+ * 
+ * Removing an object moves the last one into its place, so the array stays
+ * dense. Indices and addresses of objects therefore change on removal, keep an
+ * ObjectHandle to find an object later. The capacity is fixed when the pool is
+ * created, additions never move the objects.
+ * 
+ * The pool stores whole objects, an array of structures: simulate and the
+ * collision pass read the hot fields (position and size) of an object
+ * together with the rest of it. No game type is pooled yet, players are heap
+ * objects and bombs and flames are level tiles.
+ * 
+ * @remarks
+ * Objects must not be added or removed during World::simulate, the simulation
+ * and the collision pass iterate the pool. Do it between ticks. Additions and
+ * removals cost the same for any number of objects, the world lists the
+ * objects of its pools once per tick for the collisions.
+ * 
+ * @see
+ * World::addPool
+ */
+template <typename T>
+class ObjectPool : public ObjectPoolBase  {
+private:
+	/**
+	 * @brief
+	 * Position of an object in m_objects and the generation of the slot.
+	 */
+	struct Slot  {
+		unsigned int index;
+		unsigned int generation;
+	};
+
+	size_t m_capacity;
+
+	/**
+	 * @brief
+	 * The objects, dense.
+	 */
+	std::vector<T> m_objects;
+
+	/**
+	 * @brief
+	 * Slot of each object, parallel to m_objects.
+	 */
+	std::vector<unsigned int> m_objectSlots;
+
+	std::vector<Slot> m_slots;
+
+	/**
+	 * @brief
+	 * Slots of removed objects, reused last freed first.
+	 */
+	std::vector<unsigned int> m_freeSlots;
+
+public:
+	/**
+	 * @brief
+	 * Creates an empty pool.
+	 * 
+	 * @param capacity
+	 * Maximum number of objects, allocated up front.
+	 */
+	ObjectPool(size_t capacity) : m_capacity(capacity)
+	{
+		m_objects.reserve(capacity);
+		m_objectSlots.reserve(capacity);
+		m_slots.reserve(capacity);
+		m_freeSlots.reserve(capacity);
+	}
+
+	/**
+	 * @brief
+	 * Copies an object into the pool.
+	 * 
+	 * @returns
+	 * Handle of the object, invalid if the pool is full.
+	 */
+	ObjectHandle add(const T& object)
+	{
+		if (m_objects.size() >= m_capacity)
+			return ObjectHandle();
+
+		unsigned int slot;
+		if (m_freeSlots.empty())  {
+			slot = (unsigned int)m_slots.size();
+			const Slot fresh = { 0, 0 };
+			m_slots.push_back(fresh);
+		} else {
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+
+		m_slots[slot].index = (unsigned int)m_objects.size();
+		m_objects.push_back(object);
+		m_objectSlots.push_back(slot);
+		return ObjectHandle(slot, m_slots[slot].generation);
+	}
+
+	/**
+	 * @brief
+	 * Removes an object, the last object of the pool takes its place.
+	 * 
+	 * @returns
+	 * False if the handle does not refer to an object of the pool (any more).
+	 * 
+	 * Safe while the render thread draws snapshots of the world, an
+	 * ObjectSnapshot keeps no pointer to the object it was taken from.
+	 */
+	bool remove(const ObjectHandle& handle)
+	{
+		if (!contains(handle))
+			return false;
+
+		const unsigned int index = m_slots[handle.slot].index, last = (unsigned int)m_objects.size() - 1;
+		if (index != last)  {
+			m_objects[index] = m_objects[last];
+			m_objectSlots[index] = m_objectSlots[last];
+			m_slots[m_objectSlots[index]].index = index;
+		}
+		m_objects.pop_back();
+		m_objectSlots.pop_back();
+
+		++m_slots[handle.slot].generation;
+		m_freeSlots.push_back(handle.slot);
+		return true;
+	}
+
+	/**
+	 * @brief
+	 * True if the handle refers to an object of the pool.
+	 */
+	bool contains(const ObjectHandle& handle) const
+	{
+		return handle.slot < m_slots.size() && m_slots[handle.slot].generation == handle.generation;
+	}
+
+	/**
+	 * @brief
+	 * The object of a handle, NULL if it was removed.
+	 */
+	T *get(const ObjectHandle& handle) { return contains(handle) ? &m_objects[m_slots[handle.slot].index] : NULL; }
+	const T *get(const ObjectHandle& handle) const { return contains(handle) ? &m_objects[m_slots[handle.slot].index] : NULL; }
+
+	/**
+	 * @brief
+	 * Handle of the object at an index of the pool.
+	 */
+	ObjectHandle handle(size_t index) const { return ObjectHandle(m_objectSlots[index], m_slots[m_objectSlots[index]].generation); }
+
+	void simulate(DeltaTime dt) override
+	{
+		// Qualified call, no virtual dispatch, T::simulate can be inlined
+		for (auto it = m_objects.begin(); it != m_objects.end(); ++it)  {
+			it->storePreviousState();
+			it->T::simulate(dt);
+		}
+	}
+
+	GameObject& object(size_t index) override { return m_objects[index]; }
+	const GameObject& object(size_t index) const override { return m_objects[index]; }
+
+	void listObjects(std::vector<GameObject *>& objects) override
+	{
+		for (auto it = m_objects.begin(); it != m_objects.end(); ++it)
+			objects.push_back(&*it);
+	}
+
+	// Properties
+
+	size_t size() const override { return m_objects.size(); }
+	size_t capacity() const { return m_capacity; }
+
+	T& operator[] (size_t index) { return m_objects[index]; }
+	const T& operator[] (size_t index) const { return m_objects[index]; }
+};
+
+#endif
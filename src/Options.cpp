@@ -32,6 +32,18 @@ public:
 	}
 };
 
+Options::Options(const Options& other)
+{
+	registerDefaults();
+
+	// Both instances have the same fields registered
+	for (auto it = m_fields.begin(); it != m_fields.end(); ++it)  {
+		auto src = other.m_fields.find(it->first);
+		if (src != other.m_fields.end())
+			it->second->fromString(src->second->toString());
+	}
+}
+
 bool Options::loadFromFile(const std::string& fileName)
 {
 	OptionsReader ini(fileName, *this);
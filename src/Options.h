@@ -2,6 +2,7 @@
 #define OPTIONS_H
 
 #include <map>
+#include <string>
 #include <boost/lexical_cast.hpp>
 
 /**
@@ -124,18 +125,42 @@ private:
 	 * should provide viable defaults for all values.
 	 */
 	Options()
+	{
+		registerDefaults();
+	}
+
+	/**
+	 * @brief
+	 * Registers all fields with their default values.
+	 * 
+	 * @see
+	 * Options::Options
+	 */
+	void registerDefaults()
 	{
 		regField(video.screenWidth, 640U);
 		regField(video.screenHeight, 480U);
 		regField(video.fullscreen, false);
 		regField(video.fpsLimit, 60U);
 
+		regField(simulation.tickRate, 60U);
+		regField(simulation.chunkPackDistance, 0U);
+		regField(simulation.collisionThreads, 1U);
+
+		regField(bots.count, 0U);
+		regField(bots.thinkBudget, 2000U);
+		regField(bots.threads, 0U);
+
+		regField(debug.profileFile, std::string());
+
 		regField(audio.musicOn, true);
 		regField(audio.soundsOn, true);
 	}
 
 #undef regField
 
+	Options& operator= (const Options&);
+
 	/**
 	 * @brief
 	 * Registers an options field so that it is available for loading/saving.
@@ -180,6 +205,17 @@ private:
 	bool loadFromFile(const std::string& fileName);
 
 public:
+	/**
+	 * @brief
+	 * Copies all option values from another instance.
+	 * 
+	 * @param other
+	 * The options to copy.
+	 * 
+	 * Used by MatchRunner, every match keeps its own copy of the options.
+	 */
+	Options(const Options& other);
+
 	/**
 	 * @brief
 	 * Saves options to the specified file.
@@ -204,11 +240,58 @@ public:
 	} video;
 
 
+	struct Simulation {
+		OptionsField<unsigned int> tickRate;
+
+		/**
+		 * @brief
+		 * Level chunks farther from all players than this many tiles are packed, 0 disables packing.
+		 */
+		OptionsField<unsigned int> chunkPackDistance;
+
+		/**
+		 * @brief
+		 * Threads finding the object collisions, 1 to find them on the simulation thread, 0 for one per core.
+		 */
+		OptionsField<unsigned int> collisionThreads;
+	} simulation;
+
+
+	struct Bots {
+		/**
+		 * @brief
+		 * Number of bot players added to the game.
+		 */
+		OptionsField<unsigned int> count;
+
+		/**
+		 * @brief
+		 * Time each bot may think per tick, in microseconds. A late bot keeps its previous action.
+		 */
+		OptionsField<unsigned int> thinkBudget;
+
+		/**
+		 * @brief
+		 * Worker threads running the bots, 0 for one per core.
+		 */
+		OptionsField<unsigned int> threads;
+	} bots;
+
+
 	struct Audio {
 		OptionsField<bool> musicOn;
 		OptionsField<bool> soundsOn;
 	} audio;
 
+
+	struct Debug {
+		/**
+		 * @brief
+		 * When set, the frame profile is written to this file on shutdown.
+		 */
+		OptionsField<std::string> profileFile;
+	} debug;
+
 public:
 	// Constants
 	static const char *optionsFileName;
@@ -1,4 +1,7 @@
+#include <cmath>
 #include "Player.h"
+#include "Level.h"
+#include "tiles/BombTile.h"
 
 /**
  * @brief
@@ -27,17 +30,128 @@ Player::Player(float x, float y, float width, float height, sf::Sprite* sprite)
 	m_playerSprite = NULL;
 	if(sprite != NULL) setSprite(sprite);
 	m_playerSpriteFrame = 0;
+	m_level = NULL;
+	m_bombPending = false;
 }
 
-void Player::render(sf::RenderTarget& target, DeltaTime dt)
+void Player::setAction(const PlayerAction& action)
 {
-	if(m_playerSprite != NULL) {
-		m_playerSprite->SetCenter( m_playerSpriteOrigCenter + sf::Vector2f(0, m_playerSpriteFrame * m_width));
-		target.Draw(*m_playerSprite);
-	}
+	m_action = action;
+	m_action.bomb = false;
+	if(action.bomb) m_bombPending = true;
+}
+
+void Player::drawSprite(sf::RenderTarget& target, sf::Sprite& sprite, const sf::Vector2f& center, float frameHeight, float x, float y, int frame)
+{
+	sprite.SetCenter(center + sf::Vector2f(0, frame * frameHeight));
+	sprite.SetPosition(x, y);
+	target.Draw(sprite);
+}
+
+void Player::draw(sf::RenderTarget& target, float x, float y, int frame)
+{
+	if(m_playerSprite != NULL)
+		drawSprite(target, *m_playerSprite, m_playerSpriteOrigCenter, m_width, x, y, frame);
+}
+
+void Player::render(sf::RenderTarget& target, DeltaTime dt, float alpha)
+{
+	draw(target, interpolatedX(alpha), interpolatedY(alpha), m_playerSpriteFrame);
+}
+
+void Player::captureSnapshot(ObjectSnapshot& snapshot) const
+{
+	CollidableObject<Player>::captureSnapshot(snapshot);
+	snapshot.frame = m_playerSpriteFrame;
+	snapshot.renderer = &Player::renderSnapshot;
+	snapshot.sprite = m_playerSprite;
+	snapshot.spriteCenter = m_playerSpriteOrigCenter;
+}
+
+void Player::renderSnapshot(sf::RenderTarget& target, const ObjectSnapshot& snapshot, float alpha)
+{
+	if(snapshot.sprite != NULL)
+		drawSprite(target, *snapshot.sprite, snapshot.spriteCenter, snapshot.width,
+			snapshot.prevX + (snapshot.x - snapshot.prevX) * alpha, snapshot.prevY + (snapshot.y - snapshot.prevY) * alpha, snapshot.frame);
+}
+
+void Player::saveState(StateBuffer& state) const
+{
+	CollidableObject<Player>::saveState(state);
+	state.write(m_playerDirection);
+	state.write(m_playerSpriteFrame);
+	state.write(m_action);
+	state.write(m_bombPending);
+}
+
+bool Player::loadState(StateBuffer& state)
+{
+	return CollidableObject<Player>::loadState(state) && state.read(m_playerDirection) && state.read(m_playerSpriteFrame)
+		&& state.read(m_action) && state.read(m_bombPending);
 }
 
 void Player::simulate(DeltaTime dt)
 {
+	if(m_level == NULL) return;
+
+	if(m_bombPending) {
+		m_bombPending = false;
+		const sf::Vector2f c = center();
+		const int x = (int)floor(c.x / LEVEL_TILE_WIDTH), y = (int)floor(c.y / LEVEL_TILE_HEIGHT);
+		if(m_level->isInside(x, y) && m_level->tile(x, y).type == TILE_EMPTY)
+			BombTile::place(*m_level, x, y, BombRadius);
+	}
+
+	// One axis at a time, horizontal wins
+	const float step = Speed * LEVEL_TILE_WIDTH * dt;
+	if(m_action.dx != 0) {
+		move(m_action.dx * step, 0);
+		m_playerDirection = sf::Vector2f(m_action.dx, 0);
+	} else if(m_action.dy != 0) {
+		move(0, m_action.dy * step);
+		m_playerDirection = sf::Vector2f(0, m_action.dy);
+	}
+}
+
+void Player::move(float dx, float dy)
+{
+	// Slide the other axis towards the nearest row or column first, so a player
+	// slightly off the grid still turns into a corridor
+	const float step = fabs(dx + dy);
+	float alignX = m_x, alignY = m_y;
+	if(dx != 0) alignY = floor(m_y / LEVEL_TILE_HEIGHT + 0.5f) * LEVEL_TILE_HEIGHT;
+	else alignX = floor(m_x / LEVEL_TILE_WIDTH + 0.5f) * LEVEL_TILE_WIDTH;
+
+	alignX = m_x + (alignX - m_x > step ? step : (alignX - m_x < -step ? -step : alignX - m_x));
+	alignY = m_y + (alignY - m_y > step ? step : (alignY - m_y < -step ? -step : alignY - m_y));
+	if((alignX != m_x || alignY != m_y) && canOccupy(alignX, alignY)) {
+		m_x = alignX;
+		m_y = alignY;
+	}
+
+	// Up to the first wall on the way, however long the step after a hitch
+	const sf::Vector2f to = m_level->slide(sf::FloatRect(m_x, m_y, m_x + m_width, m_y + m_height), dx, dy);
+	m_x = to.x;
+	m_y = to.y;
+}
 
+bool Player::canOccupy(float x, float y) const
+{
+	// Overlapped cells, the right and bottom edges are exclusive
+	const int left = (int)floor(x / LEVEL_TILE_WIDTH), right = (int)ceil((x + m_width) / LEVEL_TILE_WIDTH) - 1;
+	const int top = (int)floor(y / LEVEL_TILE_HEIGHT), bottom = (int)ceil((y + m_height) / LEVEL_TILE_HEIGHT) - 1;
+	const int curLeft = (int)floor(m_x / LEVEL_TILE_WIDTH), curRight = (int)ceil((m_x + m_width) / LEVEL_TILE_WIDTH) - 1;
+	const int curTop = (int)floor(m_y / LEVEL_TILE_HEIGHT), curBottom = (int)ceil((m_y + m_height) / LEVEL_TILE_HEIGHT) - 1;
+
+	for(int cy = top; cy <= bottom; ++cy) {
+		for(int cx = left; cx <= right; ++cx) {
+			if(!m_level->isInside(cx, cy))
+				return false;
+
+			const bool overlapped = cx >= curLeft && cx <= curRight && cy >= curTop && cy <= curBottom;
+			if(!overlapped && m_level->isSolid(cx, cy))
+				return false;
+		}
+	}
+	return true;
 }
\ No newline at end of file
@@ -2,8 +2,11 @@
 #define PLAYER_H
 
 #include "CollidableObject.h"
+#include "PlayerAction.h"
 #include <SFML/System/Vector2.hpp>
 
+class Level;
+
 class Player : public CollidableObject<Player> {
 public:
 	Player(float x, float y, float width, float height, sf::Sprite* sprite = NULL);
@@ -48,11 +51,109 @@ public:
 	 */
 	sf::Vector2f& getDirection() { return m_playerDirection; }
 
+	/**
+	 * @brief
+	 * Sets the level the player walks in and places bombs into, NULL to leave the player standing.
+	 */
+	void setLevel(Level* level) { m_level = level; }
+
+	/**
+	 * @brief
+	 * Sets what the player does from the next tick on.
+	 * 
+	 * @param action
+	 * The walking direction is kept until the next action, a bomb is placed only once.
+	 * 
+	 * @see
+	 * PlayerActionEvent
+	 */
+	void setAction(const PlayerAction& action);
+
+	/**
+	 * @brief
+	 * Returns the current action, the bomb flag is always cleared.
+	 */
+	const PlayerAction& action() const { return m_action; }
+
+	static const unsigned char CollisionType = COLLISION_TYPE_PLAYER;
+
+	/**
+	 * @brief
+	 * Walking speed in tiles per second.
+	 */
+	static const int Speed = 4;
+
+	/**
+	 * @brief
+	 * Blast radius of the bombs placed by players.
+	 */
+	static const int BombRadius = 2;
+
 	// from base class
-	void render(sf::RenderTarget& target, DeltaTime dt);
+	void render(sf::RenderTarget& target, DeltaTime dt, float alpha);
 	void simulate(DeltaTime dt);
+	void captureSnapshot(ObjectSnapshot& snapshot) const;
+	void saveState(StateBuffer& state) const;
+	bool loadState(StateBuffer& state);
+
+	/**
+	 * @brief
+	 * Draws a player from its snapshot, the SnapshotRenderer of players.
+	 * 
+	 * Uses only the snapshot, the player may be gone already.
+	 */
+	static void renderSnapshot(sf::RenderTarget& target, const ObjectSnapshot& snapshot, float alpha);
 
 private:
+	/**
+	 * @brief
+	 * Draws the player sprite.
+	 * 
+	 * @param target
+	 * The render target.
+	 * 
+	 * @param x
+	 * X-axis position in world space.
+	 * 
+	 * @param y
+	 * Y-axis position in world space.
+	 * 
+	 * @param frame
+	 * Sprite animation frame.
+	 */
+	void draw(sf::RenderTarget& target, float x, float y, int frame);
+
+	/**
+	 * @brief
+	 * Draws an animation frame of a player sprite, frames lie below each other in the image.
+	 */
+	static void drawSprite(sf::RenderTarget& target, sf::Sprite& sprite, const sf::Vector2f& center, float frameHeight, float x, float y, int frame);
+
+	/**
+	 * @brief
+	 * Moves along one axis, aligning the other axis to the tile grid so the player fits into corridors.
+	 * 
+	 * @param dx
+	 * Movement along the X-axis, in world space.
+	 * 
+	 * @param dy
+	 * Movement along the Y-axis, in world space. One of dx and dy must be 0.
+	 * 
+	 * The movement stops at the first solid tile on the way, see Level::slide.
+	 */
+	void move(float dx, float dy);
+
+	/**
+	 * @brief
+	 * True if the player can stand at the given position: no solid tile is
+	 * overlapped that the player did not overlap already, for example the bomb
+	 * it just placed.
+	 */
+	bool canOccupy(float x, float y) const;
+
+	Level* m_level;
+	PlayerAction m_action;
+	bool m_bombPending;
 	sf::Sprite* m_playerSprite;
 	sf::Vector2f m_playerDirection;
 	sf::Vector2f m_playerSpriteOrigCenter;
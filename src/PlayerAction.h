@@ -0,0 +1,33 @@
+#ifndef PLAYERACTION_H
+#define PLAYERACTION_H
+
+/**
+ * @brief
+ * What a player does from the next tick on, until a new action is set.
+ * 
+ * Set by the input or a bot through PlayerActionEvent, so the actions are recorded in replays.
+ * 
+ * @see
+ * Player::setAction
+ */
+struct PlayerAction  {
+	PlayerAction() : dx(0), dy(0), bomb(false) {}
+	PlayerAction(signed char dx, signed char dy, bool bomb) : dx(dx), dy(dy), bomb(bomb) {}
+
+	/**
+	 * @brief
+	 * Walking direction, -1, 0 or 1 on each axis.
+	 */
+	signed char dx, dy;
+
+	/**
+	 * @brief
+	 * Place a bomb on the cell under the player, once.
+	 */
+	bool bomb;
+
+	bool operator== (const PlayerAction& other) const { return dx == other.dx && dy == other.dy && bomb == other.bomb; }
+	bool operator!= (const PlayerAction& other) const { return !(*this == other); }
+};
+
+#endif
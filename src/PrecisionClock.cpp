@@ -0,0 +1,32 @@
+#include "PrecisionClock.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+boost::uint64_t PrecisionClock::now()
+{
+	static LARGE_INTEGER frequency = { 0 };
+	if (frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&frequency);
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+
+	// Split to avoid overflowing the multiplication
+	const boost::uint64_t seconds = counter.QuadPart / frequency.QuadPart;
+	const boost::uint64_t rest = counter.QuadPart % frequency.QuadPart;
+	return seconds * 1000000000ULL + rest * 1000000000ULL / frequency.QuadPart;
+}
+
+#else
+#include <time.h>
+
+boost::uint64_t PrecisionClock::now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (boost::uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef PRECISIONCLOCK_H
+#define PRECISIONCLOCK_H
+
+#include <boost/cstdint.hpp>
+
+/**
+ * @brief
+ * High-resolution monotonic clock.
+ * 
+ * Unlike sf::Clock, the time is kept in integer nanoseconds and returned as double,
+ * so the precision does not degrade as the clock runs, and the clock never jumps
+ * when the system time is changed.
+ * 
+ * @see
+ * FramePacer | Fps
+ */
+class PrecisionClock  {
+private:
+	boost::uint64_t m_start;
+
+public:
+	PrecisionClock() { reset(); }
+
+	/**
+	 * @brief
+	 * Restarts the clock from zero.
+	 */
+	void reset() { m_start = now(); }
+
+	/**
+	 * @brief
+	 * Time elapsed since construction or the last reset().
+	 * 
+	 * @returns
+	 * Elapsed time in seconds.
+	 */
+	double elapsed() const { return (now() - m_start) * 1e-9; }
+
+	/**
+	 * @brief
+	 * Current value of the system monotonic clock.
+	 * 
+	 * @returns
+	 * Nanoseconds since an unspecified point in the past.
+	 */
+	static boost::uint64_t now();
+};
+
+#endif
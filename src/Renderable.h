@@ -22,11 +22,18 @@ public:
 	 * @param dt
 	 * Delta time of last frame. (Will be used for BLUR post-process ;])
 	 * 
+	 * @param alpha
+	 * Interpolation factor in range <0, 1) between the previous and the current
+	 * simulation tick. 0 means the previous tick state, values close to 1 the current one.
+	 * 
 	 * Performs rendering of the object at the given surface.
 	 * The surface can be a window, buffer or anything that implements
 	 * sf::RenderTarget.
+	 * 
+	 * @see
+	 * Game::run
 	 */
-	virtual void render(sf::RenderTarget& target, DeltaTime dt) = 0;
+	virtual void render(sf::RenderTarget& target, DeltaTime dt, float alpha) = 0;
 };
 
 #endif
@@ -0,0 +1,181 @@
+#include <cstring>
+#include <map>
+#include <vector>
+#include "Replay.h"
+#include "events/CloseEvent.h"
+#include "events/KeyboardEvent.h"
+#include "events/MouseEvent.h"
+#include "events/PlayerActionEvent.h"
+
+static const char ReplayMagic[4] = { 'U', 'H', 'K', 'R' };
+static const unsigned short ReplayVersion = 2;
+
+static void writeU16(std::ostream& out, unsigned short value)
+{
+	const char bytes[2] = { (char)(value & 0xff), (char)(value >> 8) };
+	out.write(bytes, 2);
+}
+
+static void writeU32(std::ostream& out, unsigned int value)
+{
+	const char bytes[4] = { (char)(value & 0xff), (char)((value >> 8) & 0xff), (char)((value >> 16) & 0xff), (char)(value >> 24) };
+	out.write(bytes, 4);
+}
+
+static bool readU16(std::istream& in, unsigned short& value)
+{
+	unsigned char bytes[2];
+	if (!in.read((char *)bytes, 2))
+		return false;
+	value = (unsigned short)(bytes[0] | (bytes[1] << 8));
+	return true;
+}
+
+static bool readU32(std::istream& in, unsigned int& value)
+{
+	unsigned char bytes[4];
+	if (!in.read((char *)bytes, 4))
+		return false;
+	value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+	return true;
+}
+
+/**
+ * @brief
+ * Factory of the system events, which store the raw sf::Event.
+ */
+template <typename EventType>
+static EventPtr readSystemEvent(std::istream& in, unsigned short size)
+{
+	sf::Event ev;
+	if (size != sizeof(ev) || !in.read((char *)&ev, sizeof(ev)))
+		return EventPtr();
+	return EventPtr(new EventType(ev));
+}
+
+/**
+ * @brief
+ * Registered event factories, indexed by event type id.
+ */
+static std::map<unsigned short, ReplayReader::EventFactory>& eventFactories()
+{
+	static std::map<unsigned short, ReplayReader::EventFactory> factories;
+	if (factories.empty())  {
+		factories[EVENT_TYPE_CLOSE] = &readSystemEvent<CloseEvent>;
+		factories[EVENT_TYPE_MOUSE_DOWN] = &readSystemEvent<MouseDownEvent>;
+		factories[EVENT_TYPE_MOUSE_UP] = &readSystemEvent<MouseUpEvent>;
+		factories[EVENT_TYPE_MOUSE_WHEEL] = &readSystemEvent<MouseWheelEvent>;
+		factories[EVENT_TYPE_KEY_DOWN] = &readSystemEvent<KeyDownEvent>;
+		factories[EVENT_TYPE_KEY_UP] = &readSystemEvent<KeyUpEvent>;
+		factories[(unsigned short) PlayerActionEvent::TypeId] = &PlayerActionEvent::read;
+	}
+	return factories;
+}
+
+bool ReplayWriter::open(const std::string& fileName, const ReplaySettings& settings)
+{
+	m_file.open(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!m_file.is_open())
+		return false;
+
+	m_file.write(ReplayMagic, sizeof(ReplayMagic));
+	writeU16(m_file, ReplayVersion);
+	writeU16(m_file, 0);
+	writeU32(m_file, settings.tickRate);
+	writeU32(m_file, settings.levelHash);
+	writeU32(m_file, settings.players);
+	writeU32(m_file, settings.bots);
+	return m_file.good();
+}
+
+void ReplayWriter::write(unsigned int tick, const Event& ev)
+{
+	if (!m_file.is_open())
+		return;
+
+	m_payload.str(std::string());
+	m_payload.clear();
+	ev.write(m_payload);
+	const std::string payload = m_payload.str();
+
+	writeU32(m_file, tick);
+	writeU16(m_file, ev.typeId());
+	writeU16(m_file, (unsigned short)payload.size());
+	m_file.write(payload.data(), payload.size());
+}
+
+void ReplayWriter::close(unsigned int finalTick)
+{
+	if (!m_file.is_open())
+		return;
+
+	writeU32(m_file, finalTick);
+	writeU16(m_file, EVENT_TYPE_NONE);
+	writeU16(m_file, 0);
+	m_file.close();
+}
+
+ReplayReader::ReplayReader() : m_endTick(0), m_finished(true)
+{
+}
+
+bool ReplayReader::open(const std::string& fileName, const ReplaySettings& expected)
+{
+	m_file.open(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!m_file.is_open())
+		return false;
+
+	char magic[sizeof(ReplayMagic)];
+	unsigned short version = 0, reserved = 0;
+	if (!m_file.read(magic, sizeof(magic)) || memcmp(magic, ReplayMagic, sizeof(magic)) != 0)
+		return false;
+	if (!readU16(m_file, version) || version != ReplayVersion || !readU16(m_file, reserved))
+		return false;
+	m_settings = ReplaySettings();
+	ReplaySettings settings;
+	if (!readU32(m_file, settings.tickRate) || !readU32(m_file, settings.levelHash) || !readU32(m_file, settings.players) || !readU32(m_file, settings.bots))
+		return false;
+
+	// The events would drive a different game
+	m_settings = settings;
+	if (settings != expected)
+		return false;
+
+	m_finished = false;
+	m_endTick = 0;
+	return true;
+}
+
+bool ReplayReader::next(unsigned int& tick, EventPtr& ev)
+{
+	if (m_finished)
+		return false;
+
+	unsigned short typeId = 0, size = 0;
+	if (!readU32(m_file, tick) || !readU16(m_file, typeId) || !readU16(m_file, size))  {
+		// Truncated file, play what we have
+		m_finished = true;
+		return false;
+	}
+
+	if (typeId == EVENT_TYPE_NONE)  {
+		m_endTick = tick;
+		m_finished = true;
+		return false;
+	}
+
+	const std::map<unsigned short, EventFactory>& factories = eventFactories();
+	auto factory = factories.find(typeId);
+	const std::streampos payloadStart = m_file.tellg();
+	ev = (factory != factories.end()) ? factory->second(m_file, size) : EventPtr();
+
+	// Always continue behind the payload, whatever the factory read
+	m_file.clear();
+	m_file.seekg(payloadStart + (std::streamoff)size);
+	return true;
+}
+
+void ReplayReader::registerEventType(unsigned short typeId, EventFactory factory)
+{
+	eventFactories()[typeId] = factory;
+}
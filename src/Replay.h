@@ -0,0 +1,213 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "EventLoop.h"
+
+/**
+ * @brief
+ * The game a replay was recorded in.
+ * 
+ * A replay holds only the events, it reproduces the game only when played back
+ * into a world that starts the same way and is simulated with the same
+ * settings. Settings that do not change the result, such as the number of
+ * collision or bot threads, are not part of it.
+ */
+struct ReplaySettings  {
+	ReplaySettings() : tickRate(0), levelHash(0), players(0), bots(0) {}
+
+	/**
+	 * @brief
+	 * Tick rate of the simulation.
+	 */
+	unsigned int tickRate;
+
+	/**
+	 * @brief
+	 * Level::hash of the level when the recording started.
+	 */
+	unsigned int levelHash;
+
+	/**
+	 * @brief
+	 * Number of players when the recording started, including those of the bots.
+	 */
+	unsigned int players;
+
+	/**
+	 * @brief
+	 * Number of bot controlled players.
+	 */
+	unsigned int bots;
+
+	bool operator== (const ReplaySettings& other) const
+	{
+		return tickRate == other.tickRate && levelHash == other.levelHash && players == other.players && bots == other.bots;
+	}
+	bool operator!= (const ReplaySettings& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief
+ * Writes dispatched events into a binary replay file.
+ * 
+ * File format (all integers little endian):
+ *   header:  "UHKR", u16 version, u16 reserved, u32 tick rate, u32 level hash, u32 players, u32 bots
+ *   records: u32 tick, u16 event type id, u16 payload size, payload
+ *   end:     u32 final tick, u16 EVENT_TYPE_NONE, u16 0
+ * 
+ * Records are stored in dispatch order. The tick of a record is the number of
+ * ticks simulated before the event was dispatched.
+ * 
+ * @see
+ * ReplayReader | EventLoop::setRecorder
+ */
+class ReplayWriter  {
+private:
+	std::ofstream m_file;
+
+	/**
+	 * @brief
+	 * Reused buffer for the payload of the event being written.
+	 */
+	std::stringstream m_payload;
+
+	ReplayWriter(const ReplayWriter&);
+	ReplayWriter& operator= (const ReplayWriter&);
+
+public:
+	ReplayWriter() {}
+	~ReplayWriter() { close(0); }
+
+	/**
+	 * @brief
+	 * Creates the replay file and writes its header.
+	 * 
+	 * @param fileName
+	 * Path to the file, overwritten if it exists.
+	 * 
+	 * @param settings
+	 * The game being recorded, taken before its first tick.
+	 * 
+	 * @returns
+	 * True if the file was created.
+	 */
+	bool open(const std::string& fileName, const ReplaySettings& settings);
+
+	/**
+	 * @brief
+	 * Appends an event.
+	 * 
+	 * @param tick
+	 * Tick the event was dispatched in.
+	 * 
+	 * @param ev
+	 * The event, its typeId() must not be EVENT_TYPE_NONE.
+	 */
+	void write(unsigned int tick, const Event& ev);
+
+	/**
+	 * @brief
+	 * Writes the end record and closes the file.
+	 * 
+	 * @param finalTick
+	 * Number of ticks simulated when the recording stopped.
+	 */
+	void close(unsigned int finalTick);
+
+	bool isOpen() const { return m_file.is_open(); }
+};
+
+/**
+ * @brief
+ * Reads events from a replay file written by ReplayWriter.
+ * 
+ * @see
+ * ReplayWriter | Game::runReplay
+ */
+class ReplayReader  {
+public:
+	/**
+	 * @brief
+	 * Creates an event from its payload.
+	 * 
+	 * @param in
+	 * Stream positioned at the payload.
+	 * 
+	 * @param size
+	 * Payload size in bytes.
+	 */
+	typedef EventPtr (*EventFactory)(std::istream& in, unsigned short size);
+
+private:
+	std::ifstream m_file;
+	ReplaySettings m_settings;
+	unsigned int m_endTick;
+	bool m_finished;
+
+	ReplayReader(const ReplayReader&);
+	ReplayReader& operator= (const ReplayReader&);
+
+public:
+	ReplayReader();
+
+	/**
+	 * @brief
+	 * Opens a replay file and reads its header.
+	 * 
+	 * @param fileName
+	 * Path to the file.
+	 * 
+	 * @param expected
+	 * The game the replay is played back into, before its first tick.
+	 * 
+	 * @returns
+	 * False if the file cannot be opened, is not a replay or was recorded in a
+	 * different game. settings() tells the recorded game then, if the header could be read.
+	 */
+	bool open(const std::string& fileName, const ReplaySettings& expected);
+
+	/**
+	 * @brief
+	 * Reads the next event.
+	 * 
+	 * @param tick
+	 * Tick of the event (output).
+	 * 
+	 * @param ev
+	 * The event (output). Empty for event types without a registered factory.
+	 * 
+	 * @returns
+	 * False at the end of the replay.
+	 */
+	bool next(unsigned int& tick, EventPtr& ev);
+
+	/**
+	 * @brief
+	 * Registers a factory for a recordable event type.
+	 * 
+	 * @param typeId
+	 * Type id as returned by Event::typeId.
+	 * 
+	 * @param factory
+	 * Function creating the event from its payload.
+	 * 
+	 * System events are registered automatically.
+	 */
+	static void registerEventType(unsigned short typeId, EventFactory factory);
+
+	// Properties
+
+	const ReplaySettings& settings() const { return m_settings; }
+	unsigned int tickRate() const { return m_settings.tickRate; }
+
+	/**
+	 * @brief
+	 * Final tick of the recording, valid once next() returned false.
+	 */
+	unsigned int endTick() const { return m_endTick; }
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include <cmath>
+#include "SpatialHash.h"
+
+void SpatialHash::clear()
+{
+	m_objects.clear();
+	m_entries.clear();
+	m_sorted.clear();
+	m_bucketStart.clear();
+}
+
+void SpatialHash::insert(int id, const sf::FloatRect& rect)
+{
+	Object object;
+	object.id = id;
+	object.left = (int)floor(rect.Left / m_cellWidth);
+	object.top = (int)floor(rect.Top / m_cellHeight);
+	object.right = (int)ceil(rect.Right / m_cellWidth) - 1;
+	object.bottom = (int)ceil(rect.Bottom / m_cellHeight) - 1;
+
+	// Empty rectangles still occupy the cell they lie in
+	if (object.right < object.left)
+		object.right = object.left;
+	if (object.bottom < object.top)
+		object.bottom = object.top;
+
+	Entry entry;
+	entry.object = (int)m_objects.size();
+	for (entry.y = object.top; entry.y <= object.bottom; ++entry.y)  {
+		for (entry.x = object.left; entry.x <= object.right; ++entry.x)
+			m_entries.push_back(entry);
+	}
+	m_objects.push_back(object);
+}
+
+void SpatialHash::build()
+{
+	// Twice as many buckets as entries keeps unrelated cells apart
+	unsigned int bucketCount = 1;
+	while (bucketCount < m_entries.size() * 2)
+		bucketCount *= 2;
+
+	m_bucketStart.assign(bucketCount + 1, 0);
+	for (auto it = m_entries.begin(); it != m_entries.end(); ++it)  {
+		it->bucket = hashCell(it->x, it->y) & (bucketCount - 1);
+		++m_bucketStart[it->bucket + 1];
+	}
+	for (unsigned int b = 0; b < bucketCount; ++b)
+		m_bucketStart[b + 1] += m_bucketStart[b];
+
+	// Scatter, this advances each bucket start to the bucket end, shift them back afterwards
+	m_sorted.resize(m_entries.size());
+	for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+		m_sorted[m_bucketStart[it->bucket]++] = *it;
+
+	for (unsigned int b = bucketCount; b > 0; --b)
+		m_bucketStart[b] = m_bucketStart[b - 1];
+	m_bucketStart[0] = 0;
+}
+
+void SpatialHash::findPairs(std::vector<ObjectPair>& pairs, unsigned int firstBucket, unsigned int lastBucket) const
+{
+	pairs.clear();
+	for (unsigned int b = firstBucket; b < lastBucket; ++b)  {
+		const unsigned int end = m_bucketStart[b + 1];
+		for (unsigned int i = m_bucketStart[b]; i < end; ++i)  {
+			const Entry& e1 = m_sorted[i];
+			const Object& o1 = m_objects[e1.object];
+			for (unsigned int j = i + 1; j < end; ++j)  {
+				const Entry& e2 = m_sorted[j];
+
+				// Other cells hashed into the same bucket
+				if (e1.x != e2.x || e1.y != e2.y)
+					continue;
+
+				// Objects sharing several cells are reported in the top left one only
+				const Object& o2 = m_objects[e2.object];
+				const int x = o1.left > o2.left ? o1.left : o2.left, y = o1.top > o2.top ? o1.top : o2.top;
+				if (e1.x != x || e1.y != y)
+					continue;
+
+				pairs.push_back(o1.id < o2.id ? ObjectPair(o1.id, o2.id) : ObjectPair(o2.id, o1.id));
+			}
+		}
+	}
+}
+
+size_t SpatialHash::memoryUsage() const
+{
+	return m_objects.capacity() * sizeof(Object) + (m_entries.capacity() + m_sorted.capacity()) * sizeof(Entry)
+		+ m_bucketStart.capacity() * sizeof(unsigned int);
+}
@@ -0,0 +1,158 @@
+#ifndef SPATIALHASH_H
+#define SPATIALHASH_H
+
+#include <utility>
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+/**
+ * @brief
+ * Two objects whose rectangles share a cell, the lower id first.
+ */
+typedef std::pair<int, int> ObjectPair;
+
+/**
+ * @brief
+ * Broadphase of the object collisions: a hash of the cells covered by object rectangles.
+ * 
+ * The rectangles are inserted into every cell (of tile size in the world) they
+ * cover, the cells are hashed into buckets of a flat array. findPairs then only
+ * pairs objects sharing a cell, so the cost grows with the number of objects and
+ * not with its square, as long as they do not all crowd the same cells.
+ * 
+ * The hash is rebuilt from scratch each tick: clear, insert all objects, build.
+ * Rebuilding is a counting sort of the cell entries into the buckets, which is
+ * linear and, once the vectors have grown, does not allocate.
+ * 
+ * @see
+ * World::collideObjects
+ */
+class SpatialHash  {
+public:
+	/**
+	 * @brief
+	 * Creates an empty hash.
+	 * 
+	 * @param cellWidth
+	 * Width of a cell in world space.
+	 * 
+	 * @param cellHeight
+	 * Height of a cell in world space.
+	 */
+	SpatialHash(float cellWidth, float cellHeight) : m_cellWidth(cellWidth), m_cellHeight(cellHeight) {}
+
+	/**
+	 * @brief
+	 * Removes all objects, keeps the memory.
+	 */
+	void clear();
+
+	/**
+	 * @brief
+	 * Adds an object, call build after the last one.
+	 * 
+	 * @param id
+	 * Identifier reported by findPairs, for example the index of the object.
+	 * 
+	 * @param rect
+	 * Rectangle covered by the object in world space. The right and bottom edges are exclusive.
+	 */
+	void insert(int id, const sf::FloatRect& rect);
+
+	/**
+	 * @brief
+	 * Sorts the inserted objects into the buckets.
+	 */
+	void build();
+
+	/**
+	 * @brief
+	 * Finds all pairs of objects sharing at least one cell.
+	 * 
+	 * @param pairs
+	 * The pairs (output), cleared first. Every pair is reported once, even when
+	 * the objects share several cells. The order only depends on the inserted objects.
+	 */
+	void findPairs(std::vector<ObjectPair>& pairs) const { findPairs(pairs, 0, bucketCount()); }
+
+	/**
+	 * @brief
+	 * Finds the pairs of a range of buckets, so the search can be split between threads.
+	 * 
+	 * @param pairs
+	 * The pairs (output), cleared first.
+	 * 
+	 * @param firstBucket
+	 * First bucket to search.
+	 * 
+	 * @param lastBucket
+	 * One past the last bucket to search, at most bucketCount().
+	 * 
+	 * Every pair lies in exactly one bucket, ranges that together cover all
+	 * buckets find every pair once.
+	 */
+	void findPairs(std::vector<ObjectPair>& pairs, unsigned int firstBucket, unsigned int lastBucket) const;
+
+	// Properties
+
+	size_t objectCount() const { return m_objects.size(); }
+
+	/**
+	 * @brief
+	 * Number of buckets of the last build.
+	 */
+	unsigned int bucketCount() const { return m_bucketStart.empty() ? 0 : (unsigned int)m_bucketStart.size() - 1; }
+
+	/**
+	 * @brief
+	 * Number of (object, cell) entries, at least objectCount.
+	 */
+	size_t entryCount() const { return m_entries.size(); }
+
+	/**
+	 * @brief
+	 * Heap memory used by the hash, in bytes.
+	 */
+	size_t memoryUsage() const;
+
+private:
+	/**
+	 * @brief
+	 * Cells covered by an object, inclusive.
+	 */
+	struct Object  {
+		int id;
+		int left, top, right, bottom;
+	};
+
+	/**
+	 * @brief
+	 * One cell covered by an object.
+	 */
+	struct Entry  {
+		int x, y;
+		int object;     // index into m_objects
+		unsigned int bucket;
+	};
+
+	float m_cellWidth, m_cellHeight;
+
+	std::vector<Object> m_objects;
+
+	/**
+	 * @brief
+	 * Entries in insertion order.
+	 */
+	std::vector<Entry> m_entries;
+
+	/**
+	 * @brief
+	 * Entries sorted by bucket, bucket b spans [m_bucketStart[b], m_bucketStart[b + 1]).
+	 */
+	std::vector<Entry> m_sorted;
+	std::vector<unsigned int> m_bucketStart;
+
+	static unsigned int hashCell(int x, int y) { return ((unsigned int) x * 73856093u) ^ ((unsigned int) y * 19349663u); }
+};
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef STATEBUFFER_H
+#define STATEBUFFER_H
+
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief
+ * Flat byte buffer holding a saved simulation state.
+ * 
+ * Objects append their state with write() and read it back in the same order
+ * with read(). The memory is kept between saves, so once the buffer has grown to
+ * the size of the state, saving and restoring does not allocate.
+ * 
+ * @remarks
+ * Only plain values (numbers, PODs) may be written. The contents are only valid
+ * for the same build and the same set of objects, they are not a file format.
+ * 
+ * @see
+ * World::saveState | World::loadState
+ */
+class StateBuffer  {
+private:
+	std::vector<char> m_data;
+
+	/**
+	 * @brief
+	 * Number of bytes written.
+	 */
+	size_t m_size;
+
+	/**
+	 * @brief
+	 * Position of the next read.
+	 */
+	size_t m_readPos;
+
+public:
+	StateBuffer() : m_size(0), m_readPos(0) {}
+
+	/**
+	 * @brief
+	 * Empties the buffer for a new save, keeps the memory.
+	 */
+	void clear() { m_size = 0; m_readPos = 0; }
+
+	/**
+	 * @brief
+	 * Rewinds reading to the beginning of the saved state.
+	 */
+	void rewind() { m_readPos = 0; }
+
+	/**
+	 * @brief
+	 * Appends raw bytes.
+	 */
+	void write(const void *data, size_t size)
+	{
+		if (m_size + size > m_data.size())
+			m_data.resize((m_size + size) * 2);
+		memcpy(&m_data[m_size], data, size);
+		m_size += size;
+	}
+
+	template <typename T>
+	void write(const T& value) { write(&value, sizeof(T)); }
+
+	/**
+	 * @brief
+	 * Reads raw bytes.
+	 * 
+	 * @returns
+	 * False if there are not enough bytes left, nothing is read then.
+	 */
+	bool read(void *data, size_t size)
+	{
+		if (m_readPos + size > m_size)
+			return false;
+		memcpy(data, &m_data[m_readPos], size);
+		m_readPos += size;
+		return true;
+	}
+
+	template <typename T>
+	bool read(T& value) { return read(&value, sizeof(T)); }
+
+	/**
+	 * @brief
+	 * Skips bytes and returns a pointer to them, for comparing saved data in place.
+	 * 
+	 * @returns
+	 * Pointer to the skipped bytes, valid until the next write, or NULL if there
+	 * are not enough bytes left.
+	 */
+	const void *skip(size_t size)
+	{
+		if (m_readPos + size > m_size)
+			return NULL;
+		const void *data = &m_data[m_readPos];
+		m_readPos += size;
+		return data;
+	}
+
+	// Properties
+
+	size_t size() const { return m_size; }
+	size_t capacity() const { return m_data.size(); }
+	const char *data() const { return m_size > 0 ? &m_data[0] : NULL; }
+};
+
+#endif
@@ -1,12 +1,11 @@
 #include "Game.h"
 #include "System.h"
 
-bool System::initialize()
+bool System::initialize(const Options::Video& options)
 {
 	if (m_initialized)
 		return true;
 
-	const Options::Video& options = Game::get().options().video;
 	sf::VideoMode mode(options.screenWidth, options.screenHeight, BitsPerPixel);
 
 	m_appWindow.Create(mode, Game::name);
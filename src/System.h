@@ -3,6 +3,7 @@
 
 #include <SFML/Audio.hpp>
 #include <SFML/Graphics.hpp>
+#include "Options.h"
 
 /**
  * @brief
@@ -45,6 +46,9 @@ private:
 	 * @brief
 	 * Initialize the system.
 	 * 
+	 * @param options
+	 * Video options to create the window with.
+	 * 
 	 * @returns
 	 * True if everything goes OK, false otherwise.
 	 * 
@@ -57,7 +61,7 @@ private:
 	 * @see
 	 * Game::initialize
 	 */
-	bool initialize();
+	bool initialize(const Options::Video& options);
 
 
 	/**
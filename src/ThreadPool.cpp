@@ -0,0 +1,65 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threads) : m_busy(0), m_stopping(false)
+{
+	if (threads == 0)
+		threads = boost::thread::hardware_concurrency();
+	if (threads == 0)
+		threads = 1;
+
+	m_size = threads;
+	for (unsigned int i = 0; i < m_size; ++i)
+		m_threads.create_thread(boost::bind(&ThreadPool::workerLoop, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+	wait();
+
+	{
+		boost::lock_guard<boost::mutex> l(m_mutex);
+		m_stopping = true;
+	}
+	m_jobQueued.notify_all();
+	m_threads.join_all();
+}
+
+void ThreadPool::submit(const Job& job)
+{
+	{
+		boost::lock_guard<boost::mutex> l(m_mutex);
+		m_jobs.push_back(job);
+	}
+	m_jobQueued.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	boost::unique_lock<boost::mutex> l(m_mutex);
+	while (!m_jobs.empty() || m_busy > 0)
+		m_allDone.wait(l);
+}
+
+void ThreadPool::workerLoop()
+{
+	boost::unique_lock<boost::mutex> l(m_mutex);
+	while (true)  {
+		while (m_jobs.empty() && !m_stopping)
+			m_jobQueued.wait(l);
+
+		if (m_jobs.empty())
+			return;
+
+		Job job = m_jobs.front();
+		m_jobs.pop_front();
+		++m_busy;
+
+		l.unlock();
+		job();
+		l.lock();
+
+		--m_busy;
+		if (m_busy == 0 && m_jobs.empty())
+			m_allDone.notify_all();
+	}
+}
@@ -0,0 +1,104 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <deque>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+/**
+ * @brief
+ * A fixed set of worker threads processing a queue of jobs.
+ * 
+ * Jobs are executed in the order they were submitted, each by the first
+ * worker that becomes free. The workers are started in the constructor and
+ * joined in the destructor.
+ * 
+ * @remarks
+ * SFML has no condition variables, so the pool is built on boost::thread.
+ * 
+ * @see
+ * MatchRunner
+ */
+class ThreadPool  {
+public:
+	typedef boost::function<void ()> Job;
+
+private:
+	boost::thread_group m_threads;
+
+	mutable boost::mutex m_mutex;
+
+	/**
+	 * @brief
+	 * Signalled when a job is queued or the pool is stopping.
+	 */
+	boost::condition_variable m_jobQueued;
+
+	/**
+	 * @brief
+	 * Signalled when the last running job finishes and the queue is empty.
+	 */
+	boost::condition_variable m_allDone;
+
+	std::deque<Job> m_jobs;
+
+	/**
+	 * @brief
+	 * Number of jobs currently being executed.
+	 */
+	unsigned int m_busy;
+
+	bool m_stopping;
+
+	unsigned int m_size;
+
+private:
+	/**
+	 * @brief
+	 * Body of every worker thread.
+	 */
+	void workerLoop();
+
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator= (const ThreadPool&);
+
+public:
+	/**
+	 * @brief
+	 * Starts the workers.
+	 * 
+	 * @param threads
+	 * Number of worker threads, 0 means one per hardware thread.
+	 */
+	explicit ThreadPool(unsigned int threads = 0);
+
+	/**
+	 * @brief
+	 * Finishes all queued jobs and joins the workers.
+	 */
+	~ThreadPool();
+
+	/**
+	 * @brief
+	 * Queues a job for execution.
+	 * 
+	 * @param job
+	 * The job to execute. Must not throw.
+	 * 
+	 * @remarks
+	 * Threadsafe, jobs may submit further jobs.
+	 */
+	void submit(const Job& job);
+
+	/**
+	 * @brief
+	 * Blocks until the queue is empty and no job is running.
+	 */
+	void wait();
+
+	// Properties
+
+	unsigned int size() const { return m_size; }
+};
+
+#endif
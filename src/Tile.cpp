@@ -1,12 +1,24 @@
+#include <cstring>
 #include "Tile.h"
-#include "Level.h"
+#include "tiles/EmptyTile.h"
+#include "tiles/FlameTile.h"
+#include "tiles/WallTile.h"
+#include "tiles/BrickTile.h"
+#include "tiles/BombTile.h"
 
-Tile::Tile(float x, float y, sf::Sprite &sprite) : CollidableObject<Tile>(x, y, sprite.GetSize().x, sprite.GetSize().y) 
-{
-	sprite.SetPosition(x * LEVEL_TILE_WIDTH, y * LEVEL_TILE_HEIGHT);
-}
+const TileType *const tileTypeTable[TILE_TYPE_COUNT] = {
+	&EmptyTile::type,
+	&FlameTile::type,
+	&WallTile::type,
+	&BrickTile::type,
+	&BombTile::type
+};
 
-void Tile::render(sf::RenderTarget& target, DeltaTime dt) 
+unsigned char findTileType(const char *name)
 {
-	target.Draw(sprite);
-}
\ No newline at end of file
+	for (unsigned char type = 0; type < TILE_TYPE_COUNT; ++type)  {
+		if (strcmp(tileTypeTable[type]->name, name) == 0)
+			return type;
+	}
+	return TILE_TYPE_COUNT;
+}
@@ -1,28 +1,206 @@
 #ifndef TILE_H
 #define TILE_H
 
-#include <SFML/Graphics/Sprite.hpp>
-#include "CollidableObject.h"
+#include <SFML/Graphics.hpp>
+#include "FPS.h"
+
+class Level;
+
+/**
+ * @brief
+ * Identifiers of the tile types, index into the tile type table.
+ * 
+ * @see
+ * tileType
+ */
+enum TileTypeId  {
+	TILE_EMPTY = 0,
+	TILE_FLAME,
+	TILE_WALL,
+	TILE_BRICK,
+	TILE_BOMB,
+	TILE_TYPE_COUNT
+};
 
 /**
  * @brief
- * Tile is standard GameObject with Sprite instance (some image)
+ * Draw layers of the tiles, drawn in this order.
  * 
- * Tile contains information about image which should be draw on some surface.
+ * @see
+ * TileBatch
+ */
+enum TileLayer  {
+	TILE_LAYER_FLOOR = 0,
+	TILE_LAYER_BLOCKS,
+	TILE_LAYER_EFFECTS,
+	TILE_LAYER_COUNT
+};
+
+/**
+ * @brief
+ * Per-cell tile flags.
+ */
+enum TileFlags  {
+	TILE_FLAG_NONE = 0,
+	TILE_FLAG_SOLID = 1,     // players cannot walk through
+	TILE_FLAG_ACTIVE = 2,    // simulated every tick, see Level::activateTile
+	TILE_FLAG_QUEUED = 4,    // in the active tile list of Level, managed by Level only
+	TILE_FLAG_PARAM = 0xF0   // type specific parameter, for example the blast radius of a bomb
+};
+
+/**
+ * @brief
+ * Bit-planes of the level, one per cell property.
  * 
  * @see
- * CollidableObject
- */
-class Tile : public CollidableObject<Tile> {
-public:
-	Tile(float x, float y, sf::Sprite &sprite);
-	
-	virtual void render(sf::RenderTarget& target, DeltaTime dt);
-	
-	sf::Sprite& getSprite();
-
-private:
-	sf::Sprite sprite;
+ * Level::plane | BitPlane
+ */
+enum TilePlane  {
+	TILE_PLANE_SOLID = 0,        // tiles with TILE_FLAG_SOLID
+	TILE_PLANE_DESTRUCTIBLE,     // walls destroyed by explosions
+	TILE_PLANE_BOMB,
+	TILE_PLANE_FLAME,
+	TILE_PLANE_POWERUP,
+	TILE_PLANE_COUNT
 };
 
-#endif
\ No newline at end of file
+/**
+ * @brief
+ * A single cell of the level grid.
+ * 
+ * Tiles are plain values stored contiguously in Level, their behaviour is
+ * given by the TileType their type id refers to.
+ * 
+ * @see
+ * TileType | Level
+ */
+struct Tile  {
+	/**
+	 * @brief
+	 * One of TileTypeId.
+	 */
+	unsigned char type;
+
+	/**
+	 * @brief
+	 * Combination of TileFlags.
+	 */
+	unsigned char flags;
+
+	/**
+	 * @brief
+	 * Type specific state, for example the number of ticks a flame has burned.
+	 * 
+	 * Reset to 0 when a tile is placed.
+	 */
+	unsigned char state;
+};
+
+/**
+ * @brief
+ * Behaviour shared by all tiles of one type.
+ * 
+ * Instead of a virtual call per tile, Level looks the type up in the table
+ * returned by tileType. Tile types without behaviour leave the function
+ * pointers NULL and cost nothing when the level is simulated.
+ */
+struct TileType  {
+	/**
+	 * @brief
+	 * Name of the type, used in level files and debug output.
+	 */
+	const char *name;
+
+	/**
+	 * @brief
+	 * One of TileLayer.
+	 */
+	unsigned char layer;
+
+	/**
+	 * @brief
+	 * Flags of a newly placed tile of this type.
+	 */
+	unsigned char defaultFlags;
+
+	/**
+	 * @brief
+	 * Bit mask (1 << TilePlane) of the planes tiles of this type are in.
+	 * 
+	 * TILE_PLANE_SOLID follows TILE_FLAG_SOLID of each tile instead.
+	 */
+	unsigned char planes;
+
+	/**
+	 * @brief
+	 * Simulates one tile, NULL for static tiles.
+	 * 
+	 * Only active tiles are simulated. Tiles of types with this function are
+	 * activated when placed, see Level::activateTile.
+	 * 
+	 * @param level
+	 * The level the tile is in.
+	 * 
+	 * @param x
+	 * Column of the tile.
+	 * 
+	 * @param y
+	 * Row of the tile.
+	 * 
+	 * @param dt
+	 * Delta time since last simulation.
+	 */
+	void (*simulate)(Level& level, int x, int y, DeltaTime dt);
+
+	/**
+	 * @brief
+	 * Paints the graphics of the type into the tile atlas, NULL for invisible tiles.
+	 * 
+	 * @param image
+	 * The atlas image.
+	 * 
+	 * @param left
+	 * X-axis position of the cell in the atlas, in pixels.
+	 * 
+	 * @param top
+	 * Y-axis position of the cell in the atlas, in pixels.
+	 * 
+	 * @param tile
+	 * A tile of the type with its default flags.
+	 * 
+	 * Called once, when the atlas is created.
+	 * 
+	 * @see
+	 * TileAtlas
+	 */
+	void (*paint)(sf::Image& image, unsigned int left, unsigned int top, const Tile& tile);
+};
+
+/**
+ * @brief
+ * The tile type table, indexed by TileTypeId. Use tileType to access it.
+ */
+extern const TileType *const tileTypeTable[TILE_TYPE_COUNT];
+
+/**
+ * @brief
+ * Returns the type of tiles with the given type id.
+ * 
+ * @param type
+ * Type id of the tile, unknown ids map to TILE_EMPTY.
+ */
+inline const TileType& tileType(unsigned char type)
+{
+	return *tileTypeTable[type < TILE_TYPE_COUNT ? type : (unsigned char)TILE_EMPTY];
+}
+
+/**
+ * @brief
+ * Finds a tile type by its name.
+ * 
+ * @returns
+ * The type id, TILE_TYPE_COUNT if there is no type of that name.
+ */
+unsigned char findTileType(const char *name);
+
+#endif
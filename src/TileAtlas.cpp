@@ -0,0 +1,62 @@
+#include "TileAtlas.h"
+#include "Level.h"
+
+/**
+ * @brief
+ * Smallest power of two not less than value.
+ */
+static unsigned int nextPowerOfTwo(unsigned int value)
+{
+	unsigned int result = 1;
+	while (result < value)
+		result *= 2;
+	return result;
+}
+
+TileAtlas::TileAtlas() : m_painted(false)
+{
+	// Keep the atlas roughly square
+	m_columns = 1;
+	while (m_columns * m_columns < TILE_TYPE_COUNT)
+		++m_columns;
+
+	const unsigned int rows = (TILE_TYPE_COUNT + m_columns - 1) / m_columns;
+
+	// Power of two sizes, so SFML does not pad the texture and the coordinates stay exact
+	m_width = nextPowerOfTwo(m_columns * LEVEL_TILE_WIDTH);
+	m_height = nextPowerOfTwo(rows * LEVEL_TILE_HEIGHT);
+}
+
+sf::FloatRect TileAtlas::texCoords(unsigned char type) const
+{
+	if (type >= TILE_TYPE_COUNT)
+		type = TILE_EMPTY;
+
+	const unsigned int left = (type % m_columns) * LEVEL_TILE_WIDTH;
+	const unsigned int top = (type / m_columns) * LEVEL_TILE_HEIGHT;
+	return sf::FloatRect((float)left / m_width, (float)top / m_height,
+		(float)(left + LEVEL_TILE_WIDTH) / m_width, (float)(top + LEVEL_TILE_HEIGHT) / m_height);
+}
+
+const sf::Image& TileAtlas::image()
+{
+	if (m_painted)
+		return m_image;
+
+	m_image.Create(m_width, m_height, sf::Color(0, 0, 0, 0));
+	m_image.SetSmooth(false);
+
+	Tile tile;
+	for (unsigned int type = 0; type < TILE_TYPE_COUNT; ++type)  {
+		tile.type = (unsigned char)type;
+		tile.flags = tileType(tile.type).defaultFlags;
+		tile.state = 0;
+
+		const TileType& tt = tileType(tile.type);
+		if (tt.paint != NULL)
+			tt.paint(m_image, (type % m_columns) * LEVEL_TILE_WIDTH, (type / m_columns) * LEVEL_TILE_HEIGHT, tile);
+	}
+
+	m_painted = true;
+	return m_image;
+}
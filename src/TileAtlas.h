@@ -0,0 +1,68 @@
+#ifndef TILEATLAS_H
+#define TILEATLAS_H
+
+#include <SFML/Graphics.hpp>
+#include "Tile.h"
+
+/**
+ * @brief
+ * Single texture holding the graphics of all tile types.
+ * 
+ * Every tile type gets a LEVEL_TILE_WIDTH x LEVEL_TILE_HEIGHT cell painted by
+ * its TileType::paint. The layout (and so the texture coordinates) is known
+ * without creating the image, the image is painted on first use.
+ * 
+ * @see
+ * TileBatch
+ */
+class TileAtlas  {
+private:
+	sf::Image m_image;
+	bool m_painted;
+
+	/**
+	 * @brief
+	 * Number of cells in a row of the atlas.
+	 */
+	unsigned int m_columns;
+
+	/**
+	 * @brief
+	 * Size of the atlas image in pixels, powers of two.
+	 */
+	unsigned int m_width, m_height;
+
+	TileAtlas(const TileAtlas&);
+	TileAtlas& operator= (const TileAtlas&);
+
+public:
+	TileAtlas();
+
+	/**
+	 * @brief
+	 * Texture coordinates of the cell of a tile type.
+	 * 
+	 * @param type
+	 * One of TileTypeId.
+	 * 
+	 * @returns
+	 * Normalized coordinates of the cell in the atlas image.
+	 */
+	sf::FloatRect texCoords(unsigned char type) const;
+
+	/**
+	 * @brief
+	 * The atlas image, painted on the first call.
+	 * 
+	 * @remarks
+	 * Creates a texture, call only from the render thread.
+	 */
+	const sf::Image& image();
+
+	// Properties
+
+	unsigned int width() const { return m_width; }
+	unsigned int height() const { return m_height; }
+};
+
+#endif
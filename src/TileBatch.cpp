@@ -0,0 +1,305 @@
+#include <SFML/Window/OpenGL.hpp>
+#include "TileBatch.h"
+#include "Level.h"
+#include "WorldSnapshot.h"
+
+/**
+ * @brief
+ * Tiles of a live level, a source of TileBatch::buildSection.
+ */
+struct LevelTiles  {
+	explicit LevelTiles(const Level& level) : level(level) {}
+
+	const Level& level;
+
+	int width() const { return level.width(); }
+	int height() const { return level.height(); }
+	unsigned char type(int x, int y) const { return level.tile(x, y).type; }
+};
+
+/**
+ * @brief
+ * Tiles of a snapshot, a source of TileBatch::buildSection.
+ */
+struct SnapshotTiles  {
+	explicit SnapshotTiles(const TileSnapshot& snapshot) : snapshot(snapshot) {}
+
+	const TileSnapshot& snapshot;
+
+	int width() const { return snapshot.width; }
+	int height() const { return snapshot.height; }
+	unsigned char type(int x, int y) const { return snapshot.type(x, y); }
+};
+
+void TileBatch::Layer::Render(sf::RenderTarget& target) const
+{
+	if (vertices.empty() || texture == NULL)
+		return;
+
+	texture->Bind();
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(TileVertex), &vertices[0].x);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(TileVertex), &vertices[0].u);
+	glDrawArrays(GL_QUADS, 0, (GLsizei)vertices.size());
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+TileBatch::TileBatch() :
+	m_sectionsX(0),
+	m_sectionsY(0),
+	m_width(0),
+	m_height(0),
+	m_active(false),
+	m_allDirty(false),
+	m_drawCount(0),
+	m_updateCount(0)
+{
+	for (unsigned int type = 0; type < TILE_TYPE_COUNT; ++type)
+		m_texCoords[type] = m_atlas.texCoords((unsigned char)type);
+}
+
+void TileBatch::resize(int width, int height)
+{
+	sf::Lock l(m_dirtyMutex);
+
+	m_width = width;
+	m_height = height;
+	m_sectionsX = (width + SectionTiles - 1) / SectionTiles;
+	m_sectionsY = (height + SectionTiles - 1) / SectionTiles;
+	m_sections.clear();
+	m_sections.resize(m_sectionsX * m_sectionsY);
+	m_dirty.clear();
+	m_allDirty = false;
+	m_active = false;
+}
+
+void TileBatch::invalidate(int index)
+{
+	sf::Lock l(m_dirtyMutex);
+	if (m_active && !m_allDirty)
+		m_dirty.push_back(index);
+}
+
+void TileBatch::invalidateAll()
+{
+	sf::Lock l(m_dirtyMutex);
+	if (m_active)  {
+		m_allDirty = true;
+		m_dirty.clear();
+	}
+}
+
+void TileBatch::setQuad(TileVertex *quad, int x, int y, unsigned char type) const
+{
+	const float left = (float)(x * LEVEL_TILE_WIDTH), top = (float)(y * LEVEL_TILE_HEIGHT);
+	const float right = left + LEVEL_TILE_WIDTH, bottom = top + LEVEL_TILE_HEIGHT;
+	const sf::FloatRect& uv = m_texCoords[type < TILE_TYPE_COUNT ? type : (unsigned char)TILE_EMPTY];
+
+	quad[0].x = left;  quad[0].y = top;    quad[0].u = uv.Left;  quad[0].v = uv.Top;
+	quad[1].x = right; quad[1].y = top;    quad[1].u = uv.Right; quad[1].v = uv.Top;
+	quad[2].x = right; quad[2].y = bottom; quad[2].u = uv.Right; quad[2].v = uv.Bottom;
+	quad[3].x = left;  quad[3].y = bottom; quad[3].u = uv.Left;  quad[3].v = uv.Bottom;
+}
+
+void TileBatch::appendQuad(Section& section, int x, int y, int index, unsigned char type)
+{
+	Slot& slot = slotOf(section, index);
+	slot.layer = tileType(type).layer;
+	slot.type = type;
+	Layer& layer = section.layers[slot.layer];
+	slot.quad = (int)layer.tiles.size();
+
+	layer.tiles.push_back(index);
+	layer.vertices.resize(layer.vertices.size() + 4);
+	setQuad(&layer.vertices[slot.quad * 4], x, y, type);
+	++m_updateCount;
+}
+
+void TileBatch::removeQuad(Section& section, int index)
+{
+	// Move the last quad of the layer into the freed place
+	const Slot& slot = slotOf(section, index);
+	Layer& layer = section.layers[slot.layer];
+	const int last = (int)layer.tiles.size() - 1;
+	if (slot.quad != last)  {
+		const int moved = layer.tiles[last];
+		for (int i = 0; i < 4; ++i)
+			layer.vertices[slot.quad * 4 + i] = layer.vertices[last * 4 + i];
+		layer.tiles[slot.quad] = moved;
+		slotOf(section, moved).quad = slot.quad;
+	}
+
+	layer.tiles.pop_back();
+	layer.vertices.resize(last * 4);
+}
+
+void TileBatch::patchQuad(Section& section, int x, int y, int index, unsigned char type)
+{
+	Slot& slot = slotOf(section, index);
+	if (tileType(type).layer == slot.layer)  {
+		slot.type = type;
+		setQuad(&section.layers[slot.layer].vertices[slot.quad * 4], x, y, type);
+		++m_updateCount;
+	} else  {
+		removeQuad(section, index);
+		appendQuad(section, x, y, index, type);
+	}
+}
+
+template <typename Tiles>
+void TileBatch::buildSection(const Tiles& tiles, int sectionX, int sectionY)
+{
+	Section& section = m_sections[sectionY * m_sectionsX + sectionX];
+	const int left = sectionX * SectionTiles, top = sectionY * SectionTiles;
+	const int right = left + SectionTiles < tiles.width() ? left + SectionTiles : tiles.width();
+	const int bottom = top + SectionTiles < tiles.height() ? top + SectionTiles : tiles.height();
+
+	// Count the tiles of each layer first so that the arrays are allocated only once
+	int layerTiles[TILE_LAYER_COUNT] = { 0 };
+	for (int y = top; y < bottom; ++y)  {
+		for (int x = left; x < right; ++x)
+			++layerTiles[tileType(tiles.type(x, y)).layer];
+	}
+
+	section.slots.resize(SectionTiles * SectionTiles);
+	for (unsigned int layer = 0; layer < TILE_LAYER_COUNT; ++layer)  {
+		section.layers[layer].vertices.clear();
+		section.layers[layer].tiles.clear();
+		section.layers[layer].vertices.reserve(layerTiles[layer] * 4);
+		section.layers[layer].tiles.reserve(layerTiles[layer]);
+	}
+
+	for (int y = top; y < bottom; ++y)  {
+		for (int x = left; x < right; ++x)
+			appendQuad(section, x, y, y * m_width + x, tiles.type(x, y));
+	}
+
+	section.built = true;
+}
+
+void TileBatch::update(const Level& level, const sf::IntRect& tiles)
+{
+	m_updateCount = 0;
+
+	// Take the dirty tiles over, the simulation may keep adding new ones meanwhile
+	bool allDirty;
+	{
+		sf::Lock l(m_dirtyMutex);
+		m_active = true;
+		allDirty = m_allDirty;
+		m_allDirty = false;
+		m_changed.swap(m_dirty);
+		m_dirty.clear();
+	}
+
+	// Chunks must not be packed or freed while their tiles are read
+	sf::Lock chunkLock(level.chunkMutex());
+
+	if (allDirty)  {
+		for (size_t i = 0; i < m_sections.size(); ++i)
+			m_sections[i].built = false;
+	}
+
+	for (size_t i = 0; i < m_changed.size(); ++i)  {
+		const int index = m_changed[i];
+		Section& section = sectionOf(index);
+
+		// Sections not built yet pick the change up when they are built
+		if (!section.built)
+			continue;
+
+		const int x = index % m_width, y = index / m_width;
+		patchQuad(section, x, y, index, level.tile(x, y).type);
+	}
+	m_changed.clear();
+
+	if (tiles.Right <= tiles.Left || tiles.Bottom <= tiles.Top)
+		return;
+
+	const int firstX = tiles.Left / SectionTiles, lastX = (tiles.Right - 1) / SectionTiles;
+	const int firstY = tiles.Top / SectionTiles, lastY = (tiles.Bottom - 1) / SectionTiles;
+	const LevelTiles source(level);
+	for (int sectionY = firstY; sectionY <= lastY; ++sectionY)  {
+		for (int sectionX = firstX; sectionX <= lastX; ++sectionX)  {
+			if (!m_sections[sectionY * m_sectionsX + sectionX].built)
+				buildSection(source, sectionX, sectionY);
+		}
+	}
+}
+
+void TileBatch::update(const TileSnapshot& snapshot, const sf::IntRect& tiles)
+{
+	m_updateCount = 0;
+	if (snapshot.width != m_width || snapshot.height != m_height)
+		resize(snapshot.width, snapshot.height);
+
+	if (tiles.Right <= tiles.Left || tiles.Bottom <= tiles.Top)
+		return;
+
+	const int firstX = tiles.Left / SectionTiles, lastX = (tiles.Right - 1) / SectionTiles;
+	const int firstY = tiles.Top / SectionTiles, lastY = (tiles.Bottom - 1) / SectionTiles;
+	const SnapshotTiles source(snapshot);
+	for (int sectionY = firstY; sectionY <= lastY; ++sectionY)  {
+		for (int sectionX = firstX; sectionX <= lastX; ++sectionX)  {
+			Section& section = m_sections[sectionY * m_sectionsX + sectionX];
+			if (!section.built)  {
+				buildSection(source, sectionX, sectionY);
+			} else if (section.version != snapshot.version)  {
+				// Snapshots may be skipped, so compare the whole section instead of replaying changes
+				const int left = sectionX * SectionTiles, top = sectionY * SectionTiles;
+				const int right = left + SectionTiles < m_width ? left + SectionTiles : m_width;
+				const int bottom = top + SectionTiles < m_height ? top + SectionTiles : m_height;
+				for (int y = top; y < bottom; ++y)  {
+					for (int x = left; x < right; ++x)  {
+						const int index = y * m_width + x;
+						const unsigned char type = snapshot.type(x, y);
+						if (slotOf(section, index).type != type)
+							patchQuad(section, x, y, index, type);
+					}
+				}
+			}
+			section.version = snapshot.version;
+		}
+	}
+}
+
+void TileBatch::render(sf::RenderTarget& target, const Level& level, const sf::IntRect& tiles)
+{
+	update(level, tiles);
+	drawSections(target, tiles);
+}
+
+void TileBatch::render(sf::RenderTarget& target, const TileSnapshot& snapshot, const sf::IntRect& tiles)
+{
+	update(snapshot, tiles);
+	drawSections(target, tiles);
+}
+
+void TileBatch::drawSections(sf::RenderTarget& target, const sf::IntRect& tiles)
+{
+	m_drawCount = 0;
+	if (tiles.Right <= tiles.Left || tiles.Bottom <= tiles.Top)
+		return;
+
+	const sf::Image& texture = m_atlas.image();
+	const int firstX = tiles.Left / SectionTiles, lastX = (tiles.Right - 1) / SectionTiles;
+	const int firstY = tiles.Top / SectionTiles, lastY = (tiles.Bottom - 1) / SectionTiles;
+
+	// Layer by layer, so that upper layers cover the lower ones of the neighbouring sections too
+	for (unsigned int layer = 0; layer < TILE_LAYER_COUNT; ++layer)  {
+		for (int sectionY = firstY; sectionY <= lastY; ++sectionY)  {
+			for (int sectionX = firstX; sectionX <= lastX; ++sectionX)  {
+				Layer& batch = m_sections[sectionY * m_sectionsX + sectionX].layers[layer];
+				if (batch.vertices.empty())
+					continue;
+
+				batch.texture = &texture;
+				target.Draw(batch);
+				++m_drawCount;
+			}
+		}
+	}
+}
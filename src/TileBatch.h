@@ -0,0 +1,293 @@
+#ifndef TILEBATCH_H
+#define TILEBATCH_H
+
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include <SFML/System.hpp>
+#include "Tile.h"
+#include "TileAtlas.h"
+
+class Level;
+struct TileSnapshot;
+
+/**
+ * @brief
+ * Vertex of a tile quad, position in world space and texture coordinates in the atlas.
+ */
+struct TileVertex  {
+	float x, y;
+	float u, v;
+};
+
+/**
+ * @brief
+ * Draws the visible part of the level with one draw call per tile layer and section.
+ * 
+ * The level is split into square sections of SectionTiles x SectionTiles tiles.
+ * Each tile is a textured quad in the vertex array of its section and of the
+ * layer of its type, all quads use the TileAtlas texture. Only the sections
+ * intersecting the view are built and drawn, so the cost scales with the
+ * screen, not with the level. Built arrays are patched only for the tiles
+ * marked by invalidate().
+ * 
+ * A batch can also be built from tile snapshots instead of a live level, for
+ * the render thread of the pipelined loop. Visible sections are then compared
+ * to each new snapshot and the differing quads patched, invalidate() is not used.
+ * 
+ * @see
+ * Level::render | TileLayer
+ */
+class TileBatch  {
+private:
+	/**
+	 * @brief
+	 * Vertices of one layer of a section, drawn with a single glDrawArrays.
+	 */
+	class Layer : public sf::Drawable  {
+	public:
+		Layer() : texture(NULL) {}
+
+		/**
+		 * @brief
+		 * Four vertices per tile.
+		 */
+		std::vector<TileVertex> vertices;
+
+		/**
+		 * @brief
+		 * Level index of the tile of each quad.
+		 */
+		std::vector<int> tiles;
+
+		const sf::Image *texture;
+
+	private:
+		void Render(sf::RenderTarget& target) const;
+	};
+
+	/**
+	 * @brief
+	 * Where the quad of a tile is within its section.
+	 */
+	struct Slot  {
+		unsigned char layer;
+		unsigned char type;
+		int quad;
+	};
+
+	struct Section  {
+		Section() : built(false), version(0) {}
+
+		Layer layers[TILE_LAYER_COUNT];
+
+		/**
+		 * @brief
+		 * Slot of every tile of the section, row by row. Allocated when the section is built.
+		 */
+		std::vector<Slot> slots;
+
+		/**
+		 * @brief
+		 * False until the vertex arrays of the section have been built.
+		 */
+		bool built;
+
+		/**
+		 * @brief
+		 * Version of the tile snapshot the section was last compared to.
+		 */
+		unsigned int version;
+	};
+
+	std::vector<Section> m_sections;
+	int m_sectionsX, m_sectionsY;
+
+	/**
+	 * @brief
+	 * Size of the level in tiles.
+	 */
+	int m_width, m_height;
+
+	TileAtlas m_atlas;
+
+	/**
+	 * @brief
+	 * Atlas coordinates of every tile type.
+	 */
+	sf::FloatRect m_texCoords[TILE_TYPE_COUNT];
+
+	/**
+	 * @brief
+	 * Set by the first update(). Until then nothing is built and invalidated
+	 * tiles are not recorded.
+	 */
+	bool m_active;
+
+	/**
+	 * @brief
+	 * Indices of the changed tiles, may contain duplicates.
+	 */
+	std::vector<int> m_dirty;
+
+	/**
+	 * @brief
+	 * Dirty tiles taken over by update(), kept to reuse its memory.
+	 */
+	std::vector<int> m_changed;
+
+	/**
+	 * @brief
+	 * When set, all sections are rebuilt when they are next needed.
+	 */
+	bool m_allDirty;
+
+	/**
+	 * @brief
+	 * Guards m_dirty, m_allDirty and m_active, tiles may be invalidated by the
+	 * simulation thread while the render thread draws.
+	 */
+	sf::Mutex m_dirtyMutex;
+
+	unsigned int m_drawCount;
+	unsigned int m_updateCount;
+
+	TileBatch(const TileBatch&);
+	TileBatch& operator= (const TileBatch&);
+
+	Section& sectionOf(int index) { return m_sections[(index / m_width / SectionTiles) * m_sectionsX + (index % m_width) / SectionTiles]; }
+	Slot& slotOf(Section& section, int index) { return section.slots[(index / m_width % SectionTiles) * SectionTiles + index % m_width % SectionTiles]; }
+
+	template <typename Tiles>
+	void buildSection(const Tiles& tiles, int sectionX, int sectionY);
+	void appendQuad(Section& section, int x, int y, int index, unsigned char type);
+	void patchQuad(Section& section, int x, int y, int index, unsigned char type);
+	void drawSections(sf::RenderTarget& target, const sf::IntRect& tiles);
+	void removeQuad(Section& section, int index);
+	void setQuad(TileVertex *quad, int x, int y, unsigned char type) const;
+
+public:
+	TileBatch();
+
+	/**
+	 * @brief
+	 * Drops the vertex arrays and sets up the batch for a level of the given size.
+	 * 
+	 * @param width
+	 * Level width in tiles.
+	 * 
+	 * @param height
+	 * Level height in tiles.
+	 * 
+	 * Nothing is built here, a level that is never rendered (dedicated server) costs nothing.
+	 */
+	void resize(int width, int height);
+
+	/**
+	 * @brief
+	 * Marks a tile whose type changed, its quad is updated before the next draw.
+	 * 
+	 * @remarks
+	 * Threadsafe.
+	 */
+	void invalidate(int index);
+
+	/**
+	 * @brief
+	 * Marks all tiles changed.
+	 * 
+	 * @remarks
+	 * Threadsafe.
+	 */
+	void invalidateAll();
+
+	/**
+	 * @brief
+	 * Brings the vertex arrays of a part of the level up to date.
+	 * 
+	 * @param level
+	 * The batched level.
+	 * 
+	 * @param tiles
+	 * The tiles that will be drawn, Right and Bottom exclusive.
+	 * 
+	 * Patches the changed tiles of the already built sections and builds the
+	 * sections intersecting the rectangle. Needs no graphics context, render() calls it.
+	 */
+	void update(const Level& level, const sf::IntRect& tiles);
+
+	/**
+	 * @brief
+	 * Brings the vertex arrays of a part of the level up to date with a tile snapshot.
+	 * 
+	 * @param snapshot
+	 * The tiles to draw. The batch is resized when the snapshot has another size.
+	 * 
+	 * @param tiles
+	 * The tiles that will be drawn, Right and Bottom exclusive.
+	 * 
+	 * Builds the sections intersecting the rectangle and patches the built ones
+	 * that differ from the snapshot. Reads nothing but the snapshot, so the
+	 * level can be simulated meanwhile.
+	 */
+	void update(const TileSnapshot& snapshot, const sf::IntRect& tiles);
+
+	/**
+	 * @brief
+	 * Updates and draws the sections intersecting a tile rectangle.
+	 * 
+	 * @param target
+	 * The render target.
+	 * 
+	 * @param level
+	 * The batched level.
+	 * 
+	 * @param tiles
+	 * The visible tiles, Right and Bottom exclusive.
+	 */
+	void render(sf::RenderTarget& target, const Level& level, const sf::IntRect& tiles);
+
+	/**
+	 * @brief
+	 * Updates from a tile snapshot and draws the sections intersecting a tile rectangle.
+	 * 
+	 * @see
+	 * update
+	 */
+	void render(sf::RenderTarget& target, const TileSnapshot& snapshot, const sf::IntRect& tiles);
+
+	// Properties
+
+	int sectionCount() const { return (int)m_sections.size(); }
+
+	/**
+	 * @brief
+	 * Vertices of a layer of a section, four per tile in the order top-left,
+	 * top-right, bottom-right, bottom-left. Empty for sections not built yet.
+	 */
+	const std::vector<TileVertex>& vertices(int section, unsigned char layer) const { return m_sections[section].layers[layer].vertices; }
+
+	const TileAtlas& atlas() const { return m_atlas; }
+
+	/**
+	 * @brief
+	 * Number of draw calls issued by the last render().
+	 */
+	unsigned int drawCount() const { return m_drawCount; }
+
+	/**
+	 * @brief
+	 * Number of tile quads written by the last update().
+	 */
+	unsigned int updateCount() const { return m_updateCount; }
+
+public:
+	// Constants
+
+	/**
+	 * @brief
+	 * Side of a section in tiles.
+	 */
+	static const int SectionTiles = 32;
+};
+
+#endif
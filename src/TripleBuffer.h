@@ -0,0 +1,95 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <boost/atomic.hpp>
+
+/**
+ * @brief
+ * Lock-free handoff of values from one producer thread to one consumer thread.
+ * 
+ * @param T
+ * Type of the buffered value. Buffers are reused, so T should keep its
+ * capacity between writes (vectors etc.) to avoid allocations.
+ * 
+ * The producer fills back() and calls publish(), the consumer calls acquire()
+ * and reads front(). The third buffer sits in the middle, so neither side ever
+ * waits for the other. The consumer always gets the most recently published
+ * value, older unread values are skipped.
+ * 
+ * @remarks
+ * Exactly one producer and one consumer thread.
+ */
+template <typename T>
+class TripleBuffer  {
+private:
+	static const unsigned int IndexMask = 3;
+	static const unsigned int FreshBit = 4;
+
+	T m_buffers[3];
+
+	/**
+	 * @brief
+	 * Index of the middle buffer, with FreshBit set when it holds an unread value.
+	 */
+	boost::atomic<unsigned int> m_middle;
+
+	/**
+	 * @brief
+	 * Buffer owned by the producer.
+	 */
+	unsigned int m_back;
+
+	/**
+	 * @brief
+	 * Buffer owned by the consumer.
+	 */
+	unsigned int m_front;
+
+	TripleBuffer(const TripleBuffer&);
+	TripleBuffer& operator= (const TripleBuffer&);
+
+public:
+	TripleBuffer() : m_middle(1), m_back(0), m_front(2) {}
+
+	/**
+	 * @brief
+	 * The buffer the producer writes to.
+	 */
+	T& back() { return m_buffers[m_back]; }
+
+	/**
+	 * @brief
+	 * Makes the back buffer available to the consumer.
+	 * 
+	 * The producer continues with a different buffer, which may contain an
+	 * older value that has to be overwritten.
+	 */
+	void publish()
+	{
+		m_back = m_middle.exchange(m_back | FreshBit, boost::memory_order_acq_rel) & IndexMask;
+	}
+
+	/**
+	 * @brief
+	 * Fetches the most recently published value, if there is a new one.
+	 * 
+	 * @returns
+	 * True if front() changed.
+	 */
+	bool acquire()
+	{
+		if (!(m_middle.load(boost::memory_order_relaxed) & FreshBit))
+			return false;
+
+		m_front = m_middle.exchange(m_front, boost::memory_order_acq_rel) & IndexMask;
+		return true;
+	}
+
+	/**
+	 * @brief
+	 * The buffer the consumer reads from.
+	 */
+	const T& front() const { return m_buffers[m_front]; }
+};
+
+#endif
@@ -1,31 +1,298 @@
+#include <algorithm>
+#include <cmath>
+#include <boost/bind.hpp>
 #include "World.h"
+#include "ThreadPool.h"
 
-void World::initialize()
+World::~World()
+{
+	for (auto it = m_heapObjects.begin(); it != m_heapObjects.end(); ++it)
+		delete (*it);
+	for (auto it = m_pools.begin(); it != m_pools.end(); ++it)
+		delete (*it);
+}
+
+bool World::removeObject(GameObject *object)
+{
+	auto it = std::find(m_heapObjects.begin(), m_heapObjects.end(), object);
+	if (it == m_heapObjects.end() || std::find(m_players.begin(), m_players.end(), object) != m_players.end())
+		return false;
+
+	m_heapObjects.erase(it);
+	delete object;
+	return true;
+}
+
+size_t World::objectCount() const
+{
+	size_t count = m_heapObjects.size();
+	for (auto it = m_pools.begin(); it != m_pools.end(); ++it)
+		count += (*it)->size();
+	return count;
+}
+
+GameObject& World::object(int index)
+{
+	return const_cast<GameObject&>(static_cast<const World *>(this)->object(index));
+}
+
+const GameObject& World::object(int index) const
+{
+	size_t i = (size_t)index;
+	if (i < m_heapObjects.size())
+		return *m_heapObjects[i];
+
+	i -= m_heapObjects.size();
+	auto it = m_pools.begin();
+	while (i >= (*it)->size())
+		i -= (*it++)->size();
+	return (*it)->object(i);
+}
+
+void World::initialize(bool loadGraphics)
+{
+	if (loadGraphics)  {
+		m_playerImage.LoadFromFile("data/tempsprite.png");
+		m_playerSprite.SetImage(m_playerImage);
+	}
+
+	spawnPlayer();
+}
+
+int World::spawnPlayer()
 {
 	// TODO remove (just for testing purposes)
-	static sf::Image image = sf::Image();
-	image.LoadFromFile("data/tempsprite.png");
-	static sf::Sprite sprite = sf::Sprite(image);
+	const int index = (int)m_players.size();
+	LevelSpawn spawn = { (2 + 4 * index) % m_level.width(), 3 % m_level.height() };
+	if (!m_spawns.empty())
+		spawn = m_spawns[index % m_spawns.size()];
+	Player *player = new Player(spawn.x * LEVEL_TILE_WIDTH, spawn.y * LEVEL_TILE_HEIGHT, LEVEL_TILE_WIDTH, LEVEL_TILE_HEIGHT);
 
-	static Player player = Player(2 * LEVEL_TILE_WIDTH, 3 * LEVEL_TILE_HEIGHT, LEVEL_TILE_WIDTH, LEVEL_TILE_HEIGHT, &sprite);
+	if (m_playerSprite.GetImage() != NULL)
+		player->setSprite(&m_playerSprite);
 
-	m_allObjects.push_back(&player);
+	return addPlayer(player);
+}
+
+int World::addPlayer(Player *player)
+{
+	addObject(player);
+	player->setLevel(&m_level);
+	m_players.push_back(player);
+	m_level.addDistanceField();
+	updateLevelFields();
+	return (int)m_players.size() - 1;
+}
+
+void World::updateLevelFields()
+{
+	for (size_t i = 0; i < m_players.size(); ++i)  {
+		// The cell under the center of the player
+		const sf::Vector2f center = m_players[i]->center();
+		int x = (int)floor(center.x / LEVEL_TILE_WIDTH), y = (int)floor(center.y / LEVEL_TILE_HEIGHT);
+		x = x < 0 ? 0 : (x >= m_level.width() ? m_level.width() - 1 : x);
+		y = y < 0 ? 0 : (y >= m_level.height() ? m_level.height() - 1 : y);
+		m_level.setDistanceSource((int)i, x, y);
+	}
+	m_level.updateFields(m_tick);
+}
+
+bool World::loadLevel(const std::string& fileName)
+{
+	LevelFileReader file;
+	m_spawns.clear();
+	if (!file.open(fileName) || !m_level.load(file))  {
+		m_level.reset(m_level.width(), m_level.height());
+		return false;
+	}
+
+	for (unsigned int i = 0; i < file.spawnCount(); ++i)
+		m_spawns.push_back(file.spawn(i));
+	return true;
 }
 
 void World::simulate(DeltaTime dt)
 {
 	m_level.simulate(dt);
-	for (auto it = m_allObjects.begin(); it != m_allObjects.end(); ++it)
+	simulateObjects(dt);
+	collideObjects();
+	++m_tick;
+	updateLevelFields();
+
+	// Free and pack the level chunks away from the players once in a while
+	if (m_tick % CompactInterval == 0)  {
+		// collideObjects listed the objects of this tick
+		m_activeAreas.clear();
+		const std::vector<GameObject *>& objects = m_collisionObjects;
+		for (auto it = objects.begin(); it != objects.end(); ++it)
+			m_activeAreas.push_back((*it)->bounds());
+		m_level.compact(m_activeAreas);
+	}
+}
+
+void World::simulateObjects(DeltaTime dt)
+{
+	for (auto it = m_heapObjects.begin(); it != m_heapObjects.end(); ++it)  {
+		(*it)->storePreviousState();
+		(*it)->simulate(dt);
+	}
+	for (auto it = m_pools.begin(); it != m_pools.end(); ++it)
 		(*it)->simulate(dt);
 }
 
-void World::render(sf::RenderTarget& target, DeltaTime dt)
+void World::collideObjects()
 {
-	m_level.render(target, dt);
-	for (auto it = m_allObjects.begin(); it != m_allObjects.end(); ++it)
-	{
-		(*it)->render(target, dt);
-		std::cout << typeid(**it).name() << std::endl;
+	m_collisionObjects.assign(m_heapObjects.begin(), m_heapObjects.end());
+	for (auto it = m_pools.begin(); it != m_pools.end(); ++it)
+		(*it)->listObjects(m_collisionObjects);
+
+	m_broadphase.clear();
+	for (size_t i = 0; i < m_collisionObjects.size(); ++i)
+		m_broadphase.insert((int)i, m_collisionObjects[i]->bounds());
+	m_broadphase.build();
+
+	const unsigned int buckets = m_broadphase.bucketCount();
+	const size_t jobs = m_collisionPool && m_collisionObjects.size() >= ParallelCollisionObjects ? m_collisionPool->size() : 1;
+	if (m_collisionBuffers.size() < jobs)
+		m_collisionBuffers.resize(jobs);
+
+	if (jobs == 1)  {
+		findContacts(0, 0, buckets);
+	} else {
+		for (size_t j = 0; j < jobs; ++j)  {
+			const unsigned int first = (unsigned int)(buckets * j / jobs), last = (unsigned int)(buckets * (j + 1) / jobs);
+			m_collisionPool->submit(boost::bind(&World::findContacts, this, j, first, last));
+		}
+		m_collisionPool->wait();
+	}
+
+	// Merge and sort, so the handlers run in the same order for any number of jobs
+	m_collisionPairs.clear();
+	for (size_t j = 0; j < jobs; ++j)
+		m_collisionPairs.insert(m_collisionPairs.end(), m_collisionBuffers[j].contacts.begin(), m_collisionBuffers[j].contacts.end());
+	std::sort(m_collisionPairs.begin(), m_collisionPairs.end());
+
+	for (auto it = m_collisionPairs.begin(); it != m_collisionPairs.end(); ++it)
+		CollisionTable::collide(*m_collisionObjects[it->first], *m_collisionObjects[it->second]);
+}
+
+void World::findContacts(size_t buffer, unsigned int firstBucket, unsigned int lastBucket)
+{
+	CollisionBuffer& b = m_collisionBuffers[buffer];
+	m_broadphase.findPairs(b.candidates, firstBucket, lastBucket);
+
+	b.contacts.clear();
+	for (auto it = b.candidates.begin(); it != b.candidates.end(); ++it)  {
+		if (m_collisionObjects[it->first]->overlaps(*m_collisionObjects[it->second]))
+			b.contacts.push_back(*it);
+	}
+}
+
+void World::saveState(StateBuffer& state) const
+{
+	state.clear();
+	state.write(m_tick);
+	state.write(objectCount());
+	m_level.saveState(state);
+	for (auto it = m_heapObjects.begin(); it != m_heapObjects.end(); ++it)
+		(*it)->saveState(state);
+	for (auto it = m_pools.begin(); it != m_pools.end(); ++it)  {
+		for (size_t i = 0; i < (*it)->size(); ++i)
+			(*it)->object(i).saveState(state);
+	}
+}
+
+bool World::loadState(StateBuffer& state)
+{
+	state.rewind();
+
+	unsigned int tick = 0;
+	size_t objectCount = 0;
+	if (!state.read(tick) || !state.read(objectCount) || objectCount != this->objectCount())
+		return false;
+
+	if (!m_level.loadState(state))
+		return false;
+
+	for (auto it = m_heapObjects.begin(); it != m_heapObjects.end(); ++it)  {
+		if (!(*it)->loadState(state))
+			return false;
+	}
+	for (auto it = m_pools.begin(); it != m_pools.end(); ++it)  {
+		for (size_t i = 0; i < (*it)->size(); ++i)  {
+			if (!(*it)->object(i).loadState(state))
+				return false;
+		}
+	}
+
+	m_tick = tick;
+	updateLevelFields();
+	return true;
+}
+
+void World::copyView(const World& source, StateBuffer& state)
+{
+	m_level.copyFrom(source.m_level);
+	while (m_players.size() < source.m_players.size())
+		addPlayer(new Player(0, 0, LEVEL_TILE_WIDTH, LEVEL_TILE_HEIGHT));
+
+	state.clear();
+	for (size_t i = 0; i < m_players.size(); ++i)
+		source.m_players[i]->saveState(state);
+
+	state.rewind();
+	for (size_t i = 0; i < m_players.size(); ++i)
+		m_players[i]->loadState(state);
+	m_tick = source.m_tick;
+}
+
+void World::captureSnapshot(WorldSnapshot& snapshot)
+{
+	m_level.captureTiles(snapshot.tiles);
+
+	snapshot.objects.resize(objectCount());
+	size_t index = 0;
+	for (auto it = m_heapObjects.begin(); it != m_heapObjects.end(); ++it)
+		(*it)->captureSnapshot(snapshot.objects[index++]);
+	for (auto it = m_pools.begin(); it != m_pools.end(); ++it)  {
+		for (size_t i = 0; i < (*it)->size(); ++i)
+			(*it)->object(i).captureSnapshot(snapshot.objects[index++]);
+	}
+}
+
+void World::renderSnapshot(sf::RenderTarget& target, const WorldSnapshot& snapshot, DeltaTime dt, float alpha)
+{
+	renderSnapshot(target, snapshot, Camera(target.GetView().GetRect()), dt, alpha);
+}
+
+void World::renderSnapshot(sf::RenderTarget& target, const WorldSnapshot& snapshot, const Camera& camera, DeltaTime dt, float alpha)
+{
+	const TileSnapshot& tiles = snapshot.tiles;
+	m_snapshotBatch.render(target, tiles, Level::visibleTiles(camera, tiles.width, tiles.height));
+	for (auto it = snapshot.objects.begin(); it != snapshot.objects.end(); ++it)  {
+		if (it->renderer != NULL && camera.isVisible(it->bounds()))
+			it->renderer(target, *it, alpha);
+	}
+}
+
+void World::render(sf::RenderTarget& target, DeltaTime dt, float alpha)
+{
+	render(target, Camera(target.GetView().GetRect()), dt, alpha);
+}
+
+void World::render(sf::RenderTarget& target, const Camera& camera, DeltaTime dt, float alpha)
+{
+	m_level.render(target, camera, dt, alpha);
+	for (auto it = m_heapObjects.begin(); it != m_heapObjects.end(); ++it)  {
+		if (camera.isVisible((*it)->bounds()))
+			(*it)->render(target, dt, alpha);
+	}
+	for (auto it = m_pools.begin(); it != m_pools.end(); ++it)  {
+		for (size_t i = 0; i < (*it)->size(); ++i)  {
+			GameObject& pooled = (*it)->object(i);
+			if (camera.isVisible(pooled.bounds()))
+				pooled.render(target, dt, alpha);
+		}
 	}
 }
 
@@ -6,7 +6,12 @@
 #include "Simulable.h"
 #include "Renderable.h"
 #include "Level.h"
+#include "Camera.h"
 #include "Player.h"
+#include "SpatialHash.h"
+#include "ObjectPool.h"
+
+class ThreadPool;
 
 /**
  * @brief
@@ -14,6 +19,11 @@
  * 
  * Contains level, players and all other simulable objects.
  * 
+ * Objects are either allocated on the heap one by one (addObject) or stored
+ * by value in a dense pool per type (addPool). Heap objects are simulated
+ * through virtual calls, each pool in one tight loop over its array, which
+ * suits types with thousands of small objects.
+ * 
  * @remarks
  * Write remarks for World here.
  * 
@@ -22,17 +32,439 @@
  */
 class World : public Simulable, public Renderable  {
 private:
-	std::vector<GameObject *> m_allObjects;
+	/**
+	 * @brief
+	 * Objects added by addObject, owned and freed by the world.
+	 */
+	std::vector<GameObject *> m_heapObjects;
+
+	/**
+	 * @brief
+	 * Pools added by addPool, owned and freed by the world.
+	 */
+	std::vector<ObjectPoolBase *> m_pools;
+
+	/**
+	 * @brief
+	 * All objects in the order of object(), listed by collideObjects once per tick.
+	 * 
+	 * The broadphase and the collision pairs refer to the objects by their index
+	 * in it. Additions and removals do not touch it, so they cost the same for
+	 * any number of objects.
+	 */
+	std::vector<GameObject *> m_collisionObjects;
 
 	Level m_level;
 
+	/**
+	 * @brief
+	 * Number of ticks simulated so far.
+	 */
+	unsigned int m_tick;
+
+	/**
+	 * @brief
+	 * Player spawn positions of the level, in tiles.
+	 */
+	std::vector<LevelSpawn> m_spawns;
+
+	/**
+	 * @brief
+	 * Bounds of the objects, reused by every level compaction.
+	 */
+	std::vector<sf::FloatRect> m_activeAreas;
+
+	/**
+	 * @brief
+	 * Number of ticks between two level compactions, see Level::compact.
+	 */
+	static const unsigned int CompactInterval = 256;
+
+	/**
+	 * @brief
+	 * The players, also in m_heapObjects. Player i is the source of level distance field i.
+	 */
+	std::vector<Player *> m_players;
+
+	/**
+	 * @brief
+	 * Broadphase of collideObjects, rebuilt every tick.
+	 */
+	SpatialHash m_broadphase;
+
+	/**
+	 * @brief
+	 * Pairs found by one collision job in its range of broadphase buckets.
+	 */
+	struct CollisionBuffer  {
+		std::vector<ObjectPair> candidates;   // sharing a cell
+		std::vector<ObjectPair> contacts;     // overlapping
+	};
+
+	/**
+	 * @brief
+	 * One buffer per collision job, merged after all jobs finished.
+	 */
+	std::vector<CollisionBuffer> m_collisionBuffers;
+
+	/**
+	 * @brief
+	 * Pairs of overlapping objects in the last tick, indices into m_collisionObjects, sorted.
+	 */
+	std::vector<ObjectPair> m_collisionPairs;
+
+	/**
+	 * @brief
+	 * Runs the collision jobs, NULL to find the collisions on the calling thread. Not owned.
+	 */
+	ThreadPool *m_collisionPool;
+
+	/**
+	 * @brief
+	 * Fewer objects are collided on the calling thread, the jobs would cost more than they save.
+	 */
+	static const size_t ParallelCollisionObjects = 256;
+
+	/**
+	 * @brief
+	 * Body of a collision job: finds the overlapping pairs in a range of broadphase buckets.
+	 */
+	void findContacts(size_t buffer, unsigned int firstBucket, unsigned int lastBucket);
+
+	/**
+	 * @brief
+	 * Moves the distance field sources to the players and updates the level fields.
+	 */
+	void updateLevelFields();
+
+	/**
+	 * @brief
+	 * Vertex arrays of the level tiles of the drawn snapshots, used by the render thread only.
+	 */
+	TileBatch m_snapshotBatch;
+
+	// TODO: temporary player graphics, move to a resource manager
+	sf::Image m_playerImage;
+	sf::Sprite m_playerSprite;
+
+	World(const World&);
+	World& operator= (const World&);
+
 public:
-	World() : m_level(42, 42) {} // TODO: just temporary
+	World() : m_level(42, 42), m_tick(0), m_broadphase(LEVEL_TILE_WIDTH, LEVEL_TILE_HEIGHT), m_collisionPool(NULL) {} // TODO: just temporary
+
+	/**
+	 * @brief
+	 * Creates an empty world with a level of the given size.
+	 * 
+	 * @param width
+	 * Level width in tiles.
+	 * 
+	 * @param height
+	 * Level height in tiles.
+	 */
+	World(int width, int height) : m_level(width, height), m_tick(0), m_broadphase(LEVEL_TILE_WIDTH, LEVEL_TILE_HEIGHT), m_collisionPool(NULL) {}
+
+	~World();
+
+	/**
+	 * @brief
+	 * Replaces the level by a compiled level file.
+	 * 
+	 * @param fileName
+	 * Path to the level file, see LevelFileReader.
+	 * 
+	 * @returns
+	 * False if the file cannot be read, the level is left empty then.
+	 * 
+	 * Call before initialize(), the objects are placed at the spawns of the level.
+	 */
+	bool loadLevel(const std::string& fileName);
 
-	void initialize();
+	/**
+	 * @brief
+	 * Populates the world with its initial objects.
+	 * 
+	 * @param loadGraphics
+	 * False on a dedicated server, no images or sprites are loaded then.
+	 */
+	void initialize(bool loadGraphics = true);
+
+	/**
+	 * @brief
+	 * Adds a player at the next spawn of the level, with the player graphics if they are loaded.
+	 * 
+	 * @returns
+	 * Index of the player, see addPlayer.
+	 * 
+	 * The spawns are used in order and reused when there are more players than spawns.
+	 */
+	int spawnPlayer();
+
+	/**
+	 * @brief
+	 * Adds an object to the world.
+	 * 
+	 * @param object
+	 * The object to add, allocated on the heap. The world takes ownership.
+	 */
+	void addObject(GameObject *object)
+	{
+		m_heapObjects.push_back(object);
+	}
+
+	/**
+	 * @brief
+	 * Removes an object added by addObject and frees it.
+	 * 
+	 * @returns
+	 * False if the object is not a heap object of the world or a player, players stay.
+	 * 
+	 * The indices of the objects after it shift down by one. Safe while the
+	 * render thread draws snapshots of the world, an ObjectSnapshot keeps no
+	 * pointer to the object it was taken from.
+	 */
+	bool removeObject(GameObject *object);
+
+	/**
+	 * @brief
+	 * Adds an empty pool for objects of one type.
+	 * 
+	 * @param capacity
+	 * Maximum number of objects in the pool.
+	 * 
+	 * @returns
+	 * The pool, owned by the world. Objects added to it are part of the world.
+	 * 
+	 * Pools are simulated after the heap objects, in the order they were added.
+	 * 
+	 * @see
+	 * ObjectPool
+	 */
+	template <typename T>
+	ObjectPool<T>& addPool(size_t capacity)
+	{
+		ObjectPool<T> *pool = new ObjectPool<T>(capacity);
+		m_pools.push_back(pool);
+		return *pool;
+	}
+
+	/**
+	 * @brief
+	 * Adds a player to the world, with a level distance field following it.
+	 * The player walks in and places its bombs into the level of the world.
+	 * 
+	 * @param player
+	 * The player, allocated on the heap. The world takes ownership.
+	 * 
+	 * @returns
+	 * Index of the player, also the index of its field, see Level::distances.
+	 */
+	int addPlayer(Player *player);
 
 	void simulate(DeltaTime dt);
-	void render(sf::RenderTarget& target, DeltaTime dt);
+	void render(sf::RenderTarget& target, DeltaTime dt, float alpha);
+
+	/**
+	 * @brief
+	 * Renders the part of the world visible by a camera.
+	 * 
+	 * @param target
+	 * The render target.
+	 * 
+	 * @param camera
+	 * The camera. Only the tiles in its view are visited and objects whose
+	 * bounds lie outside of it are skipped.
+	 * 
+	 * @param dt
+	 * Delta time of last frame.
+	 * 
+	 * @param alpha
+	 * Interpolation factor, see Renderable::render.
+	 * 
+	 * @remarks
+	 * The camera is not applied to the target, see Camera::apply.
+	 */
+	void render(sf::RenderTarget& target, const Camera& camera, DeltaTime dt, float alpha);
+
+	/**
+	 * @brief
+	 * Simulates all objects but not the level. Part of simulate().
+	 * 
+	 * The heap objects one by one, then each pool in a loop of its own.
+	 */
+	void simulateObjects(DeltaTime dt);
+
+	/**
+	 * @brief
+	 * Finds the overlapping objects and lets them collide. Part of simulate().
+	 * 
+	 * The objects are hashed by the tiles their bounds cover, only objects
+	 * sharing a tile are tested against each other, see SpatialHash. Objects
+	 * against the level need no broadphase, they look up the tiles they cover
+	 * in the level bit-planes.
+	 * 
+	 * With a collision pool the pair search and overlap tests are split by
+	 * broadphase buckets between the workers, each collecting into its own
+	 * buffer. The buffers are merged and sorted by object index before the
+	 * first handler is called, the handlers run on the calling thread. The
+	 * result so does not depend on the number of threads.
+	 * 
+	 * @see
+	 * GameObject::overlaps | CollisionTable
+	 */
+	void collideObjects();
+
+	/**
+	 * @brief
+	 * Sets the thread pool collideObjects spreads its work over.
+	 * 
+	 * @param pool
+	 * The pool, NULL to collide on the simulating thread. Not owned, must
+	 * outlive the world or be reset before it is destroyed.
+	 */
+	void setCollisionPool(ThreadPool *pool) { m_collisionPool = pool; }
+
+	/**
+	 * @brief
+	 * Copies the render state of the current tick into a snapshot.
+	 * 
+	 * @param snapshot
+	 * The snapshot to fill (output). Its buffers are reused, so capturing
+	 * into the same snapshot again does not allocate.
+	 * 
+	 * Copies the objects and the level tiles changed since the snapshot was
+	 * captured last, see Level::captureTiles.
+	 * 
+	 * @see
+	 * World::renderSnapshot
+	 */
+	void captureSnapshot(WorldSnapshot& snapshot);
+
+	/**
+	 * @brief
+	 * Renders a snapshot captured earlier by captureSnapshot.
+	 * 
+	 * @param target
+	 * The render target.
+	 * 
+	 * @param snapshot
+	 * The snapshot to draw.
+	 * 
+	 * @param dt
+	 * Delta time of last frame.
+	 * 
+	 * @param alpha
+	 * Interpolation factor, see Renderable::render.
+	 * 
+	 * Safe to call while another thread simulates the world, the level is drawn
+	 * from the tiles of the snapshot and objects through the renderer of their
+	 * snapshot, which does not touch the object.
+	 * 
+	 * @see
+	 * Game::runPipelined
+	 */
+	void renderSnapshot(sf::RenderTarget& target, const WorldSnapshot& snapshot, DeltaTime dt, float alpha);
+
+	/**
+	 * @brief
+	 * Renders the part of a snapshot visible by a camera.
+	 * 
+	 * @see
+	 * World::renderSnapshot | World::render
+	 */
+	void renderSnapshot(sf::RenderTarget& target, const WorldSnapshot& snapshot, const Camera& camera, DeltaTime dt, float alpha);
+
+	/**
+	 * @brief
+	 * Saves the complete simulation state into a flat buffer.
+	 * 
+	 * @param state
+	 * The buffer to save to. It is cleared first and its memory reused, so saving
+	 * into the same buffer again does not allocate.
+	 * 
+	 * Used for rollback, the state can be restored any number of times by loadState.
+	 * Render resources (images, sprites) are not part of the state.
+	 * 
+	 * @see
+	 * World::loadState
+	 */
+	void saveState(StateBuffer& state) const;
+
+	/**
+	 * @brief
+	 * Restores the simulation state saved by saveState.
+	 * 
+	 * @param state
+	 * The saved state.
+	 * 
+	 * @returns
+	 * False if the state does not match this world (different level size or set
+	 * of objects). The world is left partially restored then.
+	 * 
+	 * @remarks
+	 * Objects are not created or deleted, the world must contain the same objects
+	 * in the same order as when the state was saved. Does not allocate.
+	 */
+	bool loadState(StateBuffer& state);
+
+	/**
+	 * @brief
+	 * Makes this world a copy of the level and the players of another world.
+	 * 
+	 * @param source
+	 * The world to copy.
+	 * 
+	 * @param state
+	 * Buffer the players are copied through, its memory is reused.
+	 * 
+	 * Bots read such a copy, so a bot that is still thinking does not see the
+	 * source while it is simulated, see BotController. The copy has the size of
+	 * the source level and gets as many players, other objects are not copied.
+	 * The level is copied by Level::copyFrom, only the chunks changed since the
+	 * last copy of the same source.
+	 */
+	void copyView(const World& source, StateBuffer& state);
+
+	// Properties
+
+	Level& level() { return m_level; }
+	const Level& level() const { return m_level; }
+
+	/**
+	 * @brief
+	 * Number of objects, heap and pooled ones.
+	 */
+	size_t objectCount() const;
+
+	/**
+	 * @brief
+	 * An object by index, the heap objects first, then the pools. Indices of
+	 * pooled objects change when objects are removed, see ObjectPool::remove.
+	 * 
+	 * Finds the pool of the index by walking the pools, which are few.
+	 */
+	GameObject& object(int index);
+	const GameObject& object(int index) const;
+
+	/**
+	 * @brief
+	 * Pairs of overlapping objects found by the last collideObjects, lower index
+	 * first, sorted. The order the handlers were called in.
+	 */
+	const std::vector<ObjectPair>& collisionPairs() const { return m_collisionPairs; }
+
+	/**
+	 * @brief
+	 * The broadphase as built by the last collideObjects.
+	 */
+	const SpatialHash& broadphase() const { return m_broadphase; }
+
+	size_t playerCount() const { return m_players.size(); }
+	Player& player(int index) { return *m_players[index]; }
+	const Player& player(int index) const { return *m_players[index]; }
+
+	unsigned int tick() const { return m_tick; }
 };
 
 #endif
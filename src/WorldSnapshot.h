@@ -0,0 +1,132 @@
+#ifndef WORLDSNAPSHOT_H
+#define WORLDSNAPSHOT_H
+
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+struct ObjectSnapshot;
+
+/**
+ * @brief
+ * Draws an object from its snapshot.
+ * 
+ * @param target
+ * The render target.
+ * 
+ * @param snapshot
+ * The state of the object.
+ * 
+ * @param alpha
+ * Interpolation factor, see Renderable::render.
+ */
+typedef void (*SnapshotRenderer)(sf::RenderTarget& target, const ObjectSnapshot& snapshot, float alpha);
+
+/**
+ * @brief
+ * Render state of a single object at the end of a simulation tick.
+ * 
+ * Holds no pointer to the object: the render thread may draw the snapshot
+ * after the object was removed from the world, see World::removeObject.
+ * 
+ * @see
+ * GameObject::captureSnapshot
+ */
+struct ObjectSnapshot  {
+	/**
+	 * @brief
+	 * Draws the snapshot, NULL for objects that are not drawn.
+	 */
+	SnapshotRenderer renderer;
+
+	/**
+	 * @brief
+	 * Sprite of the object and its center without animation, NULL for none.
+	 * 
+	 * Sprites are owned by the world, not by the objects, so they outlive removed objects.
+	 */
+	sf::Sprite *sprite;
+	sf::Vector2f spriteCenter;
+
+	float x, y;
+	float prevX, prevY;
+	float width, height;
+
+	/**
+	 * @brief
+	 * Sprite animation frame.
+	 */
+	int frame;
+
+	/**
+	 * @brief
+	 * Same as GameObject::bounds at the time of the snapshot.
+	 */
+	sf::FloatRect bounds() const
+	{
+		return sf::FloatRect(x < prevX ? x : prevX, y < prevY ? y : prevY,
+			(x > prevX ? x : prevX) + width, (y > prevY ? y : prevY) + height);
+	}
+};
+
+/**
+ * @brief
+ * Types of all level tiles at the end of a simulation tick.
+ * 
+ * Kept up to date incrementally: capturing into a snapshot copies only the
+ * tiles changed since the snapshot was captured last, see Level::captureTiles.
+ */
+struct TileSnapshot  {
+	TileSnapshot() : width(0), height(0), version(0) {}
+
+	/**
+	 * @brief
+	 * Level size in tiles.
+	 */
+	int width, height;
+
+	/**
+	 * @brief
+	 * Type of every tile, row by row.
+	 */
+	std::vector<unsigned char> types;
+
+	/**
+	 * @brief
+	 * Tile change count of the level the types are up to date with, 0 for an empty snapshot.
+	 */
+	unsigned int version;
+
+	unsigned char type(int x, int y) const { return types[y * width + x]; }
+};
+
+/**
+ * @brief
+ * Immutable copy of everything needed to draw one simulation tick.
+ * 
+ * Filled by the simulation thread and drawn by the render thread in the
+ * pipelined game loop, so that simulation of the next tick can run while
+ * the previous one is drawn.
+ * 
+ * @see
+ * World::captureSnapshot | World::renderSnapshot | Game::runPipelined
+ */
+struct WorldSnapshot  {
+	WorldSnapshot() : tick(0), time(0) {}
+
+	/**
+	 * @brief
+	 * Number of the simulated tick.
+	 */
+	unsigned int tick;
+
+	/**
+	 * @brief
+	 * Time the tick was finished at, in seconds of the game clock. Used for interpolation.
+	 */
+	double time;
+
+	std::vector<ObjectSnapshot> objects;
+	TileSnapshot tiles;
+};
+
+#endif
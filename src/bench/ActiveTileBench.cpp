@@ -0,0 +1,92 @@
+#include <cstdio>
+#include <boost/lexical_cast.hpp>
+#include "bench/Benchmark.h"
+#include "PrecisionClock.h"
+#include "Level.h"
+#include "tiles/FlameTile.h"
+
+/**
+ * @brief
+ * Measures level simulation of a large static level with a few burning tiles.
+ * 
+ * @param size
+ * Level side in tiles.
+ * 
+ * @param flames
+ * Number of flame tiles, spread over the level.
+ * 
+ * @returns
+ * False if the flames did not burn out as expected.
+ */
+static bool benchActiveTileCase(int size, int flames)
+{
+	const DeltaTime dt = 1.0f / 60;
+	const std::string caseName = "level " + boost::lexical_cast<std::string>(size) + "x" + boost::lexical_cast<std::string>(size)
+		+ " flames " + boost::lexical_cast<std::string>(flames);
+
+	// Solid pillars everywhere, so that all chunks are allocated like in a real level
+	Level level(size, size);
+	for (int y = 0; y < size; y += 2)  {
+		for (int x = 0; x < size; x += 2)
+			level.setTileFlags(x, y, TILE_FLAG_SOLID);
+	}
+
+	const int step = flames > 0 ? (size * size) / flames : 1;
+	for (int i = 0; i < flames; ++i)  {
+		const int index = i * step + 1;
+		level.setTile(index % size, index / size, TILE_FLAME);
+	}
+
+	// What simulate cost before the active tile list: a type lookup per tile
+	PrecisionClock clock;
+	int simulated = 0;
+	for (int y = 0; y < size; ++y)  {
+		for (int x = 0; x < size; ++x)  {
+			if (tileType(level.tile(x, y).type).simulate != NULL)
+				++simulated;
+		}
+	}
+	report("activetile", caseName, "scan all tiles", clock.elapsed() * 1e6, "us/tick");
+
+	// All flames burn during these ticks
+	const unsigned int ticks = FlameTile::BurnTicks - 1;
+	const boost::uint64_t allocs = allocationCount();
+	clock.reset();
+	for (unsigned int i = 0; i < ticks; ++i)
+		level.simulate(dt);
+	const double time = clock.elapsed();
+	const boost::uint64_t allocCount = allocationCount() - allocs;
+
+	report("activetile", caseName, "level.simulate", time * 1e6 / ticks, "us/tick");
+	if (flames > 0)
+		report("activetile", caseName, "per active tile", time * 1e9 / ticks / flames, "ns/tile");
+	report("activetile", caseName, "allocs", (double)allocCount / ticks, "allocs/tick");
+
+	// The flames burn out on the next tick and leave the list on the one after
+	const bool burning = simulated == flames && level.activeTileCount() == (size_t)flames;
+	level.simulate(dt);
+	level.simulate(dt);
+	bool ok = burning && level.activeTileCount() == 0;
+	for (int i = 0; i < flames && ok; ++i)  {
+		const int index = i * step + 1;
+		ok = level.tile(index % size, index / size).type == TILE_EMPTY;
+	}
+	report("activetile", caseName, "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+bool benchActiveTiles(const BenchSettings& settings)
+{
+	static const int sizes[] = { 512, 2048 };
+	static const int flameCounts[] = { 0, 64, 4096 };
+
+	bool ok = true;
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)  {
+		if (sizes[s] > (int)settings.maxLevelSize)
+			break;
+
+		for (size_t f = 0; f < sizeof(flameCounts) / sizeof(flameCounts[0]); ++f)
+			ok &= benchActiveTileCase(sizes[s], flameCounts[f]);
+	}
+	return ok;
+}
@@ -0,0 +1,110 @@
+/**
+ * Standalone benchmark of the game simulation. Runs without a window, so it
+ * can be used to track performance regressions on build machines.
+ * 
+ * Built by the UHKBomberBench project, or the UHKBomberBench target of
+ * CMakeLists.txt. On Linux also for example with:
+ *   g++ -std=c++11 -O2 -Isrc src/bench/Benchmark.cpp src/bench/WorldBench.cpp \
+ *       src/bench/SnapshotBench.cpp src/bench/TileBatchBench.cpp src/bench/LevelFileBench.cpp \
+ *       src/bench/ActiveTileBench.cpp src/bench/BitPlaneBench.cpp src/bench/ExplosionBench.cpp \
+ *       src/bench/FieldBench.cpp src/bench/BotBench.cpp \
+ *       src/bench/CollisionBench.cpp src/bench/SweepBench.cpp src/bench/PoolBench.cpp \
+ *       <game sources except main.cpp> \
+ *       -lsfml-graphics -lsfml-window -lsfml-system -lboost_thread -lboost_system
+ * 
+ * Usage: UHKBomberBench [-ticks N] [-maxsize N] [-maxobjects N]
+ * 
+ * Returns 1 when a verification (for example of the tile vertex data) failed.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <boost/lexical_cast.hpp>
+#include "bench/Benchmark.h"
+
+static boost::uint64_t g_allocations = 0;
+
+void *operator new(size_t size)
+{
+	++g_allocations;
+	void *p = malloc(size ? size : 1);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *p) throw()
+{
+	free(p);
+}
+
+void operator delete[](void *p) throw()
+{
+	free(p);
+}
+
+boost::uint64_t allocationCount()
+{
+	return g_allocations;
+}
+
+void report(const std::string& suite, const std::string& caseName, const std::string& metric, double value, const std::string& unit)
+{
+	printf("%-10s %-36s %-22s %12.2f %s\n", suite.c_str(), caseName.c_str(), metric.c_str(), value, unit.c_str());
+	fflush(stdout);
+}
+
+/**
+ * @brief
+ * Reads a numeric argument of a command line switch.
+ */
+static void readArgument(int& i, int argc, const char *argv[], unsigned int& value)
+{
+	if (i + 1 >= argc)
+		return;
+
+	try  {
+		value = boost::lexical_cast<unsigned int>(argv[i + 1]);
+		++i;
+	} catch (boost::bad_lexical_cast& )  {
+		fprintf(stderr, "Invalid argument of %s: %s\n", argv[i], argv[i + 1]);
+	}
+}
+
+int main(int argc, const char *argv[])
+{
+	BenchSettings settings;
+	for (int i = 1; i < argc; ++i)  {
+		const std::string arg = argv[i];
+		if (arg == "-ticks")
+			readArgument(i, argc, argv, settings.ticks);
+		else if (arg == "-maxsize")
+			readArgument(i, argc, argv, settings.maxLevelSize);
+		else if (arg == "-maxobjects")
+			readArgument(i, argc, argv, settings.maxObjects);
+		else
+			fprintf(stderr, "Unknown switch %s\n", arg.c_str());
+	}
+
+	benchWorld(settings);
+	const bool snapshotOk = benchSnapshot(settings);
+	const bool tileBatchOk = benchTileBatch(settings);
+	const bool levelFileOk = benchLevelFile(settings);
+	const bool activeTilesOk = benchActiveTiles(settings);
+	const bool bitPlanesOk = benchBitPlanes(settings);
+	const bool explosionsOk = benchExplosions(settings);
+	const bool fieldsOk = benchFields(settings);
+	const bool botsOk = benchBots(settings);
+	const bool collisionsOk = benchCollisions(settings);
+	const bool sweepOk = benchSweep(settings);
+	const bool poolsOk = benchPools(settings);
+
+	// Fail the build machine run when a verification failed
+	return snapshotOk && tileBatchOk && levelFileOk && activeTilesOk && bitPlanesOk && explosionsOk && fieldsOk && botsOk && collisionsOk && sweepOk && poolsOk ? 0 : 1;
+}
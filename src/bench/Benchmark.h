@@ -0,0 +1,171 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <boost/cstdint.hpp>
+
+/**
+ * @brief
+ * Settings of a benchmark run, parsed from the command line.
+ */
+struct BenchSettings  {
+	BenchSettings() : ticks(200), maxLevelSize(4096), maxObjects(1000) {}
+
+	/**
+	 * @brief
+	 * Number of measured ticks per case.
+	 */
+	unsigned int ticks;
+
+	/**
+	 * @brief
+	 * Largest level side in tiles.
+	 */
+	unsigned int maxLevelSize;
+
+	/**
+	 * @brief
+	 * Largest number of objects in the world.
+	 */
+	unsigned int maxObjects;
+};
+
+/**
+ * @brief
+ * Number of heap allocations made by the process so far.
+ * 
+ * The benchmark replaces the global operator new to count them.
+ */
+boost::uint64_t allocationCount();
+
+/**
+ * @brief
+ * Prints one measured value of a benchmark case.
+ * 
+ * @param suite
+ * Name of the suite, for example "world".
+ * 
+ * @param caseName
+ * Name of the case including its parameters, for example "level 42x42 objects 10".
+ * 
+ * @param metric
+ * What has been measured, for example "level.simulate".
+ * 
+ * @param value
+ * The measured value.
+ * 
+ * @param unit
+ * Unit of the value, for example "ns/tile".
+ */
+void report(const std::string& suite, const std::string& caseName, const std::string& metric, double value, const std::string& unit);
+
+/**
+ * @brief
+ * Simulation and render command generation throughput of World and Level.
+ */
+void benchWorld(const BenchSettings& settings);
+
+/**
+ * @brief
+ * Save and restore times of the complete world state, as used for rollback.
+ * Each restore undoes a few ticks of walking, bombs and explosions.
+ * 
+ * @returns
+ * False if a restored world differs from the saved one.
+ */
+bool benchSnapshot(const BenchSettings& settings);
+
+/**
+ * @brief
+ * Build and update times of the level vertex arrays. Also checks the generated
+ * vertex data, so the batching can be verified without a GPU.
+ * 
+ * @returns
+ * False if the vertex data is wrong.
+ */
+bool benchTileBatch(const BenchSettings& settings);
+
+/**
+ * @brief
+ * Compile and load times of binary level files. Also checks the loaded tiles.
+ * 
+ * @returns
+ * False if a level did not load back unchanged.
+ */
+bool benchLevelFile(const BenchSettings& settings);
+
+/**
+ * @brief
+ * Level simulation cost of a large static level with a varying number of active tiles.
+ * 
+ * @returns
+ * False if the active tiles did not behave as expected.
+ */
+bool benchActiveTiles(const BenchSettings& settings);
+
+/**
+ * @brief
+ * Row, column and blast zone queries of the level bit-planes compared to walking the tiles.
+ * 
+ * @returns
+ * False if a plane query disagrees with the tiles.
+ */
+bool benchBitPlanes(const BenchSettings& settings);
+
+/**
+ * @brief
+ * Ticks in which hundreds of bombs explode at once or in a chain reaction.
+ * 
+ * @returns
+ * False if the explosions differ from a cell by cell reference.
+ */
+bool benchExplosions(const BenchSettings& settings);
+
+/**
+ * @brief
+ * Incremental updates of the level danger and distance fields compared to computing them from scratch.
+ * 
+ * @returns
+ * False if the fields differ from the fields computed by walking the tiles.
+ */
+bool benchFields(const BenchSettings& settings);
+
+/**
+ * @brief
+ * Think times of bot games on the worker pool, and bots exceeding their budget.
+ * 
+ * @returns
+ * False if a recorded bot game does not replay to the same state or an action of a late bot was applied.
+ */
+bool benchBots(const BenchSettings& settings);
+
+/**
+ * @brief
+ * Object collision pass with the spatial hash broadphase compared to testing all pairs,
+ * and its scaling over worker threads.
+ * 
+ * @returns
+ * False if the broadphase pairs differ from the all pairs test, a collision was not dispatched
+ * or more threads changed the pairs.
+ */
+bool benchCollisions(const BenchSettings& settings);
+
+/**
+ * @brief
+ * Swept movement against the tile grid: corner cases at tile edges and the cost per moving object.
+ * 
+ * @returns
+ * False if a rectangle ended elsewhere than expected or a player went through a wall.
+ */
+bool benchSweep(const BenchSettings& settings);
+
+/**
+ * @brief
+ * Simulation cost of objects in a dense pool compared to objects allocated one by one, and pool handles.
+ * 
+ * @returns
+ * False if the pooled objects simulate differently or a handle reached the wrong object.
+ */
+bool benchPools(const BenchSettings& settings);
+
+#endif
@@ -0,0 +1,164 @@
+#include <cstdio>
+#include <boost/lexical_cast.hpp>
+#include "bench/Benchmark.h"
+#include "PrecisionClock.h"
+#include "Level.h"
+
+/**
+ * @brief
+ * Fills a level like a classic arena: wall pillars on every second cell and
+ * bricks on about a third of the remaining cells.
+ */
+static void generateArena(Level& level)
+{
+	unsigned int random = 12345;
+	for (int y = 0; y < level.height(); ++y)  {
+		for (int x = 0; x < level.width(); ++x)  {
+			random = random * 1103515245 + 12345;
+			if (x % 2 == 1 && y % 2 == 1)
+				level.setTile(x, y, TILE_WALL);
+			else if ((random >> 16) % 3 == 0)
+				level.setTile(x, y, TILE_BRICK);
+		}
+	}
+}
+
+/**
+ * @brief
+ * Blast zone found by walking the tiles one by one, the reference for Level::blastZone.
+ */
+static void walkBlastZone(const Level& level, int x, int y, int radius, BitPlane& zone)
+{
+	static const int directions[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+	zone.set(x, y);
+	for (int d = 0; d < 4; ++d)  {
+		for (int i = 1; i <= radius; ++i)  {
+			const int cx = x + directions[d][0] * i, cy = y + directions[d][1] * i;
+			if (!level.isInside(cx, cy))
+				break;
+
+			const Tile t = level.tile(cx, cy);
+			if (t.flags & TILE_FLAG_SOLID)  {
+				if (tileType(t.type).planes & (1 << TILE_PLANE_DESTRUCTIBLE))
+					zone.set(cx, cy);
+				break;
+			}
+			zone.set(cx, cy);
+		}
+	}
+}
+
+/**
+ * @brief
+ * Line of sight along a row found by walking the tiles, the reference for BitPlane::isRowClear.
+ */
+static bool walkRowClear(const Level& level, int y, int x1, int x2)
+{
+	const int step = x2 >= x1 ? 1 : -1;
+	for (int x = x1; x != x2 + step; x += step)  {
+		if (level.tile(x, y).flags & TILE_FLAG_SOLID)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * @brief
+ * Measures the plane queries against tile walks on one level size.
+ * 
+ * @returns
+ * False if a plane query disagrees with the tile walk.
+ */
+static bool benchBitPlaneCase(int size, unsigned int queries)
+{
+	const std::string caseName = "level " + boost::lexical_cast<std::string>(size) + "x" + boost::lexical_cast<std::string>(size);
+
+	Level level(size, size);
+	generateArena(level);
+
+	// The same pseudo random queries for both variants
+	std::vector<int> xs(queries), ys(queries), lengths(queries);
+	unsigned int random = 777;
+	for (unsigned int i = 0; i < queries; ++i)  {
+		random = random * 1103515245 + 12345;
+		xs[i] = (random >> 8) % size;
+		random = random * 1103515245 + 12345;
+		ys[i] = (random >> 8) % size;
+		random = random * 1103515245 + 12345;
+		lengths[i] = 1 + (random >> 8) % 64;
+	}
+
+	const BitPlane& solid = level.plane(TILE_PLANE_SOLID);
+	int clearPlane = 0, clearWalk = 0;
+	PrecisionClock clock;
+	for (unsigned int i = 0; i < queries; ++i)  {
+		const int x2 = xs[i] + lengths[i] < size ? xs[i] + lengths[i] : size - 1;
+		clearPlane += solid.isRowClear(ys[i], xs[i], x2) ? 1 : 0;
+	}
+	const double planeRowTime = clock.elapsed();
+
+	clock.reset();
+	for (unsigned int i = 0; i < queries; ++i)  {
+		const int x2 = xs[i] + lengths[i] < size ? xs[i] + lengths[i] : size - 1;
+		clearWalk += walkRowClear(level, ys[i], xs[i], x2) ? 1 : 0;
+	}
+	const double walkRowTime = clock.elapsed();
+
+	report("bitplane", caseName, "row clear, planes", planeRowTime * 1e9 / queries, "ns/query");
+	report("bitplane", caseName, "row clear, tile walk", walkRowTime * 1e9 / queries, "ns/query");
+
+	// Blast zones of large bombs, the radius is the query length
+	BitPlane planeZone, walkZone;
+	planeZone.resize(size, size);
+	walkZone.resize(size, size);
+
+	const boost::uint64_t allocs = allocationCount();
+	clock.reset();
+	for (unsigned int i = 0; i < queries; ++i)
+		level.blastZone(xs[i], ys[i], lengths[i], planeZone);
+	const double planeBlastTime = clock.elapsed();
+	const boost::uint64_t allocCount = allocationCount() - allocs;
+
+	clock.reset();
+	for (unsigned int i = 0; i < queries; ++i)
+		walkBlastZone(level, xs[i], ys[i], lengths[i], walkZone);
+	const double walkBlastTime = clock.elapsed();
+
+	report("bitplane", caseName, "blast zone, planes", planeBlastTime * 1e9 / queries, "ns/query");
+	report("bitplane", caseName, "blast zone, tile walk", walkBlastTime * 1e9 / queries, "ns/query");
+	report("bitplane", caseName, "allocs", (double)allocCount, "allocs");
+
+	// Column queries and the zones of single bombs are checked one by one
+	bool ok = clearPlane == clearWalk && planeZone == walkZone;
+	for (unsigned int i = 0; i < queries && i < 1000 && ok; ++i)  {
+		const int y2 = ys[i] - lengths[i] > 0 ? ys[i] - lengths[i] : 0;
+		bool columnClear = true;
+		for (int y = ys[i]; y >= y2; --y)
+			columnClear &= (level.tile(xs[i], y).flags & TILE_FLAG_SOLID) == 0;
+		ok = solid.isColumnClear(xs[i], ys[i], y2) == columnClear;
+
+		planeZone.clear();
+		walkZone.clear();
+		level.blastZone(xs[i], ys[i], lengths[i], planeZone);
+		walkBlastZone(level, xs[i], ys[i], lengths[i], walkZone);
+		ok = ok && planeZone == walkZone;
+	}
+	report("bitplane", caseName, "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+bool benchBitPlanes(const BenchSettings& settings)
+{
+	static const int sizes[] = { 42, 512, 2048 };
+	const unsigned int queries = 100000;
+
+	bool ok = true;
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)  {
+		if (sizes[s] > (int)settings.maxLevelSize)
+			break;
+
+		ok &= benchBitPlaneCase(sizes[s], queries);
+	}
+	return ok;
+}
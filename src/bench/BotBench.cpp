@@ -0,0 +1,343 @@
+#include <cstdio>
+#include <cstring>
+#include <boost/lexical_cast.hpp>
+#include "bench/Benchmark.h"
+#include "PrecisionClock.h"
+#include "World.h"
+#include "BotController.h"
+#include "Replay.h"
+#include "bots/SimpleBot.h"
+#include "events/PlayerActionEvent.h"
+#include "events/handlers/PlayerActionHandler.h"
+
+/**
+ * @brief
+ * Temporary file the bot games are recorded to.
+ */
+static const char *const BenchReplayFile = "bench_bots.uhkr";
+
+static const unsigned int TickRate = 60;
+
+/**
+ * @brief
+ * Bot that uses up its whole budget every tick and would walk right if its action was taken.
+ */
+class SlowBot : public Bot  {
+public:
+	PlayerAction think(const BotContext& context) override
+	{
+		while (!context.expired())
+			;
+		return PlayerAction(1, 0, false);
+	}
+};
+
+/**
+ * @brief
+ * Bot that ignores its budget and reads the world for twenty times as long.
+ */
+class StuckBot : public Bot  {
+public:
+	PlayerAction think(const BotContext& context) override
+	{
+		const Player& player = context.world().player(context.playerIndex());
+		float sum = 0;
+		while (context.elapsed() < context.budget() * 20)
+			sum += player.center().x;
+		return PlayerAction(sum > 0 ? 1 : -1, 0, false);
+	}
+};
+
+/**
+ * @brief
+ * Fills the level of a world with wall pillars and bricks and adds players at
+ * the fallback spawns of World::spawnPlayer, with free cells around them.
+ */
+static void generateWorld(World& world, int players)
+{
+	Level& level = world.level();
+	unsigned int random = 4711;
+	for (int y = 0; y < level.height(); ++y)  {
+		for (int x = 0; x < level.width(); ++x)  {
+			random = random * 1103515245 + 12345;
+			if (x % 2 == 1 && y % 2 == 1)
+				level.setTile(x, y, TILE_WALL);
+			else if ((random >> 16) % 3 == 0)
+				level.setTile(x, y, TILE_BRICK);
+		}
+	}
+
+	for (int i = 0; i < players; ++i)  {
+		const int index = world.spawnPlayer();
+		const sf::Vector2f center = world.player(index).center();
+		const int px = (int)(center.x / LEVEL_TILE_WIDTH), py = (int)(center.y / LEVEL_TILE_HEIGHT);
+		for (int y = py - 1; y <= py + 1; ++y)  {
+			for (int x = px - 1; x <= px + 1; ++x)  {
+				if (level.isInside(x, y) && level.tile(x, y).type == TILE_BRICK)
+					level.setTile(x, y, TILE_EMPTY);
+			}
+		}
+	}
+}
+
+/**
+ * @brief
+ * The replay settings of a bot game in a world before its first tick.
+ */
+static ReplaySettings gameSettings(const World& world, int bots)
+{
+	ReplaySettings settings;
+	settings.tickRate = TickRate;
+	settings.levelHash = world.level().hash();
+	settings.players = (unsigned int)world.playerCount();
+	settings.bots = bots;
+	return settings;
+}
+
+/**
+ * @brief
+ * Plays a recorded bot game back into a fresh world without bots, as Game::runReplay does.
+ * 
+ * @returns
+ * False if the replay was refused.
+ */
+static bool replayGame(World& world, int bots, int ticks)
+{
+	EventLoop loop;
+	loop.addHandler(new PlayerActionHandler(world));
+
+	ReplayReader replay;
+	if (!replay.open(BenchReplayFile, gameSettings(world, bots)))
+		return false;
+
+	unsigned int eventTick = 0;
+	EventPtr ev;
+	bool hasEvent = replay.next(eventTick, ev);
+	for (int t = 0; t < ticks; ++t)  {
+		loop.setTick(world.tick());
+		while (hasEvent && eventTick <= world.tick())  {
+			if (ev)
+				loop.pushEvent(ev);
+			hasEvent = replay.next(eventTick, ev);
+		}
+		loop.processPending();
+		world.simulate(1.0f / TickRate);
+	}
+	return true;
+}
+
+/**
+ * @brief
+ * Tries to play the recorded game back into a world that differs from the
+ * recorded one, with another bot count or another level.
+ * 
+ * @returns
+ * True if all of them were refused.
+ */
+static bool refuseOtherGames(int size, int bots)
+{
+	World world(size, size);
+	generateWorld(world, bots);
+	ReplayReader otherBots, otherLevel;
+	bool refused = !otherBots.open(BenchReplayFile, gameSettings(world, bots + 1));
+
+	world.level().setTile(0, 0, world.level().tile(0, 0).type == TILE_BRICK ? TILE_EMPTY : TILE_BRICK);
+	refused &= !otherLevel.open(BenchReplayFile, gameSettings(world, bots));
+	return refused && otherLevel.settings().bots == (unsigned int)bots;
+}
+
+/**
+ * @brief
+ * Plays a game of SimpleBots, records it and checks the replay ends in the same state.
+ * 
+ * @returns
+ * False if the replay diverged or the bots did not clear any bricks.
+ */
+static bool benchBotGame(int size, int bots, unsigned int ticks)
+{
+	const std::string caseName = "level " + boost::lexical_cast<std::string>(size) + "x" + boost::lexical_cast<std::string>(size)
+		+ " bots " + boost::lexical_cast<std::string>(bots);
+
+	World world(size, size);
+	generateWorld(world, bots);
+	const int bricks = world.level().plane(TILE_PLANE_DESTRUCTIBLE).count();
+
+	EventLoop loop;
+	loop.addHandler(new PlayerActionHandler(world));
+	ReplayWriter recorder;
+	recorder.open(BenchReplayFile, gameSettings(world, bots));
+	loop.setRecorder(&recorder);
+
+	BotController controller(0, 0.002);
+	for (int i = 0; i < bots; ++i)
+		controller.addBot(new SimpleBot(), i);
+
+	double thinkTime = 0, maxThinkTime = 0;
+	for (unsigned int t = 0; t < ticks; ++t)  {
+		loop.setTick(world.tick());
+		loop.process();
+		world.simulate(1.0f / TickRate);
+
+		PrecisionClock clock;
+		controller.think(world, loop);
+		const double elapsed = clock.elapsed();
+		thinkTime += elapsed;
+		if (elapsed > maxThinkTime)
+			maxThinkTime = elapsed;
+	}
+	loop.setRecorder(NULL);
+	recorder.close(world.tick());
+
+	double botTime = 0, botMaxTime = 0;
+	unsigned int overruns = 0;
+	for (int i = 0; i < bots; ++i)  {
+		botTime += controller.stats(i).averageTime();
+		botMaxTime = controller.stats(i).maxTime > botMaxTime ? controller.stats(i).maxTime : botMaxTime;
+		overruns += controller.stats(i).overruns;
+	}
+	const int cleared = bricks - world.level().plane(TILE_PLANE_DESTRUCTIBLE).count();
+
+	report("bots", caseName, "think per tick", thinkTime * 1e6 / ticks, "us");
+	report("bots", caseName, "think per tick, max", maxThinkTime * 1e6, "us");
+	report("bots", caseName, "bot think, average", botTime * 1e6 / bots, "us");
+	report("bots", caseName, "bot think, max", botMaxTime * 1e6, "us");
+	report("bots", caseName, "overruns", overruns, "ticks");
+	report("bots", caseName, "bricks cleared", cleared, "bricks");
+
+	// The replay drives the same players without bots and must end in the same state
+	World replayed(size, size);
+	generateWorld(replayed, bots);
+	const bool played = replayGame(replayed, bots, ticks);
+	const bool refused = refuseOtherGames(size, bots);
+	remove(BenchReplayFile);
+
+	StateBuffer expected, actual;
+	world.saveState(expected);
+	replayed.saveState(actual);
+	const bool ok = played && refused && cleared > 0 && expected.size() == actual.size() && memcmp(expected.data(), actual.data(), expected.size()) == 0;
+	report("bots", caseName, "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+/**
+ * @brief
+ * Bots that always exceed the budget next to ones that do not.
+ * 
+ * @returns
+ * False if an action of a late bot reached its player.
+ */
+static bool benchOverruns(unsigned int ticks)
+{
+	const int bots = 4;
+	const double budget = 0.0002;
+	World world(32, 32);
+	generateWorld(world, bots);
+
+	EventLoop loop;
+	loop.addHandler(new PlayerActionHandler(world));
+
+	// Every second bot is late
+	BotController controller(0, budget);
+	for (int i = 0; i < bots; ++i)
+		controller.addBot(i % 2 ? (Bot *) new SlowBot() : new SimpleBot(), i);
+
+	std::vector<sf::Vector2f> start;
+	for (int i = 0; i < bots; ++i)
+		start.push_back(world.player(i).center());
+
+	double maxThinkTime = 0;
+	for (unsigned int t = 0; t < ticks; ++t)  {
+		loop.setTick(world.tick());
+		loop.process();
+		world.simulate(1.0f / TickRate);
+
+		PrecisionClock clock;
+		controller.think(world, loop);
+		const double elapsed = clock.elapsed();
+		if (elapsed > maxThinkTime)
+			maxThinkTime = elapsed;
+	}
+
+	bool ok = true;
+	for (int i = 1; i < bots; i += 2)  {
+		const sf::Vector2f center = world.player(i).center();
+		ok &= controller.stats(i).overruns == controller.stats(i).thinks && center.x == start[i].x && center.y == start[i].y;
+	}
+
+	const std::string caseName = "budget " + boost::lexical_cast<std::string>((int)(budget * 1e6 + 0.5)) + " us, 2 of 4 late";
+	report("bots", caseName, "think per tick, max", maxThinkTime * 1e6, "us");
+	report("bots", caseName, "late bot think, max", controller.stats(1).maxTime * 1e6, "us");
+	report("bots", caseName, "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+/**
+ * @brief
+ * A bot that never returns in time next to SimpleBots.
+ * 
+ * @returns
+ * False if the tick waited for the stuck bot, it was asked while still
+ * thinking or its action reached its player.
+ */
+static bool benchStuckBot(unsigned int ticks)
+{
+	const int bots = 4;
+	const double budget = 0.0002;
+	World world(32, 32);
+	generateWorld(world, bots);
+
+	EventLoop loop;
+	loop.addHandler(new PlayerActionHandler(world));
+
+	BotController controller(0, budget);
+	for (int i = 0; i < bots; ++i)
+		controller.addBot(i == 1 ? (Bot *) new StuckBot() : new SimpleBot(), i);
+	const sf::Vector2f start = world.player(1).center();
+
+	double thinkTime = 0, maxThinkTime = 0;
+	for (unsigned int t = 0; t < ticks; ++t)  {
+		loop.setTick(world.tick());
+		loop.process();
+		world.simulate(1.0f / TickRate);
+
+		PrecisionClock clock;
+		controller.think(world, loop);
+		const double elapsed = clock.elapsed();
+		thinkTime += elapsed;
+		if (elapsed > maxThinkTime)
+			maxThinkTime = elapsed;
+	}
+
+	// The deadline is the budget times the rounds of bots per worker
+	const BotStats& stats = controller.stats(1);
+	const sf::Vector2f center = world.player(1).center();
+	const double deadline = budget * ((bots + controller.threadCount() - 1) / controller.threadCount());
+	const bool ok = stats.thinks + stats.skips == ticks && stats.skips > 0 && stats.overruns == stats.thinks
+		&& center.x == start.x && center.y == start.y && thinkTime / ticks < budget * 10 && thinkTime / ticks < deadline * 2;
+
+	const std::string caseName = "budget " + boost::lexical_cast<std::string>((int)(budget * 1e6 + 0.5)) + " us, 1 of 4 stuck";
+	report("bots", caseName, "think per tick", thinkTime * 1e6 / ticks, "us");
+	report("bots", caseName, "think per tick, max", maxThinkTime * 1e6, "us");
+	report("bots", caseName, "deadline", deadline * 1e6, "us");
+	report("bots", caseName, "stuck bot skipped", stats.skips, "ticks");
+	report("bots", caseName, "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+bool benchBots(const BenchSettings& settings)
+{
+	// Level size and bot count, the fallback spawns fit size / 4 players in a row
+	static const int cases[][2] = { { 32, 4 }, { 64, 4 }, { 64, 16 } };
+	const unsigned int ticks = settings.ticks > 600 ? settings.ticks : 600;
+
+	bool ok = true;
+	for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c)  {
+		if (cases[c][0] > (int)settings.maxLevelSize)
+			break;
+
+		ok &= benchBotGame(cases[c][0], cases[c][1], ticks);
+	}
+	ok &= benchOverruns(settings.ticks);
+	ok &= benchStuckBot(settings.ticks);
+	return ok;
+}
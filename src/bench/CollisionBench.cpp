@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include "bench/Benchmark.h"
+#include "PrecisionClock.h"
+#include "World.h"
+#include "CollidableObject.h"
+#include "ThreadPool.h"
+
+/**
+ * @brief
+ * Tile sized object flying in a straight line and bouncing off the level borders.
+ * Counts its collisions, which tells the dispatch reached it.
+ */
+class Mover : public CollidableObject<Mover>  {
+private:
+	float m_vx, m_vy, m_limitX, m_limitY;
+	unsigned int m_contacts;
+
+public:
+	static const unsigned char CollisionType = COLLISION_TYPE_USER;
+
+	Mover(float x, float y, float vx, float vy, float limitX, float limitY) :
+		CollidableObject<Mover>(x, y, LEVEL_TILE_WIDTH, LEVEL_TILE_HEIGHT), m_vx(vx), m_vy(vy), m_limitX(limitX), m_limitY(limitY), m_contacts(0) {}
+
+	static bool collide(Mover& first, Mover& second)
+	{
+		++first.m_contacts;
+		++second.m_contacts;
+		return true;
+	}
+
+	unsigned int contacts() const { return m_contacts; }
+
+	void simulate(DeltaTime dt) override
+	{
+		m_x += m_vx * dt;
+		m_y += m_vy * dt;
+		if (m_x < 0 || m_x + m_width > m_limitX)  {
+			m_vx = -m_vx;
+			m_x = m_x < 0 ? 0 : m_limitX - m_width;
+		}
+		if (m_y < 0 || m_y + m_height > m_limitY)  {
+			m_vy = -m_vy;
+			m_y = m_y < 0 ? 0 : m_limitY - m_height;
+		}
+	}
+
+	void render(sf::RenderTarget& target, DeltaTime dt, float alpha) override {}
+};
+
+/**
+ * @brief
+ * Level side giving about 16 tiles per object.
+ */
+static int levelSize(unsigned int objects)
+{
+	return (int)ceil(sqrt(objects * 16.0));
+}
+
+/**
+ * @brief
+ * Adds movers at pseudo random positions and velocities, the same for every world of the size.
+ */
+static void addMovers(World& world, unsigned int objects)
+{
+	const float limit = (float)(world.level().width() * LEVEL_TILE_WIDTH);
+	unsigned int random = 99;
+	for (unsigned int i = 0; i < objects; ++i)  {
+		float values[4];
+		for (int v = 0; v < 4; ++v)  {
+			random = random * 1103515245 + 12345;
+			values[v] = ((random >> 8) & 0xFFFF) / 65536.0f;
+		}
+		world.addObject(new Mover(values[0] * (limit - LEVEL_TILE_WIDTH), values[1] * (limit - LEVEL_TILE_HEIGHT),
+			(values[2] - 0.5f) * 8 * LEVEL_TILE_WIDTH, (values[3] - 0.5f) * 8 * LEVEL_TILE_HEIGHT, limit, limit));
+	}
+}
+
+/**
+ * @brief
+ * Overlapping pairs found by testing every object against every other one, the reference for World::collideObjects.
+ */
+static void bruteForcePairs(const World& world, std::vector<ObjectPair>& pairs)
+{
+	pairs.clear();
+	const int count = (int)world.objectCount();
+	for (int i = 0; i < count; ++i)  {
+		const GameObject& first = world.object(i);
+		for (int j = i + 1; j < count; ++j)  {
+			if (first.overlaps(world.object(j)))
+				pairs.push_back(ObjectPair(i, j));
+		}
+	}
+}
+
+/**
+ * @brief
+ * Measures the collision pass with a given number of objects, at about 16 tiles per object.
+ * 
+ * @returns
+ * False if the broadphase missed or invented a pair or a collision was not dispatched.
+ */
+static bool benchCollisionCase(unsigned int objects, unsigned int ticks)
+{
+	const DeltaTime dt = 1.0f / 60;
+	const int size = levelSize(objects);
+	const std::string caseName = "level " + boost::lexical_cast<std::string>(size) + "x" + boost::lexical_cast<std::string>(size)
+		+ " objects " + boost::lexical_cast<std::string>(objects);
+
+	World world(size, size);
+	addMovers(world, objects);
+
+	// Warm up the broadphase vectors
+	world.simulateObjects(dt);
+	world.collideObjects();
+	const size_t warmUpPairs = world.collisionPairs().size();
+
+	std::vector<ObjectPair> reference, found;
+	double hashTime = 0, bruteTime = 0;
+	size_t pairCount = 0;
+	boost::uint64_t allocCount = 0;
+	bool ok = true;
+	for (unsigned int t = 0; t < ticks; ++t)  {
+		world.simulateObjects(dt);
+
+		const boost::uint64_t allocs = allocationCount();
+		PrecisionClock clock;
+		world.collideObjects();
+		hashTime += clock.elapsed();
+		allocCount += allocationCount() - allocs;
+		pairCount += world.collisionPairs().size();
+
+		clock.reset();
+		bruteForcePairs(world, reference);
+		bruteTime += clock.elapsed();
+
+		found = world.collisionPairs();
+		std::sort(found.begin(), found.end());
+		ok = ok && found == reference;
+	}
+
+	// Every overlap is dispatched to both objects, the warm up ones included
+	size_t contacts = 0, dispatched = warmUpPairs + pairCount;
+	for (size_t i = 0; i < world.objectCount(); ++i)
+		contacts += static_cast<const Mover&>(world.object((int)i)).contacts();
+	ok = ok && contacts == 2 * dispatched;
+
+	// Dispatch alone, the pairs of the last tick over and over
+	const std::vector<ObjectPair>& pairs = world.collisionPairs();
+	const unsigned int repeats = 1000;
+	PrecisionClock clock;
+	for (unsigned int r = 0; r < repeats; ++r)  {
+		for (auto it = pairs.begin(); it != pairs.end(); ++it)
+			CollisionTable::collide(world.object(it->first), world.object(it->second));
+	}
+	const double dispatchTime = clock.elapsed();
+
+	report("collision", caseName, "spatial hash", hashTime * 1e9 / ticks / objects, "ns/object");
+	report("collision", caseName, "brute force", bruteTime * 1e9 / ticks / objects, "ns/object");
+	report("collision", caseName, "overlaps", (double)pairCount / ticks, "pairs/tick");
+	report("collision", caseName, "cell entries", (double)world.broadphase().entryCount() / objects, "entries/object");
+	report("collision", caseName, "dispatch", pairs.empty() ? 0 : dispatchTime * 1e9 / repeats / pairs.size(), "ns/pair");
+	report("collision", caseName, "allocs", (double)allocCount / ticks, "allocs/tick");
+	report("collision", caseName, "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+/**
+ * @brief
+ * Measures collideObjects on a number of worker threads.
+ * 
+ * @param checksum
+ * Checksum of the collision pairs of all ticks in their order (output), equal for every thread count when the result is deterministic.
+ * 
+ * @returns
+ * Time of the collision pass per tick, in seconds.
+ */
+static double runCollisionThreads(unsigned int objects, unsigned int threads, unsigned int ticks, boost::uint64_t& checksum)
+{
+	const DeltaTime dt = 1.0f / 60;
+	const int size = levelSize(objects);
+	World world(size, size);
+	addMovers(world, objects);
+
+	ThreadPool pool(threads);
+	if (threads > 1)
+		world.setCollisionPool(&pool);
+
+	world.simulateObjects(dt);
+	world.collideObjects();
+
+	double time = 0;
+	checksum = 0;
+	for (unsigned int t = 0; t < ticks; ++t)  {
+		world.simulateObjects(dt);
+
+		PrecisionClock clock;
+		world.collideObjects();
+		time += clock.elapsed();
+
+		const std::vector<ObjectPair>& pairs = world.collisionPairs();
+		for (auto it = pairs.begin(); it != pairs.end(); ++it)
+			checksum = checksum * 1000003 + (boost::uint64_t)it->first * 65537 + it->second;
+	}
+
+	// The contact counts tell every handler call happened, whatever the thread count
+	for (size_t i = 0; i < world.objectCount(); ++i)
+		checksum = checksum * 31 + static_cast<const Mover&>(world.object((int)i)).contacts();
+
+	world.setCollisionPool(NULL);
+	return time / ticks;
+}
+
+/**
+ * @brief
+ * Speedup of the parallel collision pass over the single threaded one.
+ * 
+ * @returns
+ * False if a thread count gave other pairs than one thread.
+ */
+static bool benchCollisionThreads(unsigned int objects, unsigned int ticks)
+{
+	static const unsigned int threadCounts[] = { 1, 2, 4, 8 };
+	const std::string caseName = "objects " + boost::lexical_cast<std::string>(objects);
+
+	bool ok = true;
+	boost::uint64_t reference = 0;
+	double singleTime = 0;
+	for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t)  {
+		boost::uint64_t checksum = 0;
+		const double time = runCollisionThreads(objects, threadCounts[t], ticks, checksum);
+		if (t == 0)  {
+			reference = checksum;
+			singleTime = time;
+		}
+		ok &= checksum == reference;
+
+		const std::string threads = " threads " + boost::lexical_cast<std::string>(threadCounts[t]);
+		report("collision", caseName + threads, "collide", time * 1e6, "us/tick");
+		report("collision", caseName + threads, "speedup", time > 0 ? singleTime / time : 0, "x");
+	}
+	report("collision", caseName, "deterministic", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+bool benchCollisions(const BenchSettings& settings)
+{
+	static const unsigned int objectCounts[] = { 100, 400, 1600, 6400 };
+	CollisionTable::add<Mover, Mover>();
+
+	bool ok = true;
+	for (size_t c = 0; c < sizeof(objectCounts) / sizeof(objectCounts[0]); ++c)  {
+		// Always measure a few hundred objects, the brute force reference limits the rest
+		if (c > 1 && objectCounts[c] > settings.maxObjects)
+			break;
+
+		ok &= benchCollisionCase(objectCounts[c], settings.ticks);
+	}
+
+	static const unsigned int threadedCounts[] = { 1600, 12800 };
+	for (size_t c = 0; c < sizeof(threadedCounts) / sizeof(threadedCounts[0]); ++c)  {
+		if (c > 0 && threadedCounts[c] > settings.maxObjects)
+			break;
+
+		ok &= benchCollisionThreads(threadedCounts[c], settings.ticks);
+	}
+	return ok;
+}
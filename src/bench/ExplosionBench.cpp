@@ -0,0 +1,193 @@
+#include <cstdio>
+#include <deque>
+#include <boost/lexical_cast.hpp>
+#include "bench/Benchmark.h"
+#include "PrecisionClock.h"
+#include "Level.h"
+#include "tiles/BombTile.h"
+
+/**
+ * @brief
+ * Fills a level with wall pillars on every second cell and, optionally, bricks
+ * on about a third of the remaining cells.
+ */
+static void generateLevel(Level& level, bool bricks)
+{
+	unsigned int random = 4242;
+	for (int y = 0; y < level.height(); ++y)  {
+		for (int x = 0; x < level.width(); ++x)  {
+			random = random * 1103515245 + 12345;
+			if (x % 2 == 1 && y % 2 == 1)
+				level.setTile(x, y, TILE_WALL);
+			else if (bricks && (random >> 16) % 3 == 0)
+				level.setTile(x, y, TILE_BRICK);
+		}
+	}
+}
+
+/**
+ * @brief
+ * Places bombs on free cells, either scattered randomly or packed into a grid
+ * where each bomb reaches its neighbours.
+ * 
+ * @returns
+ * Indices (y * width + x) of the bombs in placement order.
+ */
+static std::vector<int> placeBombs(Level& level, int bombs, int radius, bool grid)
+{
+	std::vector<int> placed;
+	unsigned int random = 99;
+	for (int i = 0; (int)placed.size() < bombs && i < bombs * 100; ++i)  {
+		int x, y;
+		if (grid)  {
+			x = (i * 4) % level.width();
+			y = ((i * 4) / level.width()) * 2;
+		} else  {
+			random = random * 1103515245 + 12345;
+			x = (random >> 8) % level.width();
+			random = random * 1103515245 + 12345;
+			y = (random >> 8) % level.height();
+		}
+		if (y >= level.height() || level.tile(x, y).type != TILE_EMPTY)
+			continue;
+
+		BombTile::place(level, x, y, radius);
+		placed.push_back(y * level.width() + x);
+	}
+	return placed;
+}
+
+/**
+ * @brief
+ * Reference of the explosion engine: the same queue order, but every blast
+ * walks the tiles cell by cell instead of scanning the planes.
+ */
+static void walkExplosions(Level& level, const std::vector<int>& fused)
+{
+	static const int directions[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+	std::deque<std::pair<int, int> > queue;
+	for (size_t i = 0; i < fused.size(); ++i)  {
+		const int x = fused[i] % level.width(), y = fused[i] / level.width();
+		if (level.tile(x, y).type != TILE_BOMB)
+			continue;
+		queue.push_back(std::make_pair(fused[i], BombTile::radius(level.tile(x, y))));
+		level.setTile(x, y, TILE_FLAME);
+	}
+
+	while (!queue.empty())  {
+		const int x = queue.front().first % level.width(), y = queue.front().first / level.width();
+		const int radius = queue.front().second;
+		queue.pop_front();
+
+		// Find the arms first, the blast is applied to the level as it was when the bomb exploded
+		int reach[4];
+		for (int d = 0; d < 4; ++d)  {
+			reach[d] = 0;
+			for (int i = 1; i <= radius; ++i)  {
+				const int cx = x + directions[d][0] * i, cy = y + directions[d][1] * i;
+				if (!level.isInside(cx, cy))
+					break;
+
+				const Tile t = level.tile(cx, cy);
+				if (t.flags & TILE_FLAG_SOLID)  {
+					if (t.type == TILE_BRICK || t.type == TILE_BOMB)
+						reach[d] = i;
+					break;
+				}
+				reach[d] = i;
+			}
+		}
+
+		// Same cell order as the engine: the row from left to right, then the column from top to bottom
+		for (int i = -reach[1]; i <= reach[0]; ++i)  {
+			const int cx = x + i;
+			if (level.tile(cx, y).type == TILE_BOMB)  {
+				queue.push_back(std::make_pair(y * level.width() + cx, BombTile::radius(level.tile(cx, y))));
+			}
+			level.setTile(cx, y, TILE_FLAME);
+		}
+		for (int i = -reach[3]; i <= reach[2]; ++i)  {
+			const int cy = y + i;
+			if (i == 0)
+				continue;
+			if (level.tile(x, cy).type == TILE_BOMB)
+				queue.push_back(std::make_pair(cy * level.width() + x, BombTile::radius(level.tile(x, cy))));
+			level.setTile(x, cy, TILE_FLAME);
+		}
+	}
+}
+
+/**
+ * @brief
+ * Measures the tick in which a number of bombs explode.
+ * 
+ * @param chain
+ * False: the bombs are scattered and all their fuses end in the measured tick.
+ * True: the bombs form a grid, one is detonated and the rest explode in a chain reaction.
+ * 
+ * @returns
+ * False if the explosions did not leave the same level as the reference.
+ */
+static bool benchExplosionCase(int size, int bombs, bool chain)
+{
+	const DeltaTime dt = 1.0f / 60;
+	const int radius = 4;
+	const std::string caseName = "level " + boost::lexical_cast<std::string>(size) + "x" + boost::lexical_cast<std::string>(size)
+		+ " bombs " + boost::lexical_cast<std::string>(bombs) + (chain ? " chain" : " fuse");
+
+	Level level(size, size), reference(size, size);
+	generateLevel(level, !chain);
+	generateLevel(reference, !chain);
+	const std::vector<int> placed = placeBombs(level, bombs, radius, chain);
+	placeBombs(reference, bombs, radius, chain);
+
+	// Burn the fuses down to the last tick, chains are started by hand instead
+	if (!chain)  {
+		for (unsigned int i = 0; i < BombTile::FuseTicks - 1; ++i)
+			level.simulate(dt);
+	}
+
+	const boost::uint64_t allocs = allocationCount();
+	PrecisionClock clock;
+	if (chain)
+		level.detonate(placed[0] % size, placed[0] / size);
+	level.simulate(dt);
+	const double time = clock.elapsed();
+	const boost::uint64_t allocCount = allocationCount() - allocs;
+	const int exploded = (int)placed.size() - level.plane(TILE_PLANE_BOMB).count();
+
+	clock.reset();
+	walkExplosions(reference, chain ? std::vector<int>(placed.begin(), placed.begin() + 1) : placed);
+	const double walkTime = clock.elapsed();
+
+	report("explosion", caseName, "exploded", exploded, "bombs");
+	report("explosion", caseName, "tick", time * 1000, "ms");
+	report("explosion", caseName, "tick share", time * 100 / dt, "% of tick");
+	report("explosion", caseName, "per bomb", exploded > 0 ? time * 1e9 / exploded : 0, "ns/bomb");
+	report("explosion", caseName, "tile walk", walkTime * 1000, "ms");
+	report("explosion", caseName, "allocs", (double)allocCount, "allocs");
+
+	bool ok = exploded == (int)placed.size() || chain;
+	for (int y = 0; y < size && ok; ++y)  {
+		for (int x = 0; x < size && ok; ++x)
+			ok = level.tile(x, y).type == reference.tile(x, y).type;
+	}
+	ok = ok && level.plane(TILE_PLANE_FLAME) == reference.plane(TILE_PLANE_FLAME)
+		&& level.plane(TILE_PLANE_SOLID) == reference.plane(TILE_PLANE_SOLID);
+	report("explosion", caseName, "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+bool benchExplosions(const BenchSettings& settings)
+{
+	static const int bombCounts[] = { 100, 500, 2000 };
+	const int size = 256;
+
+	bool ok = true;
+	for (size_t b = 0; b < sizeof(bombCounts) / sizeof(bombCounts[0]); ++b)  {
+		ok &= benchExplosionCase(size, bombCounts[b], false);
+		ok &= benchExplosionCase(size, bombCounts[b], true);
+	}
+	return ok;
+}
@@ -0,0 +1,246 @@
+#include <cstdio>
+#include <boost/lexical_cast.hpp>
+#include "bench/Benchmark.h"
+#include "PrecisionClock.h"
+#include "Level.h"
+#include "tiles/BombTile.h"
+
+/**
+ * @brief
+ * Number of distance fields, one per player of a tournament match.
+ */
+static const int FieldCount = 4;
+
+/**
+ * @brief
+ * Fills a level with wall pillars on every second cell and bricks on about a
+ * third of the remaining cells, the corners are left free for the players.
+ */
+static void generateLevel(Level& level)
+{
+	unsigned int random = 2024;
+	for (int y = 0; y < level.height(); ++y)  {
+		for (int x = 0; x < level.width(); ++x)  {
+			random = random * 1103515245 + 12345;
+			const bool corner = (x < 3 || x >= level.width() - 3) && (y < 3 || y >= level.height() - 3);
+			if (x % 2 == 1 && y % 2 == 1)
+				level.setTile(x, y, TILE_WALL);
+			else if (!corner && (random >> 16) % 3 == 0)
+				level.setTile(x, y, TILE_BRICK);
+		}
+	}
+}
+
+/**
+ * @brief
+ * Walks the blast arms of all bombs over the tiles. Bombs pass their explosion
+ * tick on to the bombs they reach, with danger given the cells are marked with
+ * the tick they explode in.
+ * 
+ * @returns
+ * True if the explosion tick of a bomb changed.
+ */
+static bool walkBlasts(const Level& level, const std::vector<int>& bombs, std::vector<int>& explodeAt, std::vector<int> *danger)
+{
+	static const int directions[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+	const int width = level.width();
+
+	bool changed = false;
+	for (size_t b = 0; b < bombs.size(); ++b)  {
+		const int x = bombs[b] % width, y = bombs[b] / width, at = explodeAt[bombs[b]];
+		const int radius = BombTile::radius(level.tile(x, y));
+		if (danger && ((*danger)[bombs[b]] < 0 || at < (*danger)[bombs[b]]))
+			(*danger)[bombs[b]] = at;
+
+		for (int d = 0; d < 4; ++d)  {
+			for (int i = 1; i <= radius; ++i)  {
+				const int cx = x + directions[d][0] * i, cy = y + directions[d][1] * i, cell = cy * width + cx;
+				if (!level.isInside(cx, cy))
+					break;
+
+				const Tile t = level.tile(cx, cy);
+				const bool stops = (t.flags & TILE_FLAG_SOLID) != 0, burns = !stops || t.type == TILE_BRICK || t.type == TILE_BOMB;
+				if (burns && danger && ((*danger)[cell] < 0 || at < (*danger)[cell]))
+					(*danger)[cell] = at;
+				if (t.type == TILE_BOMB && at < explodeAt[cell])  {
+					explodeAt[cell] = at;
+					changed = true;
+				}
+				if (stops)
+					break;
+			}
+		}
+	}
+	return changed;
+}
+
+/**
+ * @brief
+ * Ticks until each cell explodes (-1 for safe cells), computed by walking the tiles.
+ */
+static void walkDanger(const Level& level, unsigned int tick, std::vector<int>& danger)
+{
+	const int width = level.width(), height = level.height();
+	std::vector<int> bombs, explodeAt(width * height, -1);
+	for (int i = 0; i < width * height; ++i)  {
+		const Tile t = level.tile(i % width, i / width);
+		if (t.type == TILE_BOMB)  {
+			bombs.push_back(i);
+			explodeAt[i] = (int)(tick + BombTile::FuseTicks - t.state);
+		}
+	}
+
+	// Settle the chains first, then mark the blast zones
+	while (walkBlasts(level, bombs, explodeAt, NULL))
+		;
+	danger.assign(width * height, -1);
+	walkBlasts(level, bombs, explodeAt, &danger);
+
+	for (size_t i = 0; i < danger.size(); ++i)
+		danger[i] = danger[i] < 0 ? -1 : danger[i] - (int)tick;
+}
+
+/**
+ * @brief
+ * Walking distances from a cell, computed by a plain breadth-first search over the tiles.
+ */
+static void walkDistances(const Level& level, int sourceX, int sourceY, std::vector<int>& distances)
+{
+	const int width = level.width(), height = level.height();
+	distances.assign(width * height, -1);
+	std::vector<int> queue(1, sourceY * width + sourceX);
+	distances[queue[0]] = 0;
+	for (size_t q = 0; q < queue.size(); ++q)  {
+		const int x = queue[q] % width, y = queue[q] / width;
+		const int neighbours[4][2] = { { x + 1, y }, { x - 1, y }, { x, y + 1 }, { x, y - 1 } };
+		for (int n = 0; n < 4; ++n)  {
+			const int nx = neighbours[n][0], ny = neighbours[n][1];
+			if (level.isInside(nx, ny) && distances[ny * width + nx] < 0 && (level.tile(nx, ny).flags & TILE_FLAG_SOLID) == 0)  {
+				distances[ny * width + nx] = distances[queue[q]] + 1;
+				queue.push_back(ny * width + nx);
+			}
+		}
+	}
+}
+
+/**
+ * @brief
+ * Compares the fields of the level with fields computed by walking the tiles.
+ */
+static bool verifyFields(const Level& level, unsigned int tick)
+{
+	std::vector<int> expected;
+	walkDanger(level, tick, expected);
+	for (int i = 0; i < level.width() * level.height(); ++i)  {
+		if (level.danger().ticksToExplosion(i % level.width(), i / level.width()) != expected[i])
+			return false;
+	}
+
+	for (int f = 0; f < FieldCount; ++f)  {
+		const DistanceField& field = level.distances(f);
+		walkDistances(level, field.sourceX(), field.sourceY(), expected);
+		for (int i = 0; i < level.width() * level.height(); ++i)  {
+			if (field.distance(i % level.width(), i / level.width()) != expected[i])
+				return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief
+ * Measures the field updates of a match where bombs are placed every tick.
+ * 
+ * @param bombsPerTick
+ * Bombs placed on random free cells each tick, the level holds about
+ * bombsPerTick * BombTile::FuseTicks bombs once the first ones explode.
+ * 
+ * @returns
+ * False if the fields differ from the fields computed by walking the tiles.
+ */
+static bool benchFieldCase(int size, int bombsPerTick, unsigned int ticks)
+{
+	const DeltaTime dt = 1.0f / 60;
+	const std::string caseName = "level " + boost::lexical_cast<std::string>(size) + "x" + boost::lexical_cast<std::string>(size)
+		+ " bombs/tick " + boost::lexical_cast<std::string>(bombsPerTick);
+
+	Level level(size, size);
+	generateLevel(level);
+	const int sources[FieldCount][2] = { { 0, 0 }, { size - 1, 0 }, { 0, size - 1 }, { size - 1, size - 1 } };
+	for (int f = 0; f < FieldCount; ++f)  {
+		level.addDistanceField();
+		level.setDistanceSource(f, sources[f][0], sources[f][1]);
+	}
+	level.updateFields(0);
+
+	// The same fields computed from scratch every tick, what the bots did before
+	DangerField fullDanger;
+	std::vector<DistanceField> fullDistances(FieldCount);
+	fullDanger.resize(size, size);
+	for (int f = 0; f < FieldCount; ++f)  {
+		fullDistances[f].resize(size, size);
+		fullDistances[f].setSource(sources[f][0], sources[f][1]);
+	}
+
+	unsigned int random = 31337;
+	double incrementalTime = 0, fullTime = 0;
+	bool ok = true;
+	PrecisionClock clock;
+	for (unsigned int tick = 1; tick <= ticks; ++tick)  {
+		for (int i = 0; i < bombsPerTick; ++i)  {
+			random = random * 1103515245 + 12345;
+			const int x = (random >> 8) % size;
+			random = random * 1103515245 + 12345;
+			const int y = (random >> 8) % size;
+			if (level.tile(x, y).type == TILE_EMPTY)
+				BombTile::place(level, x, y, 2 + (random >> 4) % 5);
+		}
+		level.simulate(dt);
+
+		clock.reset();
+		level.updateFields(tick);
+		incrementalTime += clock.elapsed();
+
+		clock.reset();
+		fullDanger.invalidateAll();
+		fullDanger.update(level, tick);
+		for (int f = 0; f < FieldCount; ++f)  {
+			fullDistances[f].invalidateAll();
+			fullDistances[f].update(level);
+		}
+		fullTime += clock.elapsed();
+
+		if (tick % 16 == 0 || tick == ticks)
+			ok = ok && verifyFields(level, tick);
+	}
+
+	int threatened = 0;
+	for (int y = 0; y < size; ++y)  {
+		for (int x = 0; x < size; ++x)
+			threatened += level.danger().isThreatened(x, y) ? 1 : 0;
+	}
+
+	report("fields", caseName, "incremental", incrementalTime * 1e6 / ticks, "us/tick");
+	report("fields", caseName, "from scratch", fullTime * 1e6 / ticks, "us/tick");
+	report("fields", caseName, "threatened cells", threatened, "cells");
+	report("fields", caseName, "fields.memory", (level.danger().memoryUsage() + level.distances(0).memoryUsage() * FieldCount) / 1024.0, "KiB");
+	report("fields", caseName, "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+bool benchFields(const BenchSettings& settings)
+{
+	static const int sizes[] = { 64, 256 };
+	static const int bombCounts[] = { 1, 4 };
+	const unsigned int ticks = settings.ticks > BombTile::FuseTicks * 2 ? settings.ticks : BombTile::FuseTicks * 2;
+
+	bool ok = true;
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)  {
+		if (sizes[s] > (int)settings.maxLevelSize)
+			break;
+
+		for (size_t b = 0; b < sizeof(bombCounts) / sizeof(bombCounts[0]); ++b)
+			ok &= benchFieldCase(sizes[s], bombCounts[b], ticks);
+	}
+	return ok;
+}
@@ -0,0 +1,116 @@
+#include <cstdio>
+#include <boost/lexical_cast.hpp>
+#include "bench/Benchmark.h"
+#include "PrecisionClock.h"
+#include "Level.h"
+#include "LevelFile.h"
+
+/**
+ * @brief
+ * Temporary file the generated levels are written to.
+ */
+static const char *const BenchLevelFile = "bench_level.uhkl";
+
+/**
+ * @brief
+ * Generates a level with solid borders, scattered solid tiles and large empty areas.
+ */
+static void generateLevel(int size, LevelDescription& level)
+{
+	level.width = size;
+	level.height = size;
+	level.tiles.resize(size * size);
+	for (int y = 0; y < size; ++y)  {
+		for (int x = 0; x < size; ++x)  {
+			Tile& tile = level.tiles[y * size + x];
+			const bool border = x == 0 || y == 0 || x == size - 1 || y == size - 1;
+			const bool pillar = (x % 2 == 0 && y % 2 == 0 && (x / 64 + y / 64) % 2 == 0);
+			tile.type = TILE_EMPTY;
+			tile.flags = border || pillar ? TILE_FLAG_SOLID : TILE_FLAG_NONE;
+			tile.state = 0;
+		}
+	}
+
+	LevelSpawn spawn = { 1, 1 };
+	level.spawns.push_back(spawn);
+	level.metadata["name"] = "bench";
+}
+
+/**
+ * @brief
+ * Checks that the loaded level contains the generated tiles and that the solid
+ * plane matches them.
+ */
+static bool verifyLevel(const Level& level, const LevelDescription& description)
+{
+	if (level.width() != description.width || level.height() != description.height)
+		return false;
+
+	for (int y = 0; y < level.height(); ++y)  {
+		for (int x = 0; x < level.width(); ++x)  {
+			const Tile loaded = level.tile(x, y), expected = description.tiles[y * description.width + x];
+			if (loaded.type != expected.type || loaded.flags != expected.flags)
+				return false;
+			if (level.isSolid(x, y) != ((expected.flags & TILE_FLAG_SOLID) != 0))
+				return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief
+ * Measures loading of one level size.
+ * 
+ * @param packDistance
+ * See Level::setPackDistance, with packing enabled the chunks stay packed after loading.
+ */
+static bool benchLevelFileCase(int size, int packDistance)
+{
+	const std::string caseName = "level " + boost::lexical_cast<std::string>(size) + "x" + boost::lexical_cast<std::string>(size)
+		+ (packDistance > 0 ? " packed" : "");
+
+	LevelDescription description;
+	generateLevel(size, description);
+	PrecisionClock clock;
+	if (!writeLevelFile(BenchLevelFile, description))  {
+		fprintf(stderr, "levelfile %s: cannot write %s\n", caseName.c_str(), BenchLevelFile);
+		return false;
+	}
+	report("levelfile", caseName, "compile", clock.elapsed() * 1000, "ms");
+
+	Level level(1, 1);
+	level.setPackDistance(packDistance);
+
+	const boost::uint64_t allocs = allocationCount();
+	clock.reset();
+	LevelFileReader file;
+	const bool loaded = file.open(BenchLevelFile) && level.load(file);
+	const double loadTime = clock.elapsed();
+	const boost::uint64_t allocCount = allocationCount() - allocs;
+
+	const bool ok = loaded && verifyLevel(level, description) && file.spawnCount() == 1 && file.metadata("name") == "bench";
+	report("levelfile", caseName, "load", loadTime * 1000, "ms");
+	report("levelfile", caseName, "allocs", (double)allocCount, "allocs");
+	report("levelfile", caseName, "level.memory", level.memoryUsage() / 1024.0, "KiB");
+	report("levelfile", caseName, "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+
+	file.close();
+	remove(BenchLevelFile);
+	return ok;
+}
+
+bool benchLevelFile(const BenchSettings& settings)
+{
+	static const int sizes[] = { 42, 128, 512, 1024, 2048, 4096 };
+
+	bool ok = true;
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)  {
+		if (sizes[s] > (int)settings.maxLevelSize)
+			break;
+
+		ok &= benchLevelFileCase(sizes[s], 0);
+		ok &= benchLevelFileCase(sizes[s], 8);
+	}
+	return ok;
+}
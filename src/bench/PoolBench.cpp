@@ -0,0 +1,188 @@
+#include <cstring>
+#include <boost/lexical_cast.hpp>
+#include "bench/Benchmark.h"
+#include "PrecisionClock.h"
+#include "World.h"
+#include "ObjectPool.h"
+
+/**
+ * @brief
+ * Small short lived object, such as a spark of an explosion: flies, slows down and bounces off the level borders.
+ */
+class Spark : public GameObject  {
+private:
+	float m_vx, m_vy, m_limitX, m_limitY;
+
+public:
+	Spark(float x, float y, float vx, float vy, float limitX, float limitY) :
+		GameObject(x, y, 4, 4), m_vx(vx), m_vy(vy), m_limitX(limitX), m_limitY(limitY) {}
+
+	void simulate(DeltaTime dt) override
+	{
+		m_vx -= m_vx * 0.5f * dt;
+		m_vy -= m_vy * 0.5f * dt;
+		m_x += m_vx * dt;
+		m_y += m_vy * dt;
+		if (m_x < 0 || m_x + m_width > m_limitX)  {
+			m_vx = -m_vx;
+			m_x = m_x < 0 ? 0 : m_limitX - m_width;
+		}
+		if (m_y < 0 || m_y + m_height > m_limitY)  {
+			m_vy = -m_vy;
+			m_y = m_y < 0 ? 0 : m_limitY - m_height;
+		}
+	}
+
+	void render(sf::RenderTarget& target, DeltaTime dt, float alpha) override {}
+};
+
+/**
+ * @brief
+ * The sparks of a case, the same for every world.
+ */
+static std::vector<Spark> makeSparks(unsigned int count, float limit)
+{
+	std::vector<Spark> sparks;
+	unsigned int random = 1234;
+	for (unsigned int i = 0; i < count; ++i)  {
+		float values[4];
+		for (int v = 0; v < 4; ++v)  {
+			random = random * 1103515245 + 12345;
+			values[v] = ((random >> 8) & 0xFFFF) / 65536.0f;
+		}
+		sparks.push_back(Spark(values[0] * limit, values[1] * limit, (values[2] - 0.5f) * 400, (values[3] - 0.5f) * 400, limit, limit));
+	}
+	return sparks;
+}
+
+/**
+ * @brief
+ * Adds the sparks as heap objects the way a running game would: allocated
+ * between other allocations of varying size, most of which are freed again.
+ */
+static void addScattered(World& world, const std::vector<Spark>& sparks)
+{
+	std::vector<char *> other;
+	unsigned int random = 77;
+	for (size_t i = 0; i < sparks.size(); ++i)  {
+		for (int a = 0; a < 3; ++a)  {
+			random = random * 1103515245 + 12345;
+			other.push_back(new char[16 + (random >> 8) % 240]);
+		}
+		world.addObject(new Spark(sparks[i]));
+	}
+
+	// The sparks stay scattered between the freed blocks
+	for (size_t i = 0; i < other.size(); ++i)
+		delete[] other[i];
+}
+
+/**
+ * @brief
+ * Simulation cost per object of sparks on the heap and in a pool.
+ * 
+ * @returns
+ * False if the two worlds end in different states.
+ */
+static bool benchPoolCase(unsigned int count, unsigned int ticks)
+{
+	const DeltaTime dt = 1.0f / 60;
+	const int size = 64;
+	const float limit = (float)(size * LEVEL_TILE_WIDTH);
+	const std::vector<Spark> sparks = makeSparks(count, limit);
+
+	World heap(size, size), pooled(size, size);
+	addScattered(heap, sparks);
+	ObjectPool<Spark>& pool = pooled.addPool<Spark>(count);
+	for (size_t i = 0; i < sparks.size(); ++i)
+		pool.add(sparks[i]);
+
+	heap.simulateObjects(dt);
+	pooled.simulateObjects(dt);
+
+	double heapTime = 0, poolTime = 0;
+	for (unsigned int t = 0; t < ticks; ++t)  {
+		PrecisionClock clock;
+		heap.simulateObjects(dt);
+		heapTime += clock.elapsed();
+
+		clock.reset();
+		pooled.simulateObjects(dt);
+		poolTime += clock.elapsed();
+	}
+
+	StateBuffer heapState, poolState;
+	heap.saveState(heapState);
+	pooled.saveState(poolState);
+	const bool ok = heapState.size() == poolState.size() && memcmp(heapState.data(), poolState.data(), heapState.size()) == 0;
+
+	// Churn, a removal and an addition cost the same for any number of objects
+	PrecisionClock clock;
+	for (size_t i = 0; i < sparks.size(); ++i)  {
+		pool.remove(pool.handle(i % pool.size()));
+		pool.add(sparks[i]);
+	}
+	const double churnTime = clock.elapsed();
+
+	const std::string caseName = "objects " + boost::lexical_cast<std::string>(count);
+	report("pool", caseName, "heap objects", heapTime * 1e9 / ticks / count, "ns/object");
+	report("pool", caseName, "pool", poolTime * 1e9 / ticks / count, "ns/object");
+	report("pool", caseName, "speedup", poolTime > 0 ? heapTime / poolTime : 0, "x");
+	report("pool", caseName, "remove and add", churnTime * 1e9 / count, "ns/object");
+	report("pool", caseName, "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+/**
+ * @brief
+ * Handles across additions, removals and reused slots.
+ * 
+ * @returns
+ * False if a handle reached the wrong object or a removed one.
+ */
+static bool benchHandles()
+{
+	World world(8, 8);
+	ObjectPool<Spark>& pool = world.addPool<Spark>(3);
+
+	ObjectHandle handles[3];
+	for (int i = 0; i < 3; ++i)
+		handles[i] = pool.add(Spark((float)i, 0, 0, 0, 320, 320));
+
+	// Full, then the last spark moves into the hole of the first
+	bool ok = !pool.add(Spark(9, 0, 0, 0, 320, 320)).isValid() && world.objectCount() == 3;
+	ok &= pool.remove(handles[0]) && !pool.remove(handles[0]);
+	ok &= pool.size() == 2 && world.objectCount() == 2 && pool.get(handles[0]) == NULL;
+	ok &= pool.get(handles[2]) == &pool[0] && pool.get(handles[2])->center().x == 4;
+	ok &= pool.get(handles[1])->center().x == 3 && pool.handle(1) == handles[1];
+
+	// The freed slot is reused, the old handle stays dead
+	const ObjectHandle reused = pool.add(Spark(5, 0, 0, 0, 320, 320));
+	ok &= reused.slot == handles[0].slot && reused != handles[0] && !pool.contains(handles[0]);
+	ok &= pool.get(reused) == &pool[2] && &world.object(2) == &pool[2];
+
+	// Heap objects come before the pools, also when added later
+	Spark *heap = new Spark(7, 0, 0, 0, 320, 320);
+	world.addObject(heap);
+	ok &= world.objectCount() == 4 && &world.object(0) == heap && &world.object(1) == &pool[0] && &world.object(3) == &pool[2];
+	ok &= pool.remove(reused) && world.objectCount() == 3 && &world.object(2) == &pool[1];
+	ok &= world.removeObject(heap) && world.objectCount() == 2 && &world.object(0) == &pool[0];
+
+	report("pool", "handles", "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+bool benchPools(const BenchSettings& settings)
+{
+	static const unsigned int counts[] = { 1000, 4000, 16000 };
+
+	bool ok = benchHandles();
+	for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)  {
+		// Always measure a thousand objects
+		if (c > 0 && counts[c] > settings.maxObjects)
+			break;
+
+		ok &= benchPoolCase(counts[c], settings.ticks);
+	}
+	return ok;
+}
@@ -0,0 +1,229 @@
+#include <cstring>
+#include <boost/lexical_cast.hpp>
+#include "bench/Benchmark.h"
+#include "PrecisionClock.h"
+#include "StateBuffer.h"
+#include "World.h"
+#include "tiles/BombTile.h"
+
+/**
+ * @brief
+ * Fills the level with wall pillars and bricks, so that explosions have something to destroy.
+ */
+static void fillLevel(Level& level)
+{
+	unsigned int random = 4711;
+	for (int y = 0; y < level.height(); ++y)  {
+		for (int x = 0; x < level.width(); ++x)  {
+			random = random * 1103515245 + 12345;
+			if (x % 2 == 1 && y % 2 == 1)
+				level.setTile(x, y, TILE_WALL);
+			else if ((random >> 16) % 3 == 0)
+				level.setTile(x, y, TILE_BRICK);
+		}
+	}
+}
+
+/**
+ * @brief
+ * Changes the world the way a game does between a save and its rollback: the
+ * players walk and drop bombs, bombs explode anywhere in the level and one to
+ * four ticks are simulated.
+ */
+static void playAhead(World& world, unsigned int& random, DeltaTime dt)
+{
+	static const int directions[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+	for (size_t p = 0; p < world.playerCount(); ++p)  {
+		random = random * 1103515245 + 12345;
+		const int d = (random >> 16) % 4;
+		world.player((int)p).setAction(PlayerAction(directions[d][0], directions[d][1], (random >> 20) % 2 == 0));
+	}
+
+	Level& level = world.level();
+	for (int b = 0; b < 4; ++b)  {
+		random = random * 1103515245 + 12345;
+		const int x = (random >> 4) % level.width(), y = (random >> 18) % level.height();
+		if (level.tile(x, y).type == TILE_EMPTY)  {
+			BombTile::place(level, x, y, Player::BombRadius);
+			level.detonate(x, y);
+		}
+	}
+
+	random = random * 1103515245 + 12345;
+	const unsigned int ticks = 1 + (random >> 16) % 4;
+	for (unsigned int t = 0; t < ticks; ++t)
+		world.simulate(dt);
+}
+
+/**
+ * @brief
+ * Measures saving and restoring of one world configuration.
+ * 
+ * @param size
+ * Level side in tiles.
+ * 
+ * @param players
+ * Number of players in the world.
+ * 
+ * @param iterations
+ * Number of measured saves and restores.
+ * 
+ * @param pack
+ * Packs the chunks far from the players before the first save, see Level::setPackDistance.
+ * 
+ * @returns
+ * False if a restored world differs from the saved one.
+ */
+static bool benchSnapshotCase(int size, unsigned int players, unsigned int iterations, bool pack)
+{
+	const DeltaTime dt = 1.0f / 60;
+	const std::string caseName = "level " + boost::lexical_cast<std::string>(size) + "x" + boost::lexical_cast<std::string>(size)
+		+ " players " + boost::lexical_cast<std::string>(players) + (pack ? " packed" : "");
+
+	World world(size, size);
+	fillLevel(world.level());
+	for (unsigned int i = 0; i < players; ++i)  {
+		const int index = world.spawnPlayer();
+		const sf::Vector2f center = world.player(index).center();
+		world.level().setTile((int)(center.x / LEVEL_TILE_WIDTH), (int)(center.y / LEVEL_TILE_HEIGHT), TILE_EMPTY);
+	}
+	world.simulate(dt);
+
+	// Saved packed chunks must come back packed, bombs in playAhead unpack them in between
+	int packedChunks = 0;
+	if (pack)  {
+		std::vector<sf::FloatRect> areas;
+		for (size_t i = 0; i < world.playerCount(); ++i)
+			areas.push_back(world.player((int)i).bounds());
+
+		const int allocated = world.level().allocatedChunkCount();
+		world.level().setPackDistance(LevelChunk::Size / 2);
+		world.level().compact(areas);
+		packedChunks = allocated - world.level().allocatedChunkCount();
+	}
+
+	// First save grows the buffer
+	StateBuffer state, check;
+	world.saveState(state);
+
+	const boost::uint64_t saveAllocs = allocationCount();
+	PrecisionClock clock;
+	for (unsigned int i = 0; i < iterations; ++i)
+		world.saveState(state);
+	const double saveTime = clock.elapsed();
+	const boost::uint64_t saveAllocCount = allocationCount() - saveAllocs;
+
+	// Rollback: play a few ticks ahead, restore, the restored world must save into exactly the same bytes
+	unsigned int random = 1234;
+	boost::uint64_t loadAllocCount = 0;
+	double loadTime = 0;
+	bool ok = true;
+	for (unsigned int i = 0; i < iterations; ++i)  {
+		playAhead(world, random, dt);
+
+		const boost::uint64_t loadAllocs = allocationCount();
+		clock.reset();
+		ok &= world.loadState(state);
+		loadTime += clock.elapsed();
+		loadAllocCount += allocationCount() - loadAllocs;
+
+		world.saveState(check);
+		ok &= check.size() == state.size() && memcmp(check.data(), state.data(), state.size()) == 0;
+	}
+
+	if (pack)  {
+		ok &= packedChunks > 0;
+		report("snapshot", caseName, "chunks.packed", packedChunks, "chunks");
+	}
+	report("snapshot", caseName, "state.size", (double)state.size() / 1024, "KiB");
+	report("snapshot", caseName, "world.saveState", saveTime * 1e6 / iterations, "us");
+	report("snapshot", caseName, "world.loadState", loadTime * 1e6 / iterations, "us");
+	report("snapshot", caseName, "allocs", (double)(saveAllocCount + loadAllocCount) / (2 * iterations), "allocs/op");
+	report("snapshot", caseName, "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+/**
+ * @brief
+ * Measures the per tick copy of a world for the bots, see World::copyView.
+ * 
+ * @param size
+ * Level side in tiles.
+ * 
+ * @param iterations
+ * Number of measured copies.
+ * 
+ * @returns
+ * False if a copy differs from the world.
+ */
+static bool benchViewCase(int size, unsigned int iterations)
+{
+	const DeltaTime dt = 1.0f / 60;
+	const std::string caseName = "view " + boost::lexical_cast<std::string>(size) + "x" + boost::lexical_cast<std::string>(size);
+
+	World world(size, size), view(1, 1);
+	fillLevel(world.level());
+	world.spawnPlayer();
+	world.spawnPlayer();
+	world.level().setPackDistance(LevelChunk::Size / 2);
+	world.simulate(dt);
+
+	std::vector<sf::FloatRect> areas;
+	for (size_t i = 0; i < world.playerCount(); ++i)
+		areas.push_back(world.player((int)i).bounds());
+	world.level().compact(areas);
+
+	// First copy is a full one
+	StateBuffer state;
+	view.copyView(world, state);
+
+	unsigned int random = 1234;
+	boost::uint64_t allocs = 0;
+	double copyTime = 0;
+	bool ok = true;
+	PrecisionClock clock;
+	for (unsigned int i = 0; i < iterations; ++i)  {
+		playAhead(world, random, dt);
+
+		const boost::uint64_t copyAllocs = allocationCount();
+		clock.reset();
+		view.copyView(world, state);
+		copyTime += clock.elapsed();
+		allocs += allocationCount() - copyAllocs;
+
+		ok &= view.level().hash() == world.level().hash() && view.level().activeTileCount() == world.level().activeTileCount()
+			&& view.player(0).center().x == world.player(0).center().x && view.player(0).center().y == world.player(0).center().y;
+	}
+
+	report("snapshot", caseName, "world.copyView", copyTime * 1e6 / iterations, "us");
+	report("snapshot", caseName, "allocs", (double)allocs / iterations, "allocs/op");
+	report("snapshot", caseName, "chunks.allocated", view.level().allocatedChunkCount(), "chunks");
+	report("snapshot", caseName, "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+bool benchSnapshot(const BenchSettings& settings)
+{
+	static const int sizes[] = { 42, 128, 512 };
+	static const unsigned int playerCounts[] = { 2, 8 };
+
+	bool ok = true;
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)  {
+		if (sizes[s] > (int)settings.maxLevelSize)
+			break;
+
+		for (size_t p = 0; p < sizeof(playerCounts) / sizeof(playerCounts[0]); ++p)  {
+			if (playerCounts[p] > settings.maxObjects)
+				break;
+
+			ok &= benchSnapshotCase(sizes[s], playerCounts[p], settings.ticks, false);
+		}
+
+		// Far chunks only exist in levels larger than a few chunks
+		if (sizes[s] >= 4 * LevelChunk::Size)
+			ok &= benchSnapshotCase(sizes[s], playerCounts[0], settings.ticks, true);
+		ok &= benchViewCase(sizes[s], settings.ticks);
+	}
+	return ok;
+}
@@ -0,0 +1,155 @@
+#include <cstdio>
+#include <boost/lexical_cast.hpp>
+#include "bench/Benchmark.h"
+#include "PrecisionClock.h"
+#include "World.h"
+
+/**
+ * @brief
+ * A movement of a tile sized rectangle and where Level::slide must leave it.
+ */
+struct SlideCase  {
+	const char *name;
+	float x, y, dx, dy;
+	float expectedX, expectedY;
+};
+
+/**
+ * @brief
+ * Cases on an 8x8 level with walls at (4, 2) and (2, 5), positions in world space.
+ */
+static const SlideCase slideCases[] = {
+	{ "ends touching",            80,  80,   40,   0, 120,  80 },
+	{ "passes the edge",          80,  80,   41,   0, 120,  80 },
+	{ "starts touching",         120,  80,    5,   0, 120,  80 },
+	{ "moves away from touching", 120, 80,   -5,   0, 115,  80 },
+	{ "long step, no tunneling",  80,  80, 1000,   0, 120,  80 },
+	{ "hits the right side",     240,  80, -200,   0, 200,  80 },
+	{ "fraction before the edge", 119.5f, 80, 1, 0, 120,  80 },
+	{ "slides along the top",    120,  40,  100,   0, 220,  40 },
+	{ "slides along the side",   120,   0,    0, 200, 120, 200 },
+	{ "left level border",        20, 120,  -50,   0,   0, 120 },
+	{ "bottom level border",      40, 250,    0, 100,  40, 280 },
+	{ "leaves a cell under it",   80, 200,   30,   0, 110, 200 },
+	{ "diagonal, slides down",    80,  80,   80,  20, 120, 100 },
+	{ "exact corner",             80,   0,   80,  80, 120,  80 },
+	{ "diagonal into the border", 250, 250, 100, 100, 280, 280 },
+};
+
+/**
+ * @brief
+ * Checks Level::slide and Level::sweep against the hand made cases at tile edges.
+ */
+static bool benchSlideCases()
+{
+	Level level(8, 8);
+	level.setTile(4, 2, TILE_WALL);
+	level.setTile(2, 5, TILE_WALL);
+
+	bool ok = true;
+	for (size_t c = 0; c < sizeof(slideCases) / sizeof(slideCases[0]); ++c)  {
+		const SlideCase& test = slideCases[c];
+		const sf::FloatRect rect(test.x, test.y, test.x + LEVEL_TILE_WIDTH, test.y + LEVEL_TILE_HEIGHT);
+		const sf::Vector2f to = level.slide(rect, test.dx, test.dy);
+		const bool passed = to.x == test.expectedX && to.y == test.expectedY;
+		if (!passed)
+			report("sweep", test.name, "position", to.x, "FAILED " + boost::lexical_cast<std::string>(to.y));
+		ok &= passed;
+	}
+
+	// The hit itself: a step to the wall and beyond it
+	TileHit hit;
+	const sf::FloatRect rect(80, 80, 120, 120);
+	ok &= level.sweep(rect, 80, 0, hit) && hit.time == 0.5f && hit.normalX == -1 && hit.normalY == 0 && hit.x == 4 && hit.y == 2;
+	ok &= !level.sweep(rect, 40, 0, hit);
+	ok &= !level.sweep(rect, 0, 0, hit);
+	ok &= level.sweep(sf::FloatRect(160, 0, 200, 40), 0, 100, hit) && hit.time == 0.4f && hit.normalY == -1 && hit.x == 4 && hit.y == 2;
+
+	report("sweep", "tile edges", "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+/**
+ * @brief
+ * A player walking into a wall with a time step eight tiles long, as after a hitch.
+ * 
+ * @returns
+ * False if the player went through the wall or did not reach it.
+ */
+static bool benchPlayerHitch()
+{
+	World world(16, 16);
+	const int index = world.spawnPlayer();
+	Player& player = world.player(index);
+	const sf::Vector2f start = player.center();
+	const int x = (int)(start.x / LEVEL_TILE_WIDTH), y = (int)(start.y / LEVEL_TILE_HEIGHT);
+	world.level().setTile(x + 3, y, TILE_WALL);
+
+	player.setAction(PlayerAction(1, 0, false));
+	world.simulate(8.0f / Player::Speed);
+
+	const sf::Vector2f center = player.center();
+	const bool ok = center.x == start.x + 2 * LEVEL_TILE_WIDTH && center.y == start.y;
+	report("sweep", "player, 8 tile step", "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+/**
+ * @brief
+ * Cost of Level::slide for random rectangles and steps in a level of pillars and bricks.
+ */
+static void benchSlideCost(float maxStep)
+{
+	const int size = 64;
+	Level level(size, size);
+	unsigned int random = 4711;
+	for (int y = 0; y < size; ++y)  {
+		for (int x = 0; x < size; ++x)  {
+			random = random * 1103515245 + 12345;
+			if (x % 2 == 1 && y % 2 == 1)
+				level.setTile(x, y, TILE_WALL);
+			else if ((random >> 16) % 3 == 0)
+				level.setTile(x, y, TILE_BRICK);
+		}
+	}
+
+	// Tile sized rectangles anywhere, moving in any direction
+	const int count = 4096;
+	std::vector<sf::FloatRect> rects;
+	std::vector<sf::Vector2f> steps;
+	for (int i = 0; i < count; ++i)  {
+		float values[4];
+		for (int v = 0; v < 4; ++v)  {
+			random = random * 1103515245 + 12345;
+			values[v] = ((random >> 8) & 0xFFFF) / 65536.0f;
+		}
+		const float x = values[0] * (size - 1) * LEVEL_TILE_WIDTH, y = values[1] * (size - 1) * LEVEL_TILE_HEIGHT;
+		rects.push_back(sf::FloatRect(x, y, x + LEVEL_TILE_WIDTH, y + LEVEL_TILE_HEIGHT));
+		steps.push_back(sf::Vector2f((values[2] - 0.5f) * 2 * maxStep * LEVEL_TILE_WIDTH, (values[3] - 0.5f) * 2 * maxStep * LEVEL_TILE_HEIGHT));
+	}
+
+	const int repeats = 50;
+	float sum = 0;
+	PrecisionClock clock;
+	for (int r = 0; r < repeats; ++r)  {
+		for (int i = 0; i < count; ++i)  {
+			const sf::Vector2f to = level.slide(rects[i], steps[i].x, steps[i].y);
+			sum += to.x + to.y;
+		}
+	}
+	const double elapsed = clock.elapsed();
+
+	char caseName[64];
+	sprintf(caseName, "level 64x64 step up to %g tiles", maxStep);
+	report("sweep", caseName, "slide", sum != 0 ? elapsed * 1e9 / repeats / count : 0, "ns/object");
+}
+
+bool benchSweep(const BenchSettings& settings)
+{
+	bool ok = benchSlideCases();
+	ok &= benchPlayerHitch();
+	benchSlideCost(0.1f);
+	benchSlideCost(1);
+	benchSlideCost(8);
+	return ok;
+}
@@ -0,0 +1,182 @@
+#include <cstdio>
+#include <boost/lexical_cast.hpp>
+#include "bench/Benchmark.h"
+#include "PrecisionClock.h"
+#include "Level.h"
+#include "WorldSnapshot.h"
+
+/**
+ * @brief
+ * Checks the quads of one layer of one section against the level.
+ * 
+ * @param seen
+ * Number of quads found for every tile (in/out).
+ * 
+ * @returns
+ * True if every quad has the right position, atlas coordinates and layer.
+ */
+static bool verifyTileLayer(const Level& level, const TileBatch& batch, int section, unsigned char layer, std::vector<int>& seen, const std::string& caseName)
+{
+	const std::vector<TileVertex>& vertices = batch.vertices(section, layer);
+	if (vertices.size() % 4 != 0)  {
+		fprintf(stderr, "tilebatch %s: layer %d of section %d has %d vertices\n", caseName.c_str(), layer, section, (int)vertices.size());
+		return false;
+	}
+
+	for (size_t q = 0; q < vertices.size(); q += 4)  {
+		const TileVertex *quad = &vertices[q];
+		const int x = (int)quad[0].x / LEVEL_TILE_WIDTH, y = (int)quad[0].y / LEVEL_TILE_HEIGHT;
+		if (!level.isInside(x, y))  {
+			fprintf(stderr, "tilebatch %s: quad outside of the level at %g, %g\n", caseName.c_str(), quad[0].x, quad[0].y);
+			return false;
+		}
+
+		const Tile tile = level.tile(x, y);
+		const sf::FloatRect uv = batch.atlas().texCoords(tile.type);
+		const float left = (float)(x * LEVEL_TILE_WIDTH), top = (float)(y * LEVEL_TILE_HEIGHT);
+		const float right = left + LEVEL_TILE_WIDTH, bottom = top + LEVEL_TILE_HEIGHT;
+		const TileVertex expected[4] = {
+			{ left, top, uv.Left, uv.Top },
+			{ right, top, uv.Right, uv.Top },
+			{ right, bottom, uv.Right, uv.Bottom },
+			{ left, bottom, uv.Left, uv.Bottom }
+		};
+
+		for (int i = 0; i < 4; ++i)  {
+			if (quad[i].x != expected[i].x || quad[i].y != expected[i].y || quad[i].u != expected[i].u || quad[i].v != expected[i].v)  {
+				fprintf(stderr, "tilebatch %s: wrong vertex %d of tile %d, %d\n", caseName.c_str(), i, x, y);
+				return false;
+			}
+		}
+
+		if (tileType(tile.type).layer != layer)  {
+			fprintf(stderr, "tilebatch %s: tile %d, %d in layer %d instead of %d\n", caseName.c_str(), x, y, layer, tileType(tile.type).layer);
+			return false;
+		}
+
+		++seen[y * level.width() + x];
+	}
+
+	return true;
+}
+
+/**
+ * @brief
+ * Checks that every tile of the level has exactly one quad with the right
+ * position and atlas coordinates.
+ * 
+ * @returns
+ * True if the vertex data matches the level.
+ */
+static bool verifyTileBatch(const Level& level, const TileBatch& batch, const std::string& caseName)
+{
+	const int tiles = level.width() * level.height();
+	std::vector<int> seen(tiles, 0);
+
+	for (int section = 0; section < batch.sectionCount(); ++section)  {
+		for (unsigned char layer = 0; layer < TILE_LAYER_COUNT; ++layer)  {
+			if (!verifyTileLayer(level, batch, section, layer, seen, caseName))
+				return false;
+		}
+	}
+
+	for (int i = 0; i < tiles; ++i)  {
+		if (seen[i] != 1)  {
+			fprintf(stderr, "tilebatch %s: tile %d, %d has %d quads\n", caseName.c_str(), i % level.width(), i / level.width(), seen[i]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief
+ * Measures and verifies the tile batch of one level size.
+ * 
+ * @param size
+ * Level side in tiles.
+ * 
+ * @param iterations
+ * Number of measured updates.
+ * 
+ * @returns
+ * True if the generated vertex data is correct.
+ */
+static bool benchTileBatchCase(int size, unsigned int iterations)
+{
+	const std::string caseName = "level " + boost::lexical_cast<std::string>(size) + "x" + boost::lexical_cast<std::string>(size);
+	const sf::IntRect wholeLevel(0, 0, size, size);
+
+	Level level(size, size);
+
+	// What a 640x480 screen in the middle of the level needs
+	const Camera camera(sf::FloatRect(size * LEVEL_TILE_WIDTH / 2.0f - 320, size * LEVEL_TILE_HEIGHT / 2.0f - 240,
+		size * LEVEL_TILE_WIDTH / 2.0f + 320, size * LEVEL_TILE_HEIGHT / 2.0f + 240));
+	TileBatch viewBatch;
+	viewBatch.resize(size, size);
+	PrecisionClock clock;
+	viewBatch.update(level, level.visibleTiles(camera));
+	const double viewTime = clock.elapsed();
+	const unsigned int viewQuads = viewBatch.updateCount();
+
+	TileBatch batch;
+	batch.resize(size, size);
+	clock.reset();
+	batch.update(level, wholeLevel);
+	const double buildTime = clock.elapsed();
+	bool ok = verifyTileBatch(level, batch, caseName);
+
+	// The render thread of the pipelined loop, drawing from three snapshots in turn
+	TileSnapshot snapshots[3];
+	TileBatch snapshotBatch;
+	level.captureTiles(snapshots[0]);
+	snapshotBatch.update(snapshots[0], wholeLevel);
+
+	// A few changed tiles per frame, as after an explosion
+	static const int ChangedTiles = 16;
+	unsigned int tileTypeId = 0;
+	double snapshotTime = 0;
+	clock.reset();
+	for (unsigned int i = 0; i < iterations; ++i)  {
+		for (int t = 0; t < ChangedTiles; ++t)  {
+			const int index = (i * ChangedTiles + t) * 7919 % (size * size);
+			level.setTile(index % size, index / size, (unsigned char)(tileTypeId++ % TILE_TYPE_COUNT));
+			batch.invalidate(index);
+		}
+		batch.update(level, wholeLevel);
+
+		// Every second snapshot is skipped, as when rendering is slower than the simulation
+		PrecisionClock snapshotClock;
+		TileSnapshot& snapshot = snapshots[(i + 1) % 3];
+		level.captureTiles(snapshot);
+		if (i % 2 == 1 || i + 1 == iterations)
+			snapshotBatch.update(snapshot, wholeLevel);
+		snapshotTime += snapshotClock.elapsed();
+	}
+	const double updateTime = clock.elapsed() - snapshotTime;
+	ok = verifyTileBatch(level, batch, caseName) && ok;
+	ok = verifyTileBatch(level, snapshotBatch, caseName + " snapshot") && ok;
+
+	report("tilebatch", caseName, "build view", viewTime * 1e6, "us");
+	report("tilebatch", caseName, "view quads", viewQuads, "quads");
+	report("tilebatch", caseName, "build level", buildTime * 1e6, "us");
+	report("tilebatch", caseName, "update 16 tiles", updateTime * 1e6 / iterations, "us");
+	report("tilebatch", caseName, "snapshot 16 tiles", snapshotTime * 1e6 / iterations, "us");
+	report("tilebatch", caseName, "verify", ok ? 1 : 0, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+bool benchTileBatch(const BenchSettings& settings)
+{
+	static const int sizes[] = { 42, 128, 512, 1024, 2048 };
+
+	bool ok = true;
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)  {
+		if (sizes[s] > (int)settings.maxLevelSize)
+			break;
+
+		ok = benchTileBatchCase(sizes[s], settings.ticks) && ok;
+	}
+	return ok;
+}
@@ -0,0 +1,98 @@
+#include <boost/lexical_cast.hpp>
+#include "bench/Benchmark.h"
+#include "PrecisionClock.h"
+#include "World.h"
+
+/**
+ * @brief
+ * Measures one world configuration.
+ * 
+ * @param size
+ * Level side in tiles.
+ * 
+ * @param objects
+ * Number of players in the world.
+ * 
+ * @param ticks
+ * Number of measured ticks.
+ */
+static void benchWorldCase(int size, unsigned int objects, unsigned int ticks)
+{
+	const DeltaTime dt = 1.0f / 60;
+	const std::string caseName = "level " + boost::lexical_cast<std::string>(size) + "x" + boost::lexical_cast<std::string>(size)
+		+ " objects " + boost::lexical_cast<std::string>(objects);
+
+	PrecisionClock setup;
+	World world(size, size);
+	for (unsigned int i = 0; i < objects; ++i)  {
+		const int x = i % size, y = (i / size) % size;
+		world.addObject(new Player((float)(x * LEVEL_TILE_WIDTH), (float)(y * LEVEL_TILE_HEIGHT), LEVEL_TILE_WIDTH, LEVEL_TILE_HEIGHT));
+	}
+	report("world", caseName, "setup", setup.elapsed() * 1000, "ms");
+	report("world", caseName, "level.memory", world.level().memoryUsage() / 1024.0, "KiB");
+
+	WorldSnapshot snapshot;
+	world.simulate(dt);
+	world.captureSnapshot(snapshot);
+
+	// Level alone
+	const boost::uint64_t levelAllocs = allocationCount();
+	PrecisionClock clock;
+	for (unsigned int i = 0; i < ticks; ++i)
+		world.level().simulate(dt);
+	const double levelTime = clock.elapsed();
+	const boost::uint64_t levelAllocCount = allocationCount() - levelAllocs;
+
+	// Objects alone
+	const boost::uint64_t objectAllocs = allocationCount();
+	clock.reset();
+	for (unsigned int i = 0; i < ticks; ++i)
+		world.simulateObjects(dt);
+	const double objectTime = clock.elapsed();
+	const boost::uint64_t objectAllocCount = allocationCount() - objectAllocs;
+
+	// Whole tick
+	const boost::uint64_t worldAllocs = allocationCount();
+	clock.reset();
+	for (unsigned int i = 0; i < ticks; ++i)
+		world.simulate(dt);
+	const double worldTime = clock.elapsed();
+	const boost::uint64_t worldAllocCount = allocationCount() - worldAllocs;
+
+	// Render commands, i.e. the snapshot the render thread draws from
+	const boost::uint64_t snapshotAllocs = allocationCount();
+	clock.reset();
+	for (unsigned int i = 0; i < ticks; ++i)
+		world.captureSnapshot(snapshot);
+	const double snapshotTime = clock.elapsed();
+	const boost::uint64_t snapshotAllocCount = allocationCount() - snapshotAllocs;
+
+	const double tiles = (double)size * size;
+	const double objectCount = objects > 0 ? objects : 1;
+	report("world", caseName, "level.simulate", levelTime * 1e9 / ticks / tiles, "ns/tile");
+	report("world", caseName, "objects.simulate", objectTime * 1e9 / ticks / objectCount, "ns/object");
+	report("world", caseName, "world.simulate", worldTime * 1e6 / ticks, "us/tick");
+	report("world", caseName, "render.commands", snapshotTime * 1e9 / ticks / objectCount, "ns/object");
+	report("world", caseName, "level.allocs", (double)levelAllocCount / ticks, "allocs/tick");
+	report("world", caseName, "objects.allocs", (double)objectAllocCount / ticks, "allocs/tick");
+	report("world", caseName, "world.allocs", (double)worldAllocCount / ticks, "allocs/tick");
+	report("world", caseName, "render.allocs", (double)snapshotAllocCount / ticks, "allocs/tick");
+}
+
+void benchWorld(const BenchSettings& settings)
+{
+	static const int sizes[] = { 42, 128, 512, 1024, 2048, 4096 };
+	static const unsigned int objectCounts[] = { 1, 10, 100, 1000 };
+
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)  {
+		if (sizes[s] > (int)settings.maxLevelSize)
+			break;
+
+		for (size_t o = 0; o < sizeof(objectCounts) / sizeof(objectCounts[0]); ++o)  {
+			if (objectCounts[o] > settings.maxObjects)
+				break;
+
+			benchWorldCase(sizes[s], objectCounts[o], settings.ticks);
+		}
+	}
+}
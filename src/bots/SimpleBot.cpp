@@ -0,0 +1,124 @@
+#include <cmath>
+#include "SimpleBot.h"
+#include "World.h"
+
+/**
+ * @brief
+ * True if a cell is neither in a blast zone nor burning.
+ */
+static bool isSafe(const Level& level, int x, int y)
+{
+	return !level.danger().isThreatened(x, y) && !level.plane(TILE_PLANE_FLAME).test(x, y);
+}
+
+PlayerAction SimpleBot::think(const BotContext& context)
+{
+	const World& world = context.world();
+	const Level& level = world.level();
+	const DistanceField& distances = level.distances(context.playerIndex());
+
+	// The cell under the center of the player, the source of its distance field
+	const sf::Vector2f center = world.player(context.playerIndex()).center();
+	const int x = (int)floor(center.x / LEVEL_TILE_WIDTH), y = (int)floor(center.y / LEVEL_TILE_HEIGHT);
+	if (!level.isInside(x, y))
+		return PlayerAction();
+
+	int targetX, targetY;
+	if (!isSafe(level, x, y))  {
+		if (findNearest(context, distances, x, y, GOAL_SAFE, targetX, targetY))
+			return stepTowards(level, distances, x, y, targetX, targetY);
+		return PlayerAction();
+	}
+
+	// Bomb the bricks around when the bomb leaves a way out
+	if (matches(level, x, y, GOAL_BRICK) && level.tile(x, y).type == TILE_EMPTY)  {
+		if (m_zone.width() != level.width() || m_zone.height() != level.height())
+			m_zone.resize(level.width(), level.height());
+		else
+			m_zone.clear();
+		level.blastZone(x, y, Player::BombRadius, m_zone);
+
+		if (findNearest(context, distances, x, y, GOAL_ESCAPE, targetX, targetY))  {
+			PlayerAction action = stepTowards(level, distances, x, y, targetX, targetY);
+			action.bomb = true;
+			return action;
+		}
+	}
+
+	if (findNearest(context, distances, x, y, GOAL_BRICK, targetX, targetY))  {
+		// Wait rather than walk into a blast zone on the way
+		PlayerAction action = stepTowards(level, distances, x, y, targetX, targetY);
+		if (isSafe(level, x + action.dx, y + action.dy))
+			return action;
+	}
+	return PlayerAction();
+}
+
+bool SimpleBot::matches(const Level& level, int x, int y, Goal goal) const
+{
+	if (!isSafe(level, x, y))
+		return false;
+
+	switch (goal)  {
+	case GOAL_ESCAPE:
+		return !m_zone.test(x, y);
+	case GOAL_BRICK:
+		{
+			const BitPlane& bricks = level.plane(TILE_PLANE_DESTRUCTIBLE);
+			return (x > 0 && bricks.test(x - 1, y)) || (x + 1 < level.width() && bricks.test(x + 1, y))
+				|| (y > 0 && bricks.test(x, y - 1)) || (y + 1 < level.height() && bricks.test(x, y + 1));
+		}
+	default:
+		return true;
+	}
+}
+
+bool SimpleBot::findNearest(const BotContext& context, const DistanceField& distances, int x, int y, Goal goal, int& targetX, int& targetY) const
+{
+	const Level& level = context.world().level();
+	const int left = x > SearchRange ? x - SearchRange : 0, right = x + SearchRange < level.width() ? x + SearchRange : level.width() - 1;
+	const int top = y > SearchRange ? y - SearchRange : 0, bottom = y + SearchRange < level.height() ? y + SearchRange : level.height() - 1;
+
+	int best = -1;
+	for (int cy = top; cy <= bottom; ++cy)  {
+		if (context.expired())
+			return false;
+
+		for (int cx = left; cx <= right; ++cx)  {
+			const int d = distances.distance(cx, cy);
+			if (d < 0 || d > SearchRange || (best >= 0 && d >= best) || !matches(level, cx, cy, goal))
+				continue;
+
+			best = d;
+			targetX = cx;
+			targetY = cy;
+		}
+	}
+	return best >= 0;
+}
+
+PlayerAction SimpleBot::stepTowards(const Level& level, const DistanceField& distances, int x, int y, int targetX, int targetY)
+{
+	static const int directions[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+	// Walk back from the target along decreasing distances to the cell next to the player
+	int d = distances.distance(targetX, targetY);
+	while (d > 1)  {
+		int i = 0;
+		for (; i < 4; ++i)  {
+			const int nx = targetX + directions[i][0], ny = targetY + directions[i][1];
+			if (level.isInside(nx, ny) && distances.distance(nx, ny) == d - 1)  {
+				targetX = nx;
+				targetY = ny;
+				break;
+			}
+		}
+		if (i == 4)
+			return PlayerAction();
+		--d;
+	}
+
+	if (d != 1)
+		return PlayerAction();
+	return PlayerAction((signed char) (targetX - x), (signed char) (targetY - y), false);
+}
@@ -0,0 +1,60 @@
+#ifndef SIMPLEBOT_H
+#define SIMPLEBOT_H
+
+#include "Bot.h"
+#include "BitPlane.h"
+
+class Level;
+class DistanceField;
+
+/**
+ * @brief
+ * Built-in bot that clears bricks and stays out of blast zones.
+ * 
+ * Runs away when its cell is threatened, places a bomb next to a brick when a
+ * safe cell is near enough to escape to, and otherwise walks to the nearest
+ * safe cell next to a brick. All decisions are lookups in the danger field and
+ * the distance field of its player, see Level::updateFields.
+ */
+class SimpleBot : public Bot  {
+public:
+	PlayerAction think(const BotContext& context) override;
+
+private:
+	enum Goal  {
+		GOAL_SAFE,    // any cell out of danger
+		GOAL_ESCAPE,  // a safe cell outside of m_zone
+		GOAL_BRICK    // a safe cell next to a brick
+	};
+
+	/**
+	 * @brief
+	 * Cells searched in each direction, also the longest escape.
+	 */
+	static const int SearchRange = 8;
+
+	/**
+	 * @brief
+	 * Blast zone of the bomb the bot considers placing.
+	 */
+	BitPlane m_zone;
+
+	/**
+	 * @brief
+	 * Finds the reachable cell closest to the player that matches the goal.
+	 * 
+	 * @returns
+	 * False if there is none within SearchRange or the budget ran out.
+	 */
+	bool findNearest(const BotContext& context, const DistanceField& distances, int x, int y, Goal goal, int& targetX, int& targetY) const;
+
+	bool matches(const Level& level, int x, int y, Goal goal) const;
+
+	/**
+	 * @brief
+	 * First step of the shortest path from the player cell to a target cell.
+	 */
+	static PlayerAction stepTowards(const Level& level, const DistanceField& distances, int x, int y, int targetX, int targetY);
+};
+
+#endif
@@ -6,6 +6,8 @@
 class CloseEvent : public SystemEvent  {
 public:
 	explicit CloseEvent(sf::Event& ev) : SystemEvent(ev)  {}
+
+	unsigned short typeId() const override { return EVENT_TYPE_CLOSE; }
 };
 
 #endif
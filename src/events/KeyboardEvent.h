@@ -22,11 +22,15 @@ public:
 class KeyDownEvent : public KeyboardEvent  {
 public:
 	explicit KeyDownEvent(sf::Event& ev) : KeyboardEvent(ev) {}
+
+	unsigned short typeId() const override { return EVENT_TYPE_KEY_DOWN; }
 };
 
 class KeyUpEvent : public KeyboardEvent  {
 public:
 	explicit KeyUpEvent(sf::Event& ev) : KeyboardEvent(ev) {}
+
+	unsigned short typeId() const override { return EVENT_TYPE_KEY_UP; }
 };
 
 #endif
@@ -27,11 +27,15 @@ public:
 class MouseDownEvent : public MouseEvent  {
 public:
 	explicit MouseDownEvent(sf::Event& ev) : MouseEvent(ev) {}
+
+	unsigned short typeId() const override { return EVENT_TYPE_MOUSE_DOWN; }
 };
 
 class MouseUpEvent : public MouseEvent  {
 public:
 	explicit MouseUpEvent(sf::Event& ev) : MouseEvent(ev) {}
+
+	unsigned short typeId() const override { return EVENT_TYPE_MOUSE_UP; }
 };
 
 class MouseDblClickEvent : public MouseEvent  {
@@ -44,6 +48,8 @@ public:
 	explicit MouseWheelEvent(sf::Event& ev) : MouseEvent(ev) {}
 
 	int delta() const { return m_event.MouseWheel.Delta; }
+
+	unsigned short typeId() const override { return EVENT_TYPE_MOUSE_WHEEL; }
 };
 
 #endif
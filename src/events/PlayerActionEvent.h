@@ -0,0 +1,56 @@
+#ifndef PLAYERACTIONEVENT_H
+#define PLAYERACTIONEVENT_H
+
+#include <istream>
+#include "EventLoop.h"
+#include "PlayerAction.h"
+
+/**
+ * @brief
+ * Sets the action of a player, sent by the input or a bot.
+ * 
+ * Recorded as four bytes: player index, dx, dy and the bomb flag.
+ * 
+ * @see
+ * PlayerActionHandler
+ */
+class PlayerActionEvent : public Event  {
+private:
+	unsigned char m_player;
+	PlayerAction m_action;
+
+public:
+	/**
+	 * @brief
+	 * Type id of the event, the first game event id.
+	 */
+	static const unsigned short TypeId = EVENT_TYPE_USER;
+
+	PlayerActionEvent(int player, const PlayerAction& action) : m_player((unsigned char) player), m_action(action) {}
+
+	unsigned short typeId() const override { return TypeId; }
+
+	void write(std::ostream& out) const override
+	{
+		const char bytes[4] = { (char) m_player, (char) m_action.dx, (char) m_action.dy, (char) (m_action.bomb ? 1 : 0) };
+		out.write(bytes, sizeof(bytes));
+	}
+
+	/**
+	 * @brief
+	 * Replay factory of the event, see ReplayReader::registerEventType.
+	 */
+	static EventPtr read(std::istream& in, unsigned short size)
+	{
+		char bytes[4];
+		if (size != sizeof(bytes) || !in.read(bytes, sizeof(bytes)))
+			return EventPtr();
+		return EventPtr(new PlayerActionEvent((unsigned char) bytes[0], PlayerAction((signed char) bytes[1], (signed char) bytes[2], bytes[3] != 0)));
+	}
+
+	// Properties
+	int player() const { return m_player; }
+	const PlayerAction& action() const { return m_action; }
+};
+
+#endif
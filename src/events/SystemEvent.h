@@ -18,6 +18,15 @@ public:
 
 	virtual ~SystemEvent() {}
 
+	/**
+	 * @brief
+	 * System events are recorded as the raw SFML event.
+	 */
+	void write(std::ostream& out) const override
+	{
+		out.write((const char *)&m_event, sizeof(m_event));
+	}
+
 	// Properties
 	sf::Event& event() { return m_event; }
 	const sf::Event& event() const { return m_event; }
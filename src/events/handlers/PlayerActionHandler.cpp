@@ -0,0 +1,10 @@
+#include "PlayerActionHandler.h"
+#include "events/PlayerActionEvent.h"
+#include "World.h"
+
+void PlayerActionHandler::handleEvent(const PlayerActionEvent& ev)
+{
+	// Replays of another world may name players that do not exist here
+	if (ev.player() < (int)m_world.playerCount())
+		m_world.player(ev.player()).setAction(ev.action());
+}
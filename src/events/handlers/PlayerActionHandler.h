@@ -0,0 +1,27 @@
+#ifndef PLAYERACTIONHANDLER_H
+#define PLAYERACTIONHANDLER_H
+
+#include "EventLoop.h"
+
+class PlayerActionEvent;
+class World;
+
+/**
+ * @brief
+ * Passes the actions sent by the input and the bots to the players of a world.
+ * 
+ * @see
+ * Player::setAction | BotController
+ */
+class PlayerActionHandler : public EventHandlerBase<PlayerActionEvent>  {
+private:
+	World& m_world;
+
+public:
+	explicit PlayerActionHandler(World& world) : m_world(world) {}
+
+	void handleEvent(const PlayerActionEvent& evt) override;
+};
+
+
+#endif
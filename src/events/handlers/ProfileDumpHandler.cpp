@@ -0,0 +1,9 @@
+#include "ProfileDumpHandler.h"
+#include "events/KeyboardEvent.h"
+#include "Game.h"
+
+void ProfileDumpHandler::handleEvent(const KeyDownEvent& ev)
+{
+	if (ev.keyCode() == sf::Key::F11)
+		m_game.dumpProfile();
+}
@@ -0,0 +1,27 @@
+#ifndef PROFILEDUMPHANDLER_H
+#define PROFILEDUMPHANDLER_H
+
+#include "EventLoop.h"
+
+class KeyDownEvent;
+class Game;
+
+/**
+ * @brief
+ * Dumps the frame profile when the profile hotkey (F11) is pressed.
+ * 
+ * @see
+ * Fps::dumpProfile | Game::dumpProfile
+ */
+class ProfileDumpHandler : public EventHandlerBase<KeyDownEvent>  {
+private:
+	Game& m_game;
+
+public:
+	explicit ProfileDumpHandler(Game& game) : m_game(game) {}
+
+	void handleEvent(const KeyDownEvent& evt) override;
+};
+
+
+#endif
@@ -0,0 +1,35 @@
+#include "BombTile.h"
+#include "Level.h"
+
+const TileType BombTile::type = { "bomb", TILE_LAYER_BLOCKS, TILE_FLAG_SOLID, 1 << TILE_PLANE_BOMB, &BombTile::simulate, &BombTile::paint };
+
+void BombTile::place(Level& level, int x, int y, int radius)
+{
+	radius = radius < 1 ? 1 : (radius > MaxRadius ? MaxRadius : radius);
+	level.setTile(x, y, TILE_BOMB);
+	level.setTileFlags(x, y, (unsigned char) ((level.tile(x, y).flags & ~TILE_FLAG_PARAM) | (radius << RadiusShift)));
+}
+
+void BombTile::simulate(Level& level, int x, int y, DeltaTime dt)
+{
+	Tile& tile = level.editTile(x, y);
+	if (++tile.state >= FuseTicks)
+		level.detonate(x, y);
+}
+
+void BombTile::paint(sf::Image& image, unsigned int left, unsigned int top, const Tile& tile)
+{
+	// Black ball with a highlight, on the green floor of the empty tile
+	const float centerX = (LEVEL_TILE_WIDTH - 1) / 2.0f, centerY = (LEVEL_TILE_HEIGHT - 1) / 2.0f + 2;
+	const float radius = LEVEL_TILE_WIDTH * 0.4f;
+	for (unsigned int y = 0; y < LEVEL_TILE_HEIGHT; ++y)  {
+		for (unsigned int x = 0; x < LEVEL_TILE_WIDTH; ++x)  {
+			const float dx = x - centerX, dy = y - centerY;
+			const float hx = dx + radius * 0.35f, hy = dy + radius * 0.35f;
+			sf::Color color = sf::Color::Green;
+			if (dx * dx + dy * dy <= radius * radius)
+				color = hx * hx + hy * hy <= radius * radius * 0.04f ? sf::Color(150, 150, 160) : sf::Color(25, 25, 30);
+			image.SetPixel(left + x, top + y, color);
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#ifndef BOMBTILE_H
+#define BOMBTILE_H
+
+#include "Tile.h"
+
+/**
+ * @brief
+ * Bomb with a burning fuse, explodes after FuseTicks ticks or when an explosion reaches it.
+ * 
+ * The number of ticks the fuse has burned is kept in Tile::state, the blast
+ * radius in the TILE_FLAG_PARAM bits of Tile::flags.
+ * 
+ * @see
+ * Level::detonate
+ */
+class BombTile  {
+public:
+	/**
+	 * @brief
+	 * Places a bomb.
+	 * 
+	 * @param radius
+	 * Range of the explosion in tiles, 1 to MaxRadius.
+	 */
+	static void place(Level& level, int x, int y, int radius);
+
+	/**
+	 * @brief
+	 * Blast radius of a bomb tile.
+	 */
+	static int radius(const Tile& tile) { return (tile.flags & TILE_FLAG_PARAM) >> RadiusShift; }
+
+	static void simulate(Level& level, int x, int y, DeltaTime dt);
+	static void paint(sf::Image& image, unsigned int left, unsigned int top, const Tile& tile);
+
+	static const TileType type;
+
+	/**
+	 * @brief
+	 * Time until a bomb explodes, two and a half seconds at the default tick rate.
+	 */
+	static const unsigned char FuseTicks = 150;
+
+	static const int RadiusShift = 4;
+	static const int MaxRadius = TILE_FLAG_PARAM >> RadiusShift;
+};
+
+#endif
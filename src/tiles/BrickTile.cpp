@@ -0,0 +1,19 @@
+#include "BrickTile.h"
+#include "Level.h"
+
+const TileType BrickTile::type = { "brick", TILE_LAYER_BLOCKS, TILE_FLAG_SOLID, 1 << TILE_PLANE_DESTRUCTIBLE, NULL, &BrickTile::paint };
+
+void BrickTile::paint(sf::Image& image, unsigned int left, unsigned int top, const Tile& tile)
+{
+	// Red bricks in four courses, with light mortar between them
+	static const unsigned int Courses = 4;
+	const unsigned int courseHeight = LEVEL_TILE_HEIGHT / Courses, brickWidth = LEVEL_TILE_WIDTH / 2;
+	for (unsigned int y = 0; y < LEVEL_TILE_HEIGHT; ++y)  {
+		const unsigned int course = y / courseHeight;
+		const unsigned int offset = course % 2 == 0 ? 0 : brickWidth / 2;
+		for (unsigned int x = 0; x < LEVEL_TILE_WIDTH; ++x)  {
+			const bool mortar = y % courseHeight == 0 || (x + offset) % brickWidth == 0;
+			image.SetPixel(left + x, top + y, mortar ? sf::Color(200, 190, 170) : sf::Color(170, 60, 40));
+		}
+	}
+}
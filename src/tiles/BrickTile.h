@@ -0,0 +1,17 @@
+#ifndef BRICKTILE_H
+#define BRICKTILE_H
+
+#include "Tile.h"
+
+/**
+ * @brief
+ * Destructible wall, stops players and is destroyed by the explosion that reaches it.
+ */
+class BrickTile  {
+public:
+	static void paint(sf::Image& image, unsigned int left, unsigned int top, const Tile& tile);
+
+	static const TileType type;
+};
+
+#endif
@@ -1,15 +1,23 @@
 #include "EmptyTile.h"
-#include <SFML/Graphics/Shape.hpp>
-#include <SFML/Graphics/Color.hpp>
+#include "Level.h"
 
-void EmptyTile::render(sf::RenderTarget& target, DeltaTime dt) 
-{
-	static sf::Shape rect = sf::Shape::Rectangle(m_x, m_y, m_width, m_height, sf::Color::Green, 1, sf::Color::Black);
-	rect.SetPosition(m_x, m_y);
-	target.Draw(rect);
-}
+const TileType EmptyTile::type = { "empty", TILE_LAYER_FLOOR, TILE_FLAG_NONE, 0, NULL, &EmptyTile::paint };
 
-void EmptyTile::simulate(DeltaTime dt)
+void EmptyTile::paint(sf::Image& image, unsigned int left, unsigned int top, const Tile& tile) 
 {
-	// no necessary stuff here to do
-}
\ No newline at end of file
+	// Green floor with a black outline
+	static sf::Image floor;
+	if (floor.GetWidth() == 0)  {
+		floor.Create(LEVEL_TILE_WIDTH, LEVEL_TILE_HEIGHT, sf::Color::Green);
+		for (unsigned int x = 0; x < LEVEL_TILE_WIDTH; ++x)  {
+			floor.SetPixel(x, 0, sf::Color::Black);
+			floor.SetPixel(x, LEVEL_TILE_HEIGHT - 1, sf::Color::Black);
+		}
+		for (unsigned int y = 0; y < LEVEL_TILE_HEIGHT; ++y)  {
+			floor.SetPixel(0, y, sf::Color::Black);
+			floor.SetPixel(LEVEL_TILE_WIDTH - 1, y, sf::Color::Black);
+		}
+	}
+
+	image.Copy(floor, left, top);
+}
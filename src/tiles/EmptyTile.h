@@ -3,12 +3,15 @@
 
 #include "Tile.h"
 
-class EmptyTile : public Tile {
+/**
+ * @brief
+ * Free floor of the level, has no behaviour.
+ */
+class EmptyTile  {
 public:
-	EmptyTile(float x, float y, sf::Sprite &sprite) : Tile(x, y, sprite) {}
+	static void paint(sf::Image& image, unsigned int left, unsigned int top, const Tile& tile);
 
-	void render(sf::RenderTarget& target, DeltaTime dt);
-	void simulate(DeltaTime dt);
+	static const TileType type;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,25 @@
+#include "FlameTile.h"
+#include "Level.h"
+
+const TileType FlameTile::type = { "flame", TILE_LAYER_EFFECTS, TILE_FLAG_NONE, 1 << TILE_PLANE_FLAME, &FlameTile::simulate, &FlameTile::paint };
+
+void FlameTile::simulate(Level& level, int x, int y, DeltaTime dt)
+{
+	Tile& tile = level.editTile(x, y);
+	if (++tile.state >= BurnTicks)
+		level.setTile(x, y, TILE_EMPTY);
+}
+
+void FlameTile::paint(sf::Image& image, unsigned int left, unsigned int top, const Tile& tile)
+{
+	// Orange fire fading to a yellow core
+	const float centerX = (LEVEL_TILE_WIDTH - 1) / 2.0f, centerY = (LEVEL_TILE_HEIGHT - 1) / 2.0f;
+	for (unsigned int y = 0; y < LEVEL_TILE_HEIGHT; ++y)  {
+		for (unsigned int x = 0; x < LEVEL_TILE_WIDTH; ++x)  {
+			const float dx = (x - centerX) / centerX, dy = (y - centerY) / centerY;
+			const float d = dx * dx + dy * dy;
+			const sf::Uint8 green = (sf::Uint8)(d < 1 ? 220 - 150 * d : 70);
+			image.SetPixel(left + x, top + y, sf::Color(255, green, 0));
+		}
+	}
+}
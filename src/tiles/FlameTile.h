@@ -0,0 +1,26 @@
+#ifndef FLAMETILE_H
+#define FLAMETILE_H
+
+#include "Tile.h"
+
+/**
+ * @brief
+ * Fire of an explosion, burns out into an empty tile after BurnTicks ticks.
+ * 
+ * The number of ticks the flame has burned is kept in Tile::state.
+ */
+class FlameTile  {
+public:
+	static void simulate(Level& level, int x, int y, DeltaTime dt);
+	static void paint(sf::Image& image, unsigned int left, unsigned int top, const Tile& tile);
+
+	static const TileType type;
+
+	/**
+	 * @brief
+	 * Lifetime of a flame, half a second at the default tick rate.
+	 */
+	static const unsigned char BurnTicks = 30;
+};
+
+#endif
@@ -0,0 +1,20 @@
+#include "WallTile.h"
+#include "Level.h"
+
+const TileType WallTile::type = { "wall", TILE_LAYER_BLOCKS, TILE_FLAG_SOLID, 0, NULL, &WallTile::paint };
+
+void WallTile::paint(sf::Image& image, unsigned int left, unsigned int top, const Tile& tile)
+{
+	// Gray block, lit from the top left
+	static const unsigned int Bevel = 4;
+	for (unsigned int y = 0; y < LEVEL_TILE_HEIGHT; ++y)  {
+		for (unsigned int x = 0; x < LEVEL_TILE_WIDTH; ++x)  {
+			sf::Color color(128, 128, 128);
+			if (x < Bevel || y < Bevel)
+				color = sf::Color(176, 176, 176);
+			else if (x >= LEVEL_TILE_WIDTH - Bevel || y >= LEVEL_TILE_HEIGHT - Bevel)
+				color = sf::Color(80, 80, 80);
+			image.SetPixel(left + x, top + y, color);
+		}
+	}
+}
@@ -0,0 +1,17 @@
+#ifndef WALLTILE_H
+#define WALLTILE_H
+
+#include "Tile.h"
+
+/**
+ * @brief
+ * Indestructible wall, stops players and explosions.
+ */
+class WallTile  {
+public:
+	static void paint(sf::Image& image, unsigned int left, unsigned int top, const Tile& tile);
+
+	static const TileType type;
+};
+
+#endif
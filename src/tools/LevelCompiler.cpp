@@ -0,0 +1,230 @@
+/**
+ * Compiles human-editable level descriptions into the binary level format
+ * read by the game (see LevelFileReader).
+ *
+ * Built by the UHKLevelCompiler project.
+ *
+ * Usage: UHKLevelCompiler <input.ini|input.txt> <output>
+ *
+ * A .txt input is a plain grid with one character per tile: '.' and ' ' are
+ * empty tiles, digits are spawn points (on an empty tile) numbered by the digit.
+ *
+ * An INI input describes the level in sections:
+ *
+ *   [legend]      character = tile type name, adds to or overrides the
+ *                 characters of the plain grid
+ *   [map]         either file = a .txt grid relative to the INI file, or
+ *                 the rows of the grid as 0 = ..., 1 = ... ('#' starts a comment
+ *                 in INI files, so it cannot be used as a tile character, and
+ *                 leading spaces of the rows are dropped)
+ *   [spawns]      0 = x,y   1 = x,y ... in tiles, in addition to the digits of the grid
+ *   [metadata]    any key = value, stored in the file (name, author, ...)
+ *
+ * Returns 0 on success, 1 on any error.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <boost/lexical_cast.hpp>
+#include "IniReader.h"
+#include "LevelFile.h"
+#include "Tile.h"
+
+/**
+ * @brief
+ * Removes leading and trailing spaces, IniReader keeps the trailing ones.
+ */
+static std::string trim(const std::string& s)
+{
+	const size_t first = s.find_first_not_of(" \t");
+	if (first == std::string::npos)
+		return std::string();
+	return s.substr(first, s.find_last_not_of(" \t") - first + 1);
+}
+
+/**
+ * @brief
+ * Collects the sections of an INI level description while it is parsed.
+ */
+class LevelSource : public IniReader  {
+public:
+	LevelSource(const std::string& fileName) : IniReader(fileName) {}
+
+	bool onEntry(const std::string& section, const std::string& propname, const std::string& value)
+	{
+		const std::string v = trim(value);
+		if (section == "legend")  {
+			if (propname.size() != 1)  {
+				fprintf(stderr, "%s: legend key '%s' must be a single character\n", getFileName().c_str(), propname.c_str());
+				return false;
+			}
+			legend[propname[0]] = v;
+		} else if (section == "map")  {
+			if (propname == "file")  {
+				mapFile = v;
+			} else  {
+				try  {
+					rows[boost::lexical_cast<int>(propname)] = value;
+				} catch (boost::bad_lexical_cast& )  {
+					fprintf(stderr, "%s: map row '%s' is not a number\n", getFileName().c_str(), propname.c_str());
+					return false;
+				}
+			}
+		} else if (section == "spawns")  {
+			LevelSpawn spawn;
+			char comma = 0;
+			std::istringstream in(v);
+			if (!(in >> spawn.x >> comma >> spawn.y) || comma != ',')  {
+				fprintf(stderr, "%s: invalid spawn '%s'\n", getFileName().c_str(), v.c_str());
+				return false;
+			}
+			spawns.push_back(spawn);
+		} else if (section == "metadata")  {
+			metadata[propname] = v;
+		}
+		return true;
+	}
+
+	std::map<char, std::string> legend;
+	std::string mapFile;
+	std::map<int, std::string> rows;
+	std::vector<LevelSpawn> spawns;
+	std::map<std::string, std::string> metadata;
+};
+
+static bool readGrid(const std::string& fileName, std::vector<std::string>& rows)
+{
+	std::ifstream in(fileName.c_str());
+	if (!in.is_open())  {
+		fprintf(stderr, "Cannot open %s\n", fileName.c_str());
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(in, line))  {
+		if (!line.empty() && line[line.size() - 1] == '\r')
+			line.erase(line.size() - 1);
+		rows.push_back(line);
+	}
+	return true;
+}
+
+static bool endsWith(const std::string& s, const std::string& suffix)
+{
+	return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * @brief
+ * Builds the level from the grid rows, the legend and the spawn digits.
+ */
+static bool buildLevel(const std::vector<std::string>& rows, const std::map<char, std::string>& legend, LevelDescription& level)
+{
+	unsigned char types[256];
+	bool known[256] = { false };
+	for (auto it = legend.begin(); it != legend.end(); ++it)  {
+		const unsigned char type = findTileType(it->second.c_str());
+		if (type == TILE_TYPE_COUNT)  {
+			fprintf(stderr, "Unknown tile type '%s' of '%c'\n", it->second.c_str(), it->first);
+			return false;
+		}
+		types[(unsigned char)it->first] = type;
+		known[(unsigned char)it->first] = true;
+	}
+
+	level.height = (int)rows.size();
+	level.width = 0;
+	for (size_t i = 0; i < rows.size(); ++i)
+		level.width = (int)rows[i].size() > level.width ? (int)rows[i].size() : level.width;
+	if (level.width == 0 || level.height == 0)  {
+		fprintf(stderr, "The map is empty\n");
+		return false;
+	}
+
+	// Short rows are padded with empty tiles
+	Tile empty = { TILE_EMPTY, tileType(TILE_EMPTY).defaultFlags, 0 };
+	level.tiles.assign(level.width * level.height, empty);
+	std::map<int, LevelSpawn> numbered;
+	for (int y = 0; y < level.height; ++y)  {
+		for (int x = 0; x < (int)rows[y].size(); ++x)  {
+			const unsigned char c = rows[y][x];
+			Tile& tile = level.tiles[y * level.width + x];
+			if (known[c])  {
+				tile.type = types[c];
+				tile.flags = tileType(tile.type).defaultFlags;
+			} else if (c >= '0' && c <= '9')  {
+				LevelSpawn spawn = { x, y };
+				numbered[c - '0'] = spawn;
+			} else  {
+				fprintf(stderr, "Unknown tile character '%c' at %d,%d\n", c, x, y);
+				return false;
+			}
+		}
+	}
+
+	for (auto it = numbered.begin(); it != numbered.end(); ++it)
+		level.spawns.push_back(it->second);
+	return true;
+}
+
+int main(int argc, const char *argv[])
+{
+	if (argc != 3)  {
+		fprintf(stderr, "Usage: %s <input.ini|input.txt> <output>\n", argv[0]);
+		return 1;
+	}
+
+	const std::string input = argv[1], output = argv[2];
+	std::map<char, std::string> legend;
+	legend['.'] = tileType(TILE_EMPTY).name;
+	legend[' '] = tileType(TILE_EMPTY).name;
+
+	std::vector<std::string> rows;
+	LevelDescription level;
+	if (endsWith(input, ".txt"))  {
+		if (!readGrid(input, rows) || !buildLevel(rows, legend, level))
+			return 1;
+	} else  {
+		LevelSource source(input);
+		if (!source.parse())  {
+			fprintf(stderr, "Cannot parse %s\n", input.c_str());
+			return 1;
+		}
+
+		for (auto it = source.legend.begin(); it != source.legend.end(); ++it)
+			legend[it->first] = it->second;
+
+		if (!source.mapFile.empty())  {
+			// Relative to the directory of the INI file
+			const size_t slash = input.find_last_of("/\\");
+			const std::string dir = slash == std::string::npos ? std::string() : input.substr(0, slash + 1);
+			if (!readGrid(dir + source.mapFile, rows))
+				return 1;
+		} else  {
+			for (auto it = source.rows.begin(); it != source.rows.end(); ++it)
+				rows.push_back(it->second);
+		}
+
+		if (!buildLevel(rows, legend, level))
+			return 1;
+		level.spawns.insert(level.spawns.end(), source.spawns.begin(), source.spawns.end());
+		level.metadata = source.metadata;
+	}
+
+	for (size_t i = 0; i < level.spawns.size(); ++i)  {
+		if (level.spawns[i].x < 0 || level.spawns[i].y < 0 || level.spawns[i].x >= level.width || level.spawns[i].y >= level.height)  {
+			fprintf(stderr, "Spawn %d,%d is outside of the level\n", level.spawns[i].x, level.spawns[i].y);
+			return 1;
+		}
+	}
+
+	if (!writeLevelFile(output, level))  {
+		fprintf(stderr, "Cannot write %s\n", output.c_str());
+		return 1;
+	}
+
+	printf("%s: %dx%d tiles, %d spawns\n", output.c_str(), level.width, level.height, (int)level.spawns.size());
+	return 0;
+}